@@ -30,7 +30,9 @@
 ;   <o> Stack Size (in Bytes) <0x0-0xFFFFFFFF:8>
 ; </h>
 
-Stack_Size      EQU     0x00000200
+; 2 KB: worst case about 1.6 KB, the main program's deepest chain plus
+; one interrupt frame (README.txt, 5.3)
+Stack_Size      EQU     0x00000800
 
                 AREA    STACK, NOINIT, READWRITE, ALIGN=3
 Stack_Mem       SPACE   Stack_Size
@@ -0,0 +1,987 @@
+/*
+ * Benchmark Module Implementation
+ * 
+ * Times calculator engine routines with the DWT cycle counter and
+ * compares them against the reference implementations they replaced.
+ * Enable with -DCALC_BENCHMARK; Bench_Run() is then called from main()
+ * before the calculator starts. Press any key to step through results.
+ */
+
+#include "bench.h"
+#include "calculator.h"
+#include "decimal.h"
+#include "mathfn.h"
+#include "numformat.h"
+#include "stats.h"
+#include "solve.h"
+#include "integrate.h"
+#include "matrix.h"
+#include "rf.h"
+#include "fraction.h"
+#include "program.h"
+#include "lcd.h"
+#include "keypad.h"
+#include "system.h"
+#include <math.h>
+
+// Sinks so the compiler cannot discard benchmarked results
+static volatile float bench_sink;
+static volatile CalcNumber bench_number;
+static volatile Decimal bench_decimal;
+
+// Write an unsigned number to the LCD
+static void Bench_PrintNumber(unsigned long value) {
+    char temp[12];
+    int pos = 0;
+    
+    do {
+        temp[pos++] = '0' + (value % 10);
+        value /= 10;
+    } while(value > 0 && pos < 11);
+    
+    while(pos > 0) {
+        LCD_Char(temp[--pos]);
+    }
+}
+
+void Bench_ShowResult(const char* label, const char* name_a, unsigned long cycles_a,
+                      const char* name_b, unsigned long cycles_b) {
+    LCD_Clear();
+    LCD_String((char*)label);
+    LCD_Cmd(LCD_LINE2);
+    LCD_String((char*)name_a);
+    LCD_Char(':');
+    Bench_PrintNumber(cycles_a);
+    LCD_Char(' ');
+    LCD_String((char*)name_b);
+    LCD_Char(':');
+    Bench_PrintNumber(cycles_b);
+    WaitForKey();
+}
+
+// ---------------------------------------------------------------------------
+// Expression evaluator: the keyed running evaluation vs. original two-pass
+// ---------------------------------------------------------------------------
+
+// Original two-pass reduction (fixed at 9 operands), kept as the reference
+static float Bench_TwoPassCalculate(const float* operands, const Operator* operators,
+                                    int operand_count) {
+    float values[9];
+    Operator ops[8];
+    int value_count = operand_count;
+    int op_count = operand_count - 1;
+    
+    for(int i = 0; i < value_count; i++) {
+        values[i] = operands[i];
+    }
+    for(int i = 0; i < op_count; i++) {
+        ops[i] = operators[i];
+    }
+    
+    // First pass: *, / (E is not used by the benchmark expression)
+    int i = 0;
+    while(i < op_count) {
+        if(ops[i] == OP_MULTIPLY || ops[i] == OP_DIVIDE) {
+            values[i] = (ops[i] == OP_MULTIPLY) ? values[i] * values[i + 1]
+                                                : values[i] / values[i + 1];
+            for(int j = i + 1; j < value_count - 1; j++) {
+                values[j] = values[j + 1];
+            }
+            value_count--;
+            for(int j = i; j < op_count - 1; j++) {
+                ops[j] = ops[j + 1];
+            }
+            op_count--;
+        } else {
+            i++;
+        }
+    }
+    
+    // Second pass: +, -
+    while(op_count > 0) {
+        values[0] = (ops[0] == OP_ADD) ? values[0] + values[1] : values[0] - values[1];
+        for(int j = 1; j < value_count - 1; j++) {
+            values[j] = values[j + 1];
+        }
+        value_count--;
+        for(int j = 0; j < op_count - 1; j++) {
+            ops[j] = ops[j + 1];
+        }
+        op_count--;
+    }
+    
+    return values[0];
+}
+
+// Key an expression into the engine, then equals
+static void Bench_KeyExpression(Calculator* calc, const char* keys) {
+    for(const char* key = keys; *key != '\0'; key++) {
+        switch(*key) {
+            case '+': Calculator_EnterOperator(calc, OP_ADD);      break;
+            case '-': Calculator_EnterOperator(calc, OP_SUBTRACT); break;
+            case '*': Calculator_EnterOperator(calc, OP_MULTIPLY); break;
+            case '/': Calculator_EnterOperator(calc, OP_DIVIDE);   break;
+            default:  Calculator_EnterDigit(calc, *key);           break;
+        }
+    }
+    Calculator_Equals(calc);
+}
+
+// Keys for 1 + 2  3 - 4  5 + 6  7 - ... with this many operands (the
+// digits repeat after 9)
+static void Bench_EvaluatorKeys(char* keys, int operands) {
+    static const char pattern[4] = { '+', '*', '-', '/' };
+    int pos = 0;
+    
+    for(int i = 0; i < operands; i++) {
+        if(i > 0) {
+            keys[pos++] = pattern[(i - 1) % 4];
+        }
+        keys[pos++] = (char)('1' + i % 9);
+    }
+    keys[pos] = '\0';
+}
+
+// Keyed in and evaluated the way the keypad does it (the running
+// evaluation and the tape), on CalcNumbers like the two-pass reference
+static unsigned long Bench_KeyedCycles(Calculator* calc, const char* keys) {
+    unsigned long start = CycleCounter_Read();
+    
+    for(int n = 0; n < BENCH_ITERATIONS; n++) {
+        Calculator_Clear(calc);
+        calc->exact = 0;
+        Bench_KeyExpression(calc, keys);
+    }
+    bench_number = calc->current_number;
+    return (CycleCounter_Read() - start) / BENCH_ITERATIONS;
+}
+
+void Bench_Evaluator(void) {
+    static Calculator calc;
+    static char keys[2 * MAX_OPERANDS];
+    float operands[9];
+    Operator operators[8];
+    unsigned long start;
+    unsigned long two_pass;
+    unsigned long keyed;
+    
+    // Mixed-precedence expression: 1 + 2  3 - 4  5 + 6  7 - ...
+    static const Operator pattern[4] = { OP_ADD, OP_MULTIPLY, OP_SUBTRACT, OP_DIVIDE };
+    for(int i = 0; i < 9; i++) {
+        operands[i] = (float)(i + 1);
+    }
+    for(int i = 0; i < 8; i++) {
+        operators[i] = pattern[i % 4];
+    }
+    
+    Calculator_Init(&calc);
+    
+    // 9 operands: the largest expression the two-pass code could hold.
+    // The reference only evaluates; the keyed figure includes the keys.
+    start = CycleCounter_Read();
+    for(int n = 0; n < BENCH_ITERATIONS; n++) {
+        bench_sink = Bench_TwoPassCalculate(operands, operators, 9);
+    }
+    two_pass = (CycleCounter_Read() - start) / BENCH_ITERATIONS;
+    
+    Bench_EvaluatorKeys(keys, 9);
+    keyed = Bench_KeyedCycles(&calc, keys);
+    
+    Bench_ShowResult("Eval 9 operands", "2p", two_pass, "key", keyed);
+    
+    // Full capacity: only the running evaluation can hold this many
+    Bench_EvaluatorKeys(keys, MAX_OPERANDS);
+    keyed = Bench_KeyedCycles(&calc, keys);
+    
+    Bench_ShowResult("Eval max size", "n", MAX_OPERANDS, "key", keyed);
+}
+
+// ---------------------------------------------------------------------------
+// Number entry: integer mantissa + decimal exponent vs. per-digit float math
+// ---------------------------------------------------------------------------
+
+// 15 digits, the longest number the input buffer holds
+static const char bench_digits[] = "123456789012345";
+
+// Original float accumulation: rebuilds a 10^k divisor for every fractional
+// digit, and backspace re-parses the whole buffer
+static float Bench_FloatEntry(const char* buffer, int length, int decimal_at) {
+    float value = 0.0f;
+    int decimal_places = 0;
+    
+    for(int i = 0; i < length; i++) {
+        int digit = buffer[i] - '0';
+        if(i >= decimal_at) {
+            float divisor = 1.0f;
+            for(int j = 0; j <= decimal_places; j++) {
+                divisor *= 10.0f;
+            }
+            value += digit / divisor;
+            decimal_places++;
+        } else {
+            value = value * 10.0f + digit;
+        }
+    }
+    return value;
+}
+
+// Current conversion of the same buffer: what Calculator_EnterDigit does to
+// the mantissa per digit, then the one Number_FromInput when it is used
+static CalcNumber Bench_MantissaEntry(const char* buffer, int length, int decimal_at) {
+    unsigned long long mantissa = 0;
+    int decimal_places = 0;
+    
+    for(int i = 0; i < length; i++) {
+        mantissa = mantissa * 10 + (buffer[i] - '0');
+        if(i >= decimal_at) {
+            decimal_places++;
+        }
+    }
+    return Number_FromInput(mantissa, decimal_places);
+}
+
+void Bench_NumberEntry(void) {
+    unsigned long start;
+    unsigned long old_cycles;
+    unsigned long new_cycles;
+    
+    // Convert 1234567.89012345 (15 digits, decimal point after the 7th).
+    // Both sides do only the conversion; the keypad, the input buffer and
+    // the display are the same for either and are left out.
+    start = CycleCounter_Read();
+    for(int n = 0; n < BENCH_ITERATIONS; n++) {
+        bench_sink = Bench_FloatEntry(bench_digits, 15, 7);
+    }
+    old_cycles = (CycleCounter_Read() - start) / BENCH_ITERATIONS;
+    
+    start = CycleCounter_Read();
+    for(int n = 0; n < BENCH_ITERATIONS; n++) {
+        bench_number = Bench_MantissaEntry(bench_digits, 15, 7);
+    }
+    new_cycles = (CycleCounter_Read() - start) / BENCH_ITERATIONS;
+    
+    Bench_ShowResult("Key 15 digits", "flt", old_cycles, "mant", new_cycles);
+    
+    // Key 15 digits then backspace them all: each old backspace re-parsed
+    // the remaining buffer, each new one divides the mantissa by 10 (as
+    // Calculator_Backspace does) and the value is converted once at the end
+    start = CycleCounter_Read();
+    for(int n = 0; n < BENCH_ITERATIONS; n++) {
+        bench_sink = Bench_FloatEntry(bench_digits, 15, 15);
+        for(int length = 14; length >= 0; length--) {
+            bench_sink = Bench_FloatEntry(bench_digits, length, 15);
+        }
+    }
+    old_cycles = (CycleCounter_Read() - start) / BENCH_ITERATIONS;
+    
+    start = CycleCounter_Read();
+    for(int n = 0; n < BENCH_ITERATIONS; n++) {
+        unsigned long long mantissa = 0;
+        for(int i = 0; i < 15; i++) {
+            mantissa = mantissa * 10 + (bench_digits[i] - '0');
+        }
+        for(int i = 0; i < 15; i++) {
+            mantissa = mantissa / 10;
+        }
+        bench_number = Number_FromInput(mantissa, 0);
+    }
+    new_cycles = (CycleCounter_Read() - start) / BENCH_ITERATIONS;
+    
+    Bench_ShowResult("Key+bksp x15", "flt", old_cycles, "mant", new_cycles);
+}
+
+// ---------------------------------------------------------------------------
+// Number formatting: shortest round-trip (Ryu) vs. original int-cast routine
+// ---------------------------------------------------------------------------
+
+// Original formatter: (int) cast plus up to 4 fractional digits via float *10
+static void Bench_LegacyFormat(char* buffer, float number, int buffer_size) {
+    if(number == 0.0f) {
+        buffer[0] = '0';
+        buffer[1] = '\0';
+        return;
+    }
+    
+    int int_part = (int)number;
+    float frac_part = number - int_part;
+    if(frac_part < 0) frac_part = -frac_part;
+    
+    int pos = 0;
+    if(number < 0 && int_part == 0) {
+        buffer[pos++] = '-';
+    }
+    
+    if(int_part == 0) {
+        buffer[pos++] = '0';
+    } else {
+        char temp[16];
+        int temp_pos = 0;
+        int num = int_part;
+        if(num < 0) num = -num;
+        while(num > 0 && temp_pos < 15) {
+            temp[temp_pos++] = '0' + (num % 10);
+            num /= 10;
+        }
+        if(int_part < 0 && pos == 0) {
+            buffer[pos++] = '-';
+        }
+        for(int i = temp_pos - 1; i >= 0 && pos < buffer_size - 1; i--) {
+            buffer[pos++] = temp[i];
+        }
+    }
+    
+    if(frac_part > 0.0001f && pos < buffer_size - 3) {
+        buffer[pos++] = '.';
+        int decimal_digits = 0;
+        while(frac_part > 0.0001f && decimal_digits < 4 && pos < buffer_size - 1) {
+            frac_part *= 10;
+            int digit = (int)frac_part;
+            buffer[pos++] = '0' + digit;
+            frac_part -= digit;
+            decimal_digits++;
+        }
+    }
+    
+    buffer[pos] = '\0';
+}
+
+// Random finite float (xorshift32 bit pattern, NaN/Inf exponents folded away)
+static float Bench_RandomFloat(unsigned long* state) {
+    union { unsigned long bits; float value; } sample;
+    unsigned long x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    sample.bits = x;
+    if((x & 0x7F800000) == 0x7F800000) {
+        sample.bits &= ~0x00800000UL;
+    }
+    return sample.value;
+}
+
+void Bench_FormatNumber(void) {
+    char buffer[MAX_EXPRESSION_LENGTH];
+    unsigned long long old_total = 0;
+    unsigned long long new_total = 0;
+    unsigned long seed;
+    unsigned long start;
+    
+    // Same sample sequence for both; timed in chunks so the 32-bit cycle
+    // counter cannot wrap within one measurement
+    seed = 2463534242UL;
+    for(long done = 0; done < BENCH_FORMAT_SAMPLES; done += 10000) {
+        start = CycleCounter_Read();
+        for(int n = 0; n < 10000; n++) {
+            Bench_LegacyFormat(buffer, Bench_RandomFloat(&seed), MAX_EXPRESSION_LENGTH);
+        }
+        old_total += CycleCounter_Read() - start;
+    }
+    
+    seed = 2463534242UL;
+    for(long done = 0; done < BENCH_FORMAT_SAMPLES; done += 10000) {
+        start = CycleCounter_Read();
+        for(int n = 0; n < 10000; n++) {
+            NumFormat_Float(buffer, Bench_RandomFloat(&seed), MAX_EXPRESSION_LENGTH);
+        }
+        new_total += CycleCounter_Read() - start;
+    }
+    
+    Bench_ShowResult("Format rnd float", "old",
+                     (unsigned long)(old_total / BENCH_FORMAT_SAMPLES),
+                     "ryu", (unsigned long)(new_total / BENCH_FORMAT_SAMPLES));
+}
+
+// ---------------------------------------------------------------------------
+// Number backends: FPU float vs. 16-digit decimal, per operation
+// ---------------------------------------------------------------------------
+
+// Operands with a full set of significant digits in both backends
+static const float bench_float_a = 1234.5678f;
+static const float bench_float_b = 0.987654321f;
+
+void Bench_NumberBackend(void) {
+    volatile float fa = bench_float_a;
+    volatile float fb = bench_float_b;
+    volatile unsigned long long mantissa = 123456789012345ULL;
+    Decimal da = Decimal_FromDigits(1234567812345678ULL, -12);
+    Decimal db = Decimal_FromDigits(9876543210987654ULL, -16);
+    unsigned long start;
+    unsigned long float_cycles;
+    unsigned long decimal_cycles;
+    
+    // Add (different exponents, so the decimal path has to align)
+    start = CycleCounter_Read();
+    for(int n = 0; n < BENCH_ITERATIONS; n++) {
+        bench_sink = fa + fb;
+    }
+    float_cycles = (CycleCounter_Read() - start) / BENCH_ITERATIONS;
+    start = CycleCounter_Read();
+    for(int n = 0; n < BENCH_ITERATIONS; n++) {
+        bench_decimal = Decimal_Add(da, db);
+    }
+    decimal_cycles = (CycleCounter_Read() - start) / BENCH_ITERATIONS;
+    Bench_ShowResult("Add", "flt", float_cycles, "dec", decimal_cycles);
+    
+    // Multiply
+    start = CycleCounter_Read();
+    for(int n = 0; n < BENCH_ITERATIONS; n++) {
+        bench_sink = fa * fb;
+    }
+    float_cycles = (CycleCounter_Read() - start) / BENCH_ITERATIONS;
+    start = CycleCounter_Read();
+    for(int n = 0; n < BENCH_ITERATIONS; n++) {
+        bench_decimal = Decimal_Multiply(da, db);
+    }
+    decimal_cycles = (CycleCounter_Read() - start) / BENCH_ITERATIONS;
+    Bench_ShowResult("Multiply", "flt", float_cycles, "dec", decimal_cycles);
+    
+    // Divide
+    start = CycleCounter_Read();
+    for(int n = 0; n < BENCH_ITERATIONS; n++) {
+        bench_sink = fa / fb;
+    }
+    float_cycles = (CycleCounter_Read() - start) / BENCH_ITERATIONS;
+    start = CycleCounter_Read();
+    for(int n = 0; n < BENCH_ITERATIONS; n++) {
+        bench_decimal = Decimal_Divide(da, db);
+    }
+    decimal_cycles = (CycleCounter_Read() - start) / BENCH_ITERATIONS;
+    Bench_ShowResult("Divide", "flt", float_cycles, "dec", decimal_cycles);
+    
+    // E scaling (10^12)
+    start = CycleCounter_Read();
+    for(int n = 0; n < BENCH_ITERATIONS; n++) {
+        bench_sink = fa * 1e12f;
+    }
+    float_cycles = (CycleCounter_Read() - start) / BENCH_ITERATIONS;
+    start = CycleCounter_Read();
+    for(int n = 0; n < BENCH_ITERATIONS; n++) {
+        bench_decimal = Decimal_Scale10(da, 12);
+    }
+    decimal_cycles = (CycleCounter_Read() - start) / BENCH_ITERATIONS;
+    Bench_ShowResult("E scale", "flt", float_cycles, "dec", decimal_cycles);
+    
+    // Key in a number: typed digits to a value
+    start = CycleCounter_Read();
+    for(int n = 0; n < BENCH_ITERATIONS; n++) {
+        bench_sink = (float)((double)mantissa / 1e8);
+    }
+    float_cycles = (CycleCounter_Read() - start) / BENCH_ITERATIONS;
+    start = CycleCounter_Read();
+    for(int n = 0; n < BENCH_ITERATIONS; n++) {
+        bench_decimal = Decimal_FromDigits(mantissa, -8);
+    }
+    decimal_cycles = (CycleCounter_Read() - start) / BENCH_ITERATIONS;
+    Bench_ShowResult("Number entry", "flt", float_cycles, "dec", decimal_cycles);
+}
+
+// ---------------------------------------------------------------------------
+// Integer expressions: exact 64-bit integer path vs. CalcNumber path
+// ---------------------------------------------------------------------------
+
+// Whole-number expression keyed in through the engine, then equals
+static const char bench_int_keys[] = "1234*5678+90*12-345/5+999999*1001";
+
+void Bench_IntegerPath(void) {
+    static Calculator calc;
+    unsigned long start;
+    unsigned long int_cycles;
+    unsigned long float_cycles;
+    
+    // Integer path (the default for whole-number operands)
+    start = CycleCounter_Read();
+    for(int n = 0; n < BENCH_ITERATIONS; n++) {
+        Calculator_Init(&calc);
+        Bench_KeyExpression(&calc, bench_int_keys);
+    }
+    int_cycles = (CycleCounter_Read() - start) / BENCH_ITERATIONS;
+    bench_number = calc.current_number;
+    
+    // Same keys with the integer path switched off from the start
+    start = CycleCounter_Read();
+    for(int n = 0; n < BENCH_ITERATIONS; n++) {
+        Calculator_Init(&calc);
+        calc.exact = 0;
+        Bench_KeyExpression(&calc, bench_int_keys);
+    }
+    float_cycles = (CycleCounter_Read() - start) / BENCH_ITERATIONS;
+    bench_number = calc.current_number;
+    
+    Bench_ShowResult("Integer expr", "int", int_cycles, "flt", float_cycles);
+}
+
+// ---------------------------------------------------------------------------
+// Replay: re-running the compiled tape vs. keying the expression again
+// ---------------------------------------------------------------------------
+
+void Bench_Replay(void) {
+    static Calculator calc;
+    unsigned long start;
+    unsigned long rekey_cycles;
+    unsigned long replay_cycles;
+    
+    start = CycleCounter_Read();
+    for(int n = 0; n < BENCH_ITERATIONS; n++) {
+        Calculator_Init(&calc);
+        Bench_KeyExpression(&calc, bench_int_keys);
+    }
+    rekey_cycles = (CycleCounter_Read() - start) / BENCH_ITERATIONS;
+    bench_number = calc.current_number;
+    
+    // Same expression from the tape, with a new first operand each time
+    start = CycleCounter_Read();
+    for(int n = 0; n < BENCH_ITERATIONS; n++) {
+        Calculator_EnterDigit(&calc, '7');
+        Calculator_Replay(&calc);
+    }
+    replay_cycles = (CycleCounter_Read() - start) / BENCH_ITERATIONS;
+    bench_number = calc.current_number;
+    
+    Bench_ShowResult("Replay expr", "key", rekey_cycles, "tape", replay_cycles);
+}
+
+// ---------------------------------------------------------------------------
+// Scientific functions: mathfn.c kernels vs. the toolchain's libm
+// ---------------------------------------------------------------------------
+
+// Arguments spread over several periods / decades, so every reduction path runs
+#define BENCH_MATHFN_ARGS   8
+static const float bench_mathfn_args[BENCH_MATHFN_ARGS] = {
+    0.1f, 0.7f, 1.3f, 2.9f, 7.5f, 31.4f, 250.0f, 4321.0f
+};
+
+static void Bench_MathFnPair(const char* label, float (*ours)(float), float (*libm)(float)) {
+    unsigned long start;
+    unsigned long ours_cycles;
+    unsigned long libm_cycles;
+    float sum = 0.0f;
+    
+    start = CycleCounter_Read();
+    for(int n = 0; n < BENCH_ITERATIONS; n++) {
+        sum += ours(bench_mathfn_args[n % BENCH_MATHFN_ARGS]);
+    }
+    ours_cycles = (CycleCounter_Read() - start) / BENCH_ITERATIONS;
+    
+    start = CycleCounter_Read();
+    for(int n = 0; n < BENCH_ITERATIONS; n++) {
+        sum += libm(bench_mathfn_args[n % BENCH_MATHFN_ARGS]);
+    }
+    libm_cycles = (CycleCounter_Read() - start) / BENCH_ITERATIONS;
+    bench_sink = sum;
+    
+    Bench_ShowResult(label, "fn", ours_cycles, "libm", libm_cycles);
+}
+
+static float Bench_LibSin(float x) {
+    return sinf(x);
+}
+
+static float Bench_LibLog(float x) {
+    return logf(x);
+}
+
+void Bench_MathFn(void) {
+    Bench_MathFnPair("sin(x)", MathFn_Sin, Bench_LibSin);
+    Bench_MathFnPair("ln(x)", MathFn_Log, Bench_LibLog);
+}
+
+// ---------------------------------------------------------------------------
+// Statistics: streaming Welford update vs. batch recompute of the buffer
+// ---------------------------------------------------------------------------
+
+void Bench_Stats(void) {
+    static StatsAccumulator stats;
+    unsigned long start;
+    unsigned long add_cycles;
+    unsigned long batch_cycles;
+    
+    // One sample per call (a full buffer's worth, so the buffer is filled)
+    Stats_Init(&stats);
+    start = CycleCounter_Read();
+    for(int n = 0; n < STATS_MAX_SAMPLES; n++) {
+        Stats_Add(&stats, (float)n, (float)((n * 37) % 101) * 0.25f);
+    }
+    add_cycles = (CycleCounter_Read() - start) / STATS_MAX_SAMPLES;
+    
+    // Recomputing every accumulator from the STATS_MAX_SAMPLES buffered samples
+    start = CycleCounter_Read();
+    for(int n = 0; n < BENCH_ITERATIONS; n++) {
+        Stats_Recompute(&stats);
+    }
+    batch_cycles = (CycleCounter_Read() - start) / BENCH_ITERATIONS;
+    bench_sink = stats.m2_y;
+    
+    Bench_ShowResult("Stats sample", "add", add_cycles, "all", batch_cycles);
+}
+
+// ---------------------------------------------------------------------------
+// Solver: one evaluation of a compiled equation (value and derivative) and
+// a whole solve from a guess
+// ---------------------------------------------------------------------------
+
+void Bench_Solve(void) {
+    static SolveProgram program;
+    SolveResult result;
+    float derivative;
+    unsigned long start;
+    unsigned long eval_cycles;
+    unsigned long solve_cycles;
+    
+    // X^3 - 2X - 5, the classic Newton test equation (root 2.0945515)
+    Solve_Init(&program);
+    Solve_Emit(&program, SOLVE_OP_X);
+    Solve_EmitConstant(&program, 3.0f);
+    Solve_Emit(&program, SOLVE_OP_POWER);
+    Solve_EmitConstant(&program, 2.0f);
+    Solve_Emit(&program, SOLVE_OP_X);
+    Solve_Emit(&program, SOLVE_OP_MULTIPLY);
+    Solve_Emit(&program, SOLVE_OP_SUBTRACT);
+    Solve_EmitConstant(&program, 5.0f);
+    Solve_Emit(&program, SOLVE_OP_SUBTRACT);
+    
+    start = CycleCounter_Read();
+    for(int n = 0; n < BENCH_ITERATIONS; n++) {
+        bench_sink = Solve_Evaluate(&program, 2.0f + (float)n * 1e-4f, &derivative);
+    }
+    eval_cycles = (CycleCounter_Read() - start) / BENCH_ITERATIONS;
+    
+    // Guesses 1 to 8
+    start = CycleCounter_Read();
+    for(int n = 0; n < BENCH_ITERATIONS; n++) {
+        Solve_Root(&program, (float)(1 + (n & 7)), &result);
+    }
+    solve_cycles = (CycleCounter_Read() - start) / BENCH_ITERATIONS;
+    bench_sink = result.x;
+    
+    Bench_ShowResult("Solve X^3-2X-5", "ev", eval_cycles, "all", solve_cycles);
+}
+
+// ---------------------------------------------------------------------------
+// Integration: value-only evaluation and adaptive Gauss-Kronrod
+// ---------------------------------------------------------------------------
+
+void Bench_Integrate(void) {
+    static SolveProgram program;
+    static IntegrateStack stack;
+    IntegrateResult result;
+    unsigned long start;
+    unsigned long eval_cycles;
+    unsigned long integrate_cycles;
+    
+    // 1 / (1 + X^2) from 0 to 1 (pi/4)
+    Solve_Init(&program);
+    Solve_EmitConstant(&program, 1.0f);
+    Solve_EmitConstant(&program, 1.0f);
+    Solve_Emit(&program, SOLVE_OP_X);
+    Solve_EmitConstant(&program, 2.0f);
+    Solve_Emit(&program, SOLVE_OP_POWER);
+    Solve_Emit(&program, SOLVE_OP_ADD);
+    Solve_Emit(&program, SOLVE_OP_DIVIDE);
+    
+    start = CycleCounter_Read();
+    for(int n = 0; n < BENCH_ITERATIONS; n++) {
+        bench_sink = Solve_Evaluate(&program, (float)n * 1e-3f, 0);
+    }
+    eval_cycles = (CycleCounter_Read() - start) / BENCH_ITERATIONS;
+    
+    start = CycleCounter_Read();
+    for(int n = 0; n < BENCH_ITERATIONS; n++) {
+        Integrate_Run(&program, 0.0f, 1.0f, &stack, &result);
+    }
+    integrate_cycles = (CycleCounter_Read() - start) / BENCH_ITERATIONS;
+    bench_sink = result.value;
+    
+    Bench_ShowResult("Integ 1/(1+X^2)", "ev", eval_cycles, "all", integrate_cycles);
+}
+
+// ---------------------------------------------------------------------------
+// Matrix: 44 product and inverse (the CMSIS-DSP kernels on the target)
+// ---------------------------------------------------------------------------
+
+void Bench_Matrix(void) {
+    static Matrix a;
+    static Matrix b;
+    static Matrix result;
+    static Matrix scratch;
+    unsigned long start;
+    unsigned long multiply_cycles;
+    unsigned long inverse_cycles;
+    
+    // Diagonally dominant, so the inverse is well conditioned
+    Matrix_Init(&a, MATRIX_MAX_SIZE, MATRIX_MAX_SIZE);
+    for(int r = 0; r < MATRIX_MAX_SIZE; r++) {
+        for(int c = 0; c < MATRIX_MAX_SIZE; c++) {
+            a.data[r * MATRIX_MAX_SIZE + c] = (r == c) ? 10.0f : (float)(r + 2 * c) * 0.5f;
+        }
+    }
+    b = a;
+    
+    start = CycleCounter_Read();
+    for(int n = 0; n < BENCH_ITERATIONS; n++) {
+        Matrix_Multiply(&a, &b, &result);
+    }
+    multiply_cycles = (CycleCounter_Read() - start) / BENCH_ITERATIONS;
+    bench_sink = result.data[0];
+    
+    start = CycleCounter_Read();
+    for(int n = 0; n < BENCH_ITERATIONS; n++) {
+        Matrix_Inverse(&a, &result, &scratch);
+    }
+    inverse_cycles = (CycleCounter_Read() - start) / BENCH_ITERATIONS;
+    bench_sink = result.data[0];
+    
+    Bench_ShowResult("Matrix 4x4", "mul", multiply_cycles, "inv", inverse_cycles);
+}
+
+// ---------------------------------------------------------------------------
+// RF: table-driven log10 and 10^x vs. the full-accuracy mathfn.c kernels
+// ---------------------------------------------------------------------------
+
+static float Bench_PolyExp10(float x) {
+    return MathFn_Exp(x * 2.30258509f);
+}
+
+static void Bench_RfPair(const char* label, float (*table)(float), float (*poly)(float), float scale) {
+    unsigned long start;
+    unsigned long table_cycles;
+    unsigned long poly_cycles;
+    float sum = 0.0f;
+    
+    start = CycleCounter_Read();
+    for(int n = 0; n < BENCH_ITERATIONS; n++) {
+        sum += table(bench_mathfn_args[n % BENCH_MATHFN_ARGS] * scale);
+    }
+    table_cycles = (CycleCounter_Read() - start) / BENCH_ITERATIONS;
+    
+    start = CycleCounter_Read();
+    for(int n = 0; n < BENCH_ITERATIONS; n++) {
+        sum += poly(bench_mathfn_args[n % BENCH_MATHFN_ARGS] * scale);
+    }
+    poly_cycles = (CycleCounter_Read() - start) / BENCH_ITERATIONS;
+    bench_sink = sum;
+    
+    Bench_ShowResult(label, "tab", table_cycles, "fn", poly_cycles);
+}
+
+void Bench_Rf(void) {
+    Bench_RfPair("RF log10(x)", Rf_Log10, MathFn_Log10, 1.0f);
+    // Arguments up to about 20 (10^20 is still in range)
+    Bench_RfPair("RF 10^x", Rf_Exp10, Bench_PolyExp10, 0.005f);
+}
+
+// ---------------------------------------------------------------------------
+// Fraction: Stein's binary GCD (RBIT/CLZ) vs. Euclid's remainder loop
+// ---------------------------------------------------------------------------
+
+static unsigned long long Bench_EuclidGcd(unsigned long long a, unsigned long long b) {
+    while(b != 0) {
+        unsigned long long remainder = a % b;
+        a = b;
+        b = remainder;
+    }
+    return a;
+}
+
+// Random nonzero operand of up to bits bits (xorshift32, two draws)
+static unsigned long long Bench_RandomOperand(unsigned long* state, int bits) {
+    unsigned long long value = 0;
+    for(int half = 0; half < 2; half++) {
+        unsigned long x = *state;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        *state = x;
+        value = (value << 32) | (x & 0xFFFFFFFFUL);
+    }
+    value >>= 64 - bits;
+    return (value != 0) ? value : 1;
+}
+
+static void Bench_GcdPair(const char* label, int bits) {
+    static unsigned long long operands[2 * BENCH_GCD_PAIRS];
+    unsigned long state = 2463534242UL;
+    unsigned long long sum = 0;
+    unsigned long start;
+    unsigned long binary_cycles;
+    unsigned long euclid_cycles;
+    
+    for(int i = 0; i < 2 * BENCH_GCD_PAIRS; i++) {
+        operands[i] = Bench_RandomOperand(&state, bits);
+    }
+    
+    start = CycleCounter_Read();
+    for(int n = 0; n < BENCH_GCD_PAIRS; n++) {
+        sum += Fraction_Gcd(operands[2 * n], operands[2 * n + 1]);
+    }
+    binary_cycles = (CycleCounter_Read() - start) / BENCH_GCD_PAIRS;
+    
+    start = CycleCounter_Read();
+    for(int n = 0; n < BENCH_GCD_PAIRS; n++) {
+        sum -= Bench_EuclidGcd(operands[2 * n], operands[2 * n + 1]);
+    }
+    euclid_cycles = (CycleCounter_Read() - start) / BENCH_GCD_PAIRS;
+    bench_sink = (float)sum;        // 0 when both agree
+    
+    Bench_ShowResult(label, "bin", binary_cycles, "euc", euclid_cycles);
+}
+
+void Bench_Fraction(void) {
+    Bench_GcdPair("GCD 32-bit", 32);
+    Bench_GcdPair("GCD 64-bit", 62);
+}
+
+// ---------------------------------------------------------------------------
+// RPN: the same expression keyed in RPN and in infix
+// ---------------------------------------------------------------------------
+
+// bench_int_keys in RPN order; a space is ENTER
+static const char bench_rpn_keys[] = "1234 5678*90 12*+345 5/-999999 1001*+";
+
+static void Bench_KeyRpn(Calculator* calc, const char* keys) {
+    for(const char* key = keys; *key != '\0'; key++) {
+        switch(*key) {
+            case ' ': Calculator_RpnKey(calc, '*'); break;
+            case '+': Calculator_RpnKey(calc, 'A'); break;
+            case '-': Calculator_RpnKey(calc, 'B'); break;
+            case '*': calc->shift_active = 1; Calculator_RpnKey(calc, 'A'); break;
+            case '/': calc->shift_active = 1; Calculator_RpnKey(calc, 'B'); break;
+            default:  Calculator_RpnKey(calc, *key); break;
+        }
+    }
+}
+
+void Bench_Rpn(void) {
+    static Calculator calc;
+    unsigned long start;
+    unsigned long infix_cycles;
+    unsigned long rpn_cycles;
+    
+    // Infix on the same CalcNumber arithmetic as RPN (integer path off),
+    // so the difference is the expression handling
+    start = CycleCounter_Read();
+    for(int n = 0; n < BENCH_ITERATIONS; n++) {
+        Calculator_Init(&calc);
+        calc.exact = 0;
+        Bench_KeyExpression(&calc, bench_int_keys);
+    }
+    infix_cycles = (CycleCounter_Read() - start) / BENCH_ITERATIONS;
+    bench_number = calc.current_number;
+    
+    start = CycleCounter_Read();
+    for(int n = 0; n < BENCH_ITERATIONS; n++) {
+        Calculator_Init(&calc);
+        calc.mode = MODE_RPN;
+        Bench_KeyRpn(&calc, bench_rpn_keys);
+    }
+    rpn_cycles = (CycleCounter_Read() - start) / BENCH_ITERATIONS;
+    bench_number = calc.rpn_stack[0];
+    
+    Bench_ShowResult("RPN vs infix", "inf", infix_cycles, "rpn", rpn_cycles);
+}
+
+// ---------------------------------------------------------------------------
+// Keystroke programs: interpreter cycles per instruction on a counted loop
+// ---------------------------------------------------------------------------
+
+// Loop passes per run (R1 counts down from this)
+#define BENCH_PROGRAM_LOOPS     100
+
+void Bench_Program(void) {
+    static Program program;
+    static CalcNumber stack[PROGRAM_STACK];
+    static CalcNumber registers[PROGRAM_REGISTERS];
+    int lift = 0;
+    ProgramMachine machine = { stack, &lift, registers };
+    long steps = 0;
+    long total_steps = 0;
+    unsigned long start;
+    unsigned long cycles;
+    
+    // Sum of 1..BENCH_PROGRAM_LOOPS: LBL 0, RCL 1, +, DSZ 1, GTO 0
+    Program_Clear(&program);
+    Program_EmitOperand(&program, PROGRAM_OP_LABEL, 0);
+    Program_EmitOperand(&program, PROGRAM_OP_RECALL, 1);
+    Program_Emit(&program, PROGRAM_OP_ADD);
+    Program_EmitOperand(&program, PROGRAM_OP_DSZ, 1);
+    Program_EmitOperand(&program, PROGRAM_OP_GOTO, 0);
+    Program_Link(&program);
+    
+    start = CycleCounter_Read();
+    for(int n = 0; n < BENCH_ITERATIONS; n++) {
+        stack[0] = Number_Zero();
+        registers[1] = Number_FromInt64(BENCH_PROGRAM_LOOPS);
+        Program_Run(&program, &machine, &steps);
+        total_steps += steps;
+    }
+    cycles = CycleCounter_Read() - start;
+    bench_number = stack[0];
+    
+    Bench_ShowResult("Program sum loop", "op", cycles / (unsigned long)total_steps,
+                     "run", cycles / BENCH_ITERATIONS);
+}
+
+// ---------------------------------------------------------------------------
+// LCD: a full repaint, and the same screen redrawn with one cell changed
+// (the shadow framebuffer sends only that cell). The caller's cycles
+// only queue the bytes; the repaint is also timed until the queue has
+// drained onto the LCD.
+// ---------------------------------------------------------------------------
+
+// Draw a two-line screen from blank in one frame
+static void Bench_LcdScreen(const char* line2) {
+    LCD_BeginFrame();
+    LCD_Clear();
+    LCD_String("0123456789ABCDEF");
+    LCD_Cmd(LCD_LINE2);
+    LCD_String((char*)line2);
+    LCD_EndFrame();
+}
+
+void Bench_Lcd(void) {
+    unsigned long start;
+    unsigned long repaint_cycles;
+    unsigned long shown_cycles;
+    unsigned long change_cycles;
+    
+    LCD_Clear();
+    LCD_Wait();
+    start = CycleCounter_Read();
+    Bench_LcdScreen("0123456789ABCDEF");
+    repaint_cycles = CycleCounter_Read() - start;
+    LCD_Wait();
+    shown_cycles = CycleCounter_Read() - start;
+    
+    start = CycleCounter_Read();
+    Bench_LcdScreen("0123456789ABCDE0");
+    change_cycles = CycleCounter_Read() - start;
+    LCD_Wait();
+    
+    Bench_ShowResult("LCD cycles", "all", repaint_cycles, "one", change_cycles);
+    Bench_ShowResult("LCD on screen", "us", shown_cycles / SYSTEM_CYCLES_PER_US,
+                     "peak", LCD_GetStats()->queue_peak);
+}
+
+// Run every benchmark in turn
+void Bench_Run(void) {
+    CycleCounter_Init();
+    
+    Bench_Evaluator();
+    Bench_NumberEntry();
+    Bench_FormatNumber();
+    Bench_NumberBackend();
+    Bench_IntegerPath();
+    Bench_Replay();
+    Bench_MathFn();
+    Bench_Stats();
+    Bench_Solve();
+    Bench_Integrate();
+    Bench_Matrix();
+    Bench_Rf();
+    Bench_Fraction();
+    Bench_Rpn();
+    Bench_Program();
+    Bench_Lcd();
+    
+    LCD_Clear();
+}
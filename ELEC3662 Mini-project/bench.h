@@ -0,0 +1,51 @@
+/*
+ * Benchmark Module Header
+ * 
+ * On-target cycle-count benchmarks for the calculator engine.
+ * Only built into the firmware when CALC_BENCHMARK is defined;
+ * results are shown on the LCD, one screen per benchmark.
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+// Number of timed repetitions per benchmark (cycles are reported per call)
+#ifndef BENCH_ITERATIONS
+#define BENCH_ITERATIONS    1000
+#endif
+
+// Number of random floats formatted by the number-formatting benchmark
+#ifndef BENCH_FORMAT_SAMPLES
+#define BENCH_FORMAT_SAMPLES    2000000
+#endif
+
+// Operand pairs per GCD benchmark (kept in a static array, so the timing
+// loop only reads them)
+#ifndef BENCH_GCD_PAIRS
+#define BENCH_GCD_PAIRS     256
+#endif
+
+// Function declarations
+void Bench_Run(void);
+void Bench_Evaluator(void);
+void Bench_NumberEntry(void);
+void Bench_FormatNumber(void);
+void Bench_NumberBackend(void);
+void Bench_IntegerPath(void);
+void Bench_Replay(void);
+void Bench_MathFn(void);
+void Bench_Stats(void);
+void Bench_Solve(void);
+void Bench_Integrate(void);
+void Bench_Matrix(void);
+void Bench_Rf(void);
+void Bench_Fraction(void);
+void Bench_Rpn(void);
+void Bench_Program(void);
+void Bench_Lcd(void);
+
+// Display helper: "label" on line 1, "a:<n> b:<n>" cycle counts on line 2
+void Bench_ShowResult(const char* label, const char* name_a, unsigned long cycles_a,
+                      const char* name_b, unsigned long cycles_b);
+
+#endif // BENCH_H
@@ -0,0 +1,686 @@
+/*
+ * Arbitrary-Precision Number Implementation
+ *
+ * Magnitudes are little-endian arrays of base-10^9 limbs. Decimal limbs
+ * make the display and decimal-point alignment cheap (digit n is a divide
+ * within one limb) at the cost of a 64-bit divide per limb product.
+ *   add/subtract - limb-wise with carry/borrow after aligning the scales
+ *   multiply     - schoolbook below BIGNUM_KARATSUBA_LIMBS, Karatsuba above
+ *   divide       - long division, one limb of quotient per step, with the
+ *                  quotient limb estimated from the top limbs and corrected
+ * Scratch space for Karatsuba and division is taken from the top of the
+ * arena and released when the operation finishes.
+ */
+
+#include "bignum.h"
+#include <string.h>
+
+#define BASE            1000000000UL
+#define BASE_DIGITS     9
+
+static const uint32_t pow10_u32[BASE_DIGITS + 1] = {
+    1UL, 10UL, 100UL, 1000UL, 10000UL, 100000UL,
+    1000000UL, 10000000UL, 100000000UL, 1000000000UL
+};
+
+// Limbs of a number in its arena
+#define LIMBS(arena, n)     (&(arena)->limbs[(n)->offset])
+
+// ---------------------------------------------------------------------------
+// Arena
+// ---------------------------------------------------------------------------
+
+void BigArena_Init(BigArena* arena) {
+    arena->used = 0;
+}
+
+// Take limbs from the top of the arena; returns the offset or -1 when full
+// (or for a count below 1, which would move used back over live values)
+static int BigArena_Alloc(BigArena* arena, int limbs) {
+    if(limbs <= 0 || limbs > BIGNUM_ARENA_LIMBS - arena->used) {
+        return -1;
+    }
+    int offset = arena->used;
+    arena->used += limbs;
+    return offset;
+}
+
+// Move the live numbers down to the start of the arena, in address order,
+// and free everything above them
+void BigArena_Compact(BigArena* arena, BigNum* live[], int count) {
+    int top = 0;
+
+    // Insertion sort by offset (only a handful of live values)
+    for(int i = 1; i < count; i++) {
+        BigNum* value = live[i];
+        int j = i - 1;
+        while(j >= 0 && live[j]->offset > value->offset) {
+            live[j + 1] = live[j];
+            j--;
+        }
+        live[j + 1] = value;
+    }
+
+    for(int i = 0; i < count; i++) {
+        if(live[i]->length == 0) {
+            continue;
+        }
+        if(live[i]->offset != top) {
+            memmove(&arena->limbs[top], LIMBS(arena, live[i]),
+                    live[i]->length * sizeof(uint32_t));
+            live[i]->offset = top;
+        }
+        top += live[i]->length;
+    }
+    arena->used = top;
+}
+
+// ---------------------------------------------------------------------------
+// Magnitude helpers (limb arrays)
+// ---------------------------------------------------------------------------
+
+// Length without leading zero limbs
+static int Mag_Trim(const uint32_t* a, int length) {
+    while(length > 0 && a[length - 1] == 0) {
+        length--;
+    }
+    return length;
+}
+
+static int Mag_Compare(const uint32_t* a, int la, const uint32_t* b, int lb) {
+    if(la != lb) {
+        return (la > lb) ? 1 : -1;
+    }
+    for(int i = la - 1; i >= 0; i--) {
+        if(a[i] != b[i]) {
+            return (a[i] > b[i]) ? 1 : -1;
+        }
+    }
+    return 0;
+}
+
+// r = a + b (r needs max(la, lb) + 1 limbs and may be a or b)
+static int Mag_Add(uint32_t* r, const uint32_t* a, int la, const uint32_t* b, int lb) {
+    uint32_t carry = 0;
+
+    if(la < lb) {
+        const uint32_t* swap = a;
+        a = b;
+        b = swap;
+        int length = la;
+        la = lb;
+        lb = length;
+    }
+    for(int i = 0; i < la; i++) {
+        uint32_t sum = a[i] + ((i < lb) ? b[i] : 0) + carry;
+        carry = (sum >= BASE);
+        r[i] = carry ? sum - BASE : sum;
+    }
+    if(carry) {
+        r[la++] = 1;
+    }
+    return la;
+}
+
+// r = a - b for a >= b (r may be a or b)
+static int Mag_Sub(uint32_t* r, const uint32_t* a, int la, const uint32_t* b, int lb) {
+    uint32_t borrow = 0;
+
+    for(int i = 0; i < la; i++) {
+        uint32_t take = ((i < lb) ? b[i] : 0) + borrow;
+        if(a[i] >= take) {
+            r[i] = a[i] - take;
+            borrow = 0;
+        } else {
+            r[i] = a[i] + BASE - take;
+            borrow = 1;
+        }
+    }
+    return Mag_Trim(r, la);
+}
+
+// r += a, carrying up to r[lr - 1] (the sum must fit)
+static void Mag_AddAt(uint32_t* r, int lr, const uint32_t* a, int la) {
+    uint32_t carry = 0;
+
+    for(int i = 0; i < lr && (i < la || carry); i++) {
+        uint32_t sum = r[i] + ((i < la) ? a[i] : 0) + carry;
+        carry = (sum >= BASE);
+        r[i] = carry ? sum - BASE : sum;
+    }
+}
+
+// r = a  m + add for m, add < BASE (r needs la + 1 limbs and may be a)
+static int Mag_MulSmall(uint32_t* r, const uint32_t* a, int la, uint32_t m, uint32_t add) {
+    uint64_t carry = add;
+
+    for(int i = 0; i < la; i++) {
+        uint64_t t = (uint64_t)a[i] * m + carry;
+        r[i] = (uint32_t)(t % BASE);
+        carry = t / BASE;
+    }
+    if(carry) {
+        r[la++] = (uint32_t)carry;
+    }
+    return Mag_Trim(r, la);
+}
+
+// a /= d in place for d < BASE; returns the remainder
+static uint32_t Mag_DivSmall(uint32_t* a, int* la, uint32_t d) {
+    uint64_t remainder = 0;
+
+    for(int i = *la - 1; i >= 0; i--) {
+        uint64_t t = remainder * BASE + a[i];
+        a[i] = (uint32_t)(t / d);
+        remainder = t % d;
+    }
+    *la = Mag_Trim(a, *la);
+    return (uint32_t)remainder;
+}
+
+// r = a  10^k (r needs la + k/9 + 1 limbs and may be a)
+static int Mag_MulPow10(uint32_t* r, const uint32_t* a, int la, int k) {
+    int shift = k / BASE_DIGITS;
+
+    memmove(r + shift, a, la * sizeof(uint32_t));
+    memset(r, 0, shift * sizeof(uint32_t));
+    return Mag_MulSmall(r, r, la + shift, pow10_u32[k % BASE_DIGITS], 0);
+}
+
+// r = a  b by rows (r has la + lb limbs, not trimmed)
+static void Mag_MulSchool(uint32_t* r, const uint32_t* a, int la, const uint32_t* b, int lb) {
+    memset(r, 0, (la + lb) * sizeof(uint32_t));
+    for(int i = 0; i < la; i++) {
+        uint64_t carry = 0;
+        if(a[i] == 0) {
+            continue;
+        }
+        for(int j = 0; j < lb; j++) {
+            uint64_t t = (uint64_t)a[i] * b[j] + r[i + j] + carry;
+            r[i + j] = (uint32_t)(t % BASE);
+            carry = t / BASE;
+        }
+        r[i + lb] = (uint32_t)carry;
+    }
+}
+
+// r = a  b (r has la + lb limbs, not trimmed, must not overlap a or b).
+// Karatsuba: with a = a1B^m + a0 and b = b1B^m + b0,
+//   a  b = z2B^2m + z1B^m + z0
+//   z0 = a0b0, z2 = a1b1, z1 = (a0 + a1)(b0 + b1) - z0 - z2
+// so each level needs three half-size products instead of four.
+static int Mag_Multiply(BigArena* arena, uint32_t* r, const uint32_t* a, int la,
+                        const uint32_t* b, int lb) {
+    int mark = arena->used;
+
+    if(la < lb) {
+        const uint32_t* swap = a;
+        a = b;
+        b = swap;
+        int length = la;
+        la = lb;
+        lb = length;
+    }
+    if(lb < BIGNUM_KARATSUBA_LIMBS) {
+        Mag_MulSchool(r, a, la, b, lb);
+        return BIGNUM_OK;
+    }
+
+    int m = (la + 1) / 2;
+
+    if(lb <= m) {
+        // Unbalanced: b has no upper half, so a  b = a1bB^m + a0b
+        int offset = BigArena_Alloc(arena, la - m + lb);
+        if(offset < 0) {
+            return BIGNUM_NO_MEMORY;
+        }
+        uint32_t* upper = &arena->limbs[offset];
+
+        if(Mag_Multiply(arena, r, a, m, b, lb) != BIGNUM_OK ||
+           Mag_Multiply(arena, upper, a + m, la - m, b, lb) != BIGNUM_OK) {
+            arena->used = mark;
+            return BIGNUM_NO_MEMORY;
+        }
+        memset(r + m + lb, 0, (la - m) * sizeof(uint32_t));
+        Mag_AddAt(r + m, la + lb - m, upper, la - m + lb);
+        arena->used = mark;
+        return BIGNUM_OK;
+    }
+
+    // z0 and z2 go straight into the low and high halves of r
+    if(Mag_Multiply(arena, r, a, m, b, m) != BIGNUM_OK ||
+       Mag_Multiply(arena, r + 2 * m, a + m, la - m, b + m, lb - m) != BIGNUM_OK) {
+        arena->used = mark;
+        return BIGNUM_NO_MEMORY;
+    }
+
+    int offset = BigArena_Alloc(arena, 4 * m + 4);
+    if(offset < 0) {
+        return BIGNUM_NO_MEMORY;
+    }
+    uint32_t* sum_a = &arena->limbs[offset];
+    uint32_t* sum_b = sum_a + m + 1;
+    uint32_t* middle = sum_b + m + 1;
+
+    int length_a = Mag_Add(sum_a, a, m, a + m, la - m);
+    int length_b = Mag_Add(sum_b, b, m, b + m, lb - m);
+    if(Mag_Multiply(arena, middle, sum_a, length_a, sum_b, length_b) != BIGNUM_OK) {
+        arena->used = mark;
+        return BIGNUM_NO_MEMORY;
+    }
+
+    int length = Mag_Trim(middle, length_a + length_b);
+    length = Mag_Sub(middle, middle, length, r, Mag_Trim(r, 2 * m));
+    length = Mag_Sub(middle, middle, length, r + 2 * m, Mag_Trim(r + 2 * m, la + lb - 2 * m));
+    Mag_AddAt(r + m, la + lb - m, middle, length);
+
+    arena->used = mark;
+    return BIGNUM_OK;
+}
+
+// Subtract q  d from the ld + 1 limb window w; returns the new top limb,
+// negative if q was too large
+static int64_t Mag_SubMul(uint32_t* w, const uint32_t* d, int ld, uint32_t q) {
+    uint64_t carry = 0;
+    uint32_t borrow = 0;
+
+    for(int j = 0; j < ld; j++) {
+        uint64_t product = (uint64_t)d[j] * q + carry;
+        uint32_t take = (uint32_t)(product % BASE) + borrow;
+        carry = product / BASE;
+        if(w[j] >= take) {
+            w[j] -= take;
+            borrow = 0;
+        } else {
+            w[j] = w[j] + BASE - take;
+            borrow = 1;
+        }
+    }
+    return (int64_t)w[ld] - (int64_t)carry - borrow;
+}
+
+// q = n / d, leaving the remainder in n. n has ln limbs plus one spare,
+// d has ld >= 1 limbs (top limb non-zero), q needs ln - ld + 1 limbs.
+// Returns the quotient length.
+static int Mag_Divide(uint32_t* q, uint32_t* n, int ln, const uint32_t* d, int ld) {
+    if(ln < ld) {
+        return 0;
+    }
+    if(ld == 1) {
+        memcpy(q, n, ln * sizeof(uint32_t));
+        n[0] = Mag_DivSmall(q, &ln, d[0]);
+        return ln;
+    }
+
+    double divisor = (double)d[ld - 1] * BASE + d[ld - 2];
+    n[ln] = 0;
+
+    for(int i = ln - ld; i >= 0; i--) {
+        uint32_t* w = n + i;
+
+        // Estimate from the top three limbs of the window; off by at most
+        // a few units, which the loops below correct
+        double top = ((double)w[ld] * BASE + w[ld - 1]) * BASE + w[ld - 2];
+        double estimate = top / divisor;
+        uint32_t digit = (estimate >= BASE - 1) ? BASE - 1 : (uint32_t)estimate;
+
+        int64_t high = Mag_SubMul(w, d, ld, digit);
+        while(high < 0) {
+            // Too large: add d back
+            uint32_t carry = 0;
+            for(int j = 0; j < ld; j++) {
+                uint32_t sum = w[j] + d[j] + carry;
+                carry = (sum >= BASE);
+                w[j] = carry ? sum - BASE : sum;
+            }
+            high += carry;
+            digit--;
+        }
+        w[ld] = (uint32_t)high;
+
+        // Too small: subtract d again
+        while(Mag_Compare(w, Mag_Trim(w, ld + 1), d, ld) >= 0) {
+            Mag_Sub(w, w, ld + 1, d, ld);
+            digit++;
+        }
+        q[i] = digit;
+    }
+    return Mag_Trim(q, ln - ld + 1);
+}
+
+// ---------------------------------------------------------------------------
+// Numbers
+// ---------------------------------------------------------------------------
+
+// Give result room for limbs at the top of the arena
+static int BigNum_Alloc(BigArena* arena, BigNum* result, int limbs) {
+    int offset = BigArena_Alloc(arena, limbs);
+    if(offset < 0) {
+        return BIGNUM_NO_MEMORY;
+    }
+    result->offset = offset;
+    result->length = 0;
+    result->negative = 0;
+    result->scale = 0;
+    return BIGNUM_OK;
+}
+
+// Canonical form: no leading zero limbs, no trailing zeros after the
+// decimal point. Unused room is given back if result is the top allocation.
+static void BigNum_Finish(BigArena* arena, BigNum* result, int allocated) {
+    uint32_t* d = LIMBS(arena, result);
+    int whole = 0;
+    int digits = 0;
+
+    result->length = Mag_Trim(d, result->length);
+    if(result->length == 0) {
+        result->negative = 0;
+        result->scale = 0;
+    } else {
+        // Whole zero limbs after the point, then single digits
+        while(result->scale >= BASE_DIGITS && d[whole] == 0) {
+            whole++;
+            result->scale -= BASE_DIGITS;
+        }
+        if(whole > 0) {
+            result->length -= whole;
+            memmove(d, d + whole, result->length * sizeof(uint32_t));
+        }
+        uint32_t low = d[0];
+        while(digits < result->scale && low % 10 == 0) {
+            low /= 10;
+            digits++;
+        }
+        if(digits > 0) {
+            Mag_DivSmall(d, &result->length, pow10_u32[digits]);
+            result->scale -= digits;
+        }
+    }
+
+    if(result->offset + allocated == arena->used) {
+        arena->used = result->offset + result->length;
+    }
+}
+
+void BigNum_Zero(BigNum* result) {
+    result->offset = 0;
+    result->length = 0;
+    result->negative = 0;
+    result->scale = 0;
+}
+
+int BigNum_IsZero(const BigNum* value) {
+    return value->length == 0;
+}
+
+int BigNum_FromInput(BigArena* arena, BigNum* result,
+                     unsigned long long mantissa, int decimal_places) {
+    if(BigNum_Alloc(arena, result, 3) != BIGNUM_OK) {
+        return BIGNUM_NO_MEMORY;
+    }
+    uint32_t* d = LIMBS(arena, result);
+
+    while(mantissa > 0) {
+        d[result->length++] = (uint32_t)(mantissa % BASE);
+        mantissa /= BASE;
+    }
+    result->scale = decimal_places;
+    BigNum_Finish(arena, result, 3);
+    return BIGNUM_OK;
+}
+
+// result = a  b: the operand with fewer decimal places is aligned into
+// the result buffer, then the other is added, or the smaller magnitude is
+// subtracted from the larger. No scratch space is needed.
+static int BigNum_AddSigned(BigArena* arena, BigNum* result, const BigNum* a,
+                            const BigNum* b, int negate_b) {
+    const BigNum* x = a;
+    const BigNum* y = b;
+    int negative_x = a->negative;
+    int negative_y = b->negative ^ negate_b;
+
+    if(x->scale > y->scale) {
+        const BigNum* swap = x;
+        int negative = negative_x;
+        x = y;
+        y = swap;
+        negative_x = negative_y;
+        negative_y = negative;
+    }
+    int shift = y->scale - x->scale;
+    int room = x->length + shift / BASE_DIGITS + 1;
+    if(room < y->length) {
+        room = y->length;
+    }
+    room++;
+
+    if(BigNum_Alloc(arena, result, room) != BIGNUM_OK) {
+        return BIGNUM_NO_MEMORY;
+    }
+    uint32_t* r = LIMBS(arena, result);
+    const uint32_t* yl = LIMBS(arena, y);
+    int lx = Mag_MulPow10(r, LIMBS(arena, x), x->length, shift);
+
+    if(negative_x == negative_y) {
+        result->length = Mag_Add(r, r, lx, yl, y->length);
+        result->negative = negative_x;
+    } else if(Mag_Compare(r, lx, yl, y->length) >= 0) {
+        result->length = Mag_Sub(r, r, lx, yl, y->length);
+        result->negative = negative_x;
+    } else {
+        result->length = Mag_Sub(r, yl, y->length, r, lx);
+        result->negative = negative_y;
+    }
+    result->scale = y->scale;
+
+    BigNum_Finish(arena, result, room);
+    return BIGNUM_OK;
+}
+
+int BigNum_Add(BigArena* arena, BigNum* result, const BigNum* a, const BigNum* b) {
+    return BigNum_AddSigned(arena, result, a, b, 0);
+}
+
+int BigNum_Subtract(BigArena* arena, BigNum* result, const BigNum* a, const BigNum* b) {
+    return BigNum_AddSigned(arena, result, a, b, 1);
+}
+
+int BigNum_Multiply(BigArena* arena, BigNum* result, const BigNum* a, const BigNum* b) {
+    int room = a->length + b->length;
+
+    if(a->length == 0 || b->length == 0) {
+        BigNum_Zero(result);
+        return BIGNUM_OK;
+    }
+    if(BigNum_Alloc(arena, result, room) != BIGNUM_OK) {
+        return BIGNUM_NO_MEMORY;
+    }
+    if(Mag_Multiply(arena, LIMBS(arena, result), LIMBS(arena, a), a->length,
+                    LIMBS(arena, b), b->length) != BIGNUM_OK) {
+        arena->used = result->offset;
+        return BIGNUM_NO_MEMORY;
+    }
+    result->length = room;
+    result->negative = a->negative ^ b->negative;
+    result->scale = a->scale + b->scale;
+    BigNum_Finish(arena, result, room);
+    return BIGNUM_OK;
+}
+
+// The quotient is computed with one extra decimal place as an integer
+// division of the scaled magnitudes, then rounded half up on that digit
+int BigNum_Divide(BigArena* arena, BigNum* result, const BigNum* a, const BigNum* b) {
+    if(b->length == 0) {
+        return BIGNUM_DIV_ZERO;
+    }
+    if(a->length == 0) {
+        BigNum_Zero(result);
+        return BIGNUM_OK;
+    }
+
+    // a / b  10^k is the quotient as an integer with DIV_PLACES + 1 places
+    int k = BIGNUM_DIV_PLACES + 1 + b->scale - a->scale;
+    int shift_a = (k > 0) ? k : 0;
+    int shift_b = (k < 0) ? -k : 0;
+    int room_n = a->length + shift_a / BASE_DIGITS + 2;
+    int room_d = b->length + shift_b / BASE_DIGITS + 1;
+    int room_q = room_n - b->length + 2;
+
+    // A divisor longer than the shifted dividend leaves no quotient limbs;
+    // the zero result still needs its one limb of room
+    if(room_q < 1) {
+        room_q = 1;
+    }
+
+    if(BigNum_Alloc(arena, result, room_q) != BIGNUM_OK) {
+        return BIGNUM_NO_MEMORY;
+    }
+    int mark = arena->used;
+    int offset_n = BigArena_Alloc(arena, room_n);
+    int offset_d = BigArena_Alloc(arena, room_d);
+    if(offset_n < 0 || offset_d < 0) {
+        arena->used = result->offset;
+        return BIGNUM_NO_MEMORY;
+    }
+    uint32_t* n = &arena->limbs[offset_n];
+    uint32_t* d = &arena->limbs[offset_d];
+    uint32_t* q = LIMBS(arena, result);
+
+    int ln = Mag_MulPow10(n, LIMBS(arena, a), a->length, shift_a);
+    int ld = Mag_MulPow10(d, LIMBS(arena, b), b->length, shift_b);
+
+    // a / b below 10^-(BIGNUM_DIV_PLACES + 1): the rounded quotient is 0
+    if(Mag_Compare(n, ln, d, ld) < 0) {
+        arena->used = result->offset;
+        BigNum_Zero(result);
+        return BIGNUM_OK;
+    }
+    int lq = Mag_Divide(q, n, ln, d, ld);
+
+    // Drop the extra place, rounding half up
+    if(Mag_DivSmall(q, &lq, 10) >= 5) {
+        lq = Mag_MulSmall(q, q, lq, 1, 1);
+    }
+
+    arena->used = mark;
+    result->length = lq;
+    result->negative = a->negative ^ b->negative;
+    result->scale = BIGNUM_DIV_PLACES;
+    BigNum_Finish(arena, result, room_q);
+    return BIGNUM_OK;
+}
+
+// result = a  10^exponent; the exponent must be an integer small enough
+// that the result could fit in the arena
+int BigNum_Scale10(BigArena* arena, BigNum* result, const BigNum* a, const BigNum* exponent) {
+    const int limit = BIGNUM_ARENA_LIMBS * BASE_DIGITS;
+    int e;
+
+    if(exponent->scale != 0 || exponent->length > 1) {
+        return BIGNUM_RANGE;
+    }
+    e = (exponent->length == 0) ? 0 : (int)arena->limbs[exponent->offset];
+    if(e > limit) {
+        return BIGNUM_RANGE;
+    }
+    if(exponent->negative) {
+        e = -e;
+    }
+
+    int shift = (e > a->scale) ? e - a->scale : 0;
+    int room = a->length + shift / BASE_DIGITS + 1;
+    if(a->length == 0) {
+        BigNum_Zero(result);
+        return BIGNUM_OK;
+    }
+    if(BigNum_Alloc(arena, result, room) != BIGNUM_OK) {
+        return BIGNUM_NO_MEMORY;
+    }
+
+    // Positive exponents use up decimal places first, then shift in zeros
+    result->length = Mag_MulPow10(LIMBS(arena, result), LIMBS(arena, a), a->length, shift);
+    result->negative = a->negative;
+    result->scale = a->scale - e + shift;
+    BigNum_Finish(arena, result, room);
+    return BIGNUM_OK;
+}
+
+// ---------------------------------------------------------------------------
+// Display
+// ---------------------------------------------------------------------------
+
+// Number of significant digits in the magnitude
+static int BigNum_DigitCount(const BigArena* arena, const BigNum* value) {
+    uint32_t top = arena->limbs[value->offset + value->length - 1];
+    int digits = (value->length - 1) * BASE_DIGITS + 1;
+
+    while(digits % BASE_DIGITS != 0 && top >= pow10_u32[(digits - 1) % BASE_DIGITS + 1]) {
+        digits++;
+    }
+    return digits;
+}
+
+// Digit i of the magnitude, counting from the most significant
+static char BigNum_Digit(const BigArena* arena, const BigNum* value, int digits, int i) {
+    int position = digits - 1 - i;
+    uint32_t limb = arena->limbs[value->offset + position / BASE_DIGITS];
+    return (char)('0' + (limb / pow10_u32[position % BASE_DIGITS]) % 10);
+}
+
+int BigNum_TextLength(const BigArena* arena, const BigNum* value) {
+    if(value->length == 0) {
+        return 1;
+    }
+
+    int digits = BigNum_DigitCount(arena, value);
+    int length = value->negative;
+    if(value->scale == 0) {
+        length += digits;
+    } else if(digits > value->scale) {
+        length += digits + 1;                  // ddd.ddd
+    } else {
+        length += 2 + value->scale;            // 0.000ddd
+    }
+    return length;
+}
+
+char BigNum_CharAt(const BigArena* arena, const BigNum* value, int index) {
+    if(value->length == 0) {
+        return (index == 0) ? '0' : ' ';
+    }
+    if(value->negative) {
+        if(index == 0) {
+            return '-';
+        }
+        index--;
+    }
+
+    int digits = BigNum_DigitCount(arena, value);
+    if(value->scale == 0) {
+        return (index < digits) ? BigNum_Digit(arena, value, digits, index) : ' ';
+    }
+    if(digits > value->scale) {
+        int whole = digits - value->scale;
+        if(index < whole) {
+            return BigNum_Digit(arena, value, digits, index);
+        }
+        if(index == whole) {
+            return '.';
+        }
+        return (index <= digits) ? BigNum_Digit(arena, value, digits, index - 1) : ' ';
+    }
+
+    // 0.000ddd: leading zeros after the point, then the digits
+    int zeros = value->scale - digits;
+    if(index == 0) {
+        return '0';
+    }
+    if(index == 1) {
+        return '.';
+    }
+    index -= 2;
+    if(index < zeros) {
+        return '0';
+    }
+    return (index - zeros < digits) ? BigNum_Digit(arena, value, digits, index - zeros) : ' ';
+}
@@ -0,0 +1,76 @@
+/*
+ * Arbitrary-Precision Number Header
+ *
+ * Exact decimal numbers of any length: value = digits  10^-scale, with
+ * the digits held as base-10^9 limbs (9 decimal digits per 32-bit word).
+ * Limbs live in a fixed-size arena owned by the caller, so there is no
+ * malloc; every operation reports BIGNUM_NO_MEMORY instead of faulting
+ * when the arena is full.
+ *
+ * Results are always written to fresh arena space, so two BigNums never
+ * share limbs. BigArena_Compact() moves the values still in use back to
+ * the start of the arena and frees everything else.
+ */
+
+#ifndef BIGNUM_H
+#define BIGNUM_H
+
+#include <stdint.h>
+
+// Arena size in limbs (9 digits each): 512 limbs = 2 KB, enough for the
+// operands and scratch space of a multiply with a ~1500-digit result
+#ifndef BIGNUM_ARENA_LIMBS
+#define BIGNUM_ARENA_LIMBS      512
+#endif
+
+// Operands at least this many limbs long are multiplied with Karatsuba
+#ifndef BIGNUM_KARATSUBA_LIMBS
+#define BIGNUM_KARATSUBA_LIMBS  16
+#endif
+
+// Decimal places kept by division (rounded half up)
+#define BIGNUM_DIV_PLACES       24
+
+// Status codes returned by every operation
+#define BIGNUM_OK               0
+#define BIGNUM_NO_MEMORY        1   // Arena exhausted
+#define BIGNUM_DIV_ZERO         2   // Division by zero
+#define BIGNUM_RANGE            3   // E exponent not a usable integer
+
+typedef struct {
+    uint32_t limbs[BIGNUM_ARENA_LIMBS];
+    int      used;                  // Limbs allocated from the start of limbs[]
+} BigArena;
+
+typedef struct {
+    int offset;                     // Index of the least significant limb in the arena
+    int length;                     // Limbs in use (0 for zero, no leading zero limbs)
+    int negative;                   // 1 if the value is negative
+    int scale;                      // Decimal places (no trailing zeros after the point)
+} BigNum;
+
+// Arena management
+void BigArena_Init(BigArena* arena);
+void BigArena_Compact(BigArena* arena, BigNum* live[], int count);
+
+// Construction
+void BigNum_Zero(BigNum* result);
+int  BigNum_FromInput(BigArena* arena, BigNum* result,
+                      unsigned long long mantissa, int decimal_places);
+
+// Exact arithmetic (division keeps BIGNUM_DIV_PLACES decimal places)
+int BigNum_Add(BigArena* arena, BigNum* result, const BigNum* a, const BigNum* b);
+int BigNum_Subtract(BigArena* arena, BigNum* result, const BigNum* a, const BigNum* b);
+int BigNum_Multiply(BigArena* arena, BigNum* result, const BigNum* a, const BigNum* b);
+int BigNum_Divide(BigArena* arena, BigNum* result, const BigNum* a, const BigNum* b);
+int BigNum_Scale10(BigArena* arena, BigNum* result, const BigNum* a, const BigNum* exponent);
+
+// Queries
+int BigNum_IsZero(const BigNum* value);
+
+// Display text ("-123.456"), read one character at a time so a result of
+// any length can be scrolled without formatting it into a buffer
+int  BigNum_TextLength(const BigArena* arena, const BigNum* value);
+char BigNum_CharAt(const BigArena* arena, const BigNum* value, int index);
+
+#endif // BIGNUM_H
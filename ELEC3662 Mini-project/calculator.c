@@ -8,29 +8,287 @@
  * Normal:  A=+  B=-  C=.  D=Shift  *=Equals  #=Backspace
  * Shifted: A=  B=  C=E  D=Cancel #=Clear
  * Shifted: 1= MS(store), 2 = MR(recall), 3 = MC(clear), 4 = M+(add), 5 = M-(subtract)
+ * Shifted: 6 = (, 7 = ), * = Replay (last expression on a new first number)
+ * Equals on a result repeats the last operator and operand
+ * Shifted: 8 = Function menu (1 sqrt, 2 sin, 3 cos, 4 tan, 5 ln, 6 log, 7 e^x), 0 = x^y
+ * Shifted: 9 = Mode menu (1 = normal, 2 = bignum, 3 = statistics, 4 = solve,
+ *          5 = integrate, 6 = table; A = next page: 7 = matrix, 8 = RF)
+ * Bignum results: # pages through the digits
+ * Statistics: A = add sample, Shift+C = "," between x and y, * = results,
+ *             Shift+* = recompute from the sample buffer
+ * Solve:      Shift+1 = X, * = enter the starting guess, then * = solve;
+ *             B = sign of the guess, Shift+# on an empty guess = new equation
+ * Integrate:  as solve, but * takes a, then b, then integrates
+ * Table:      as solve, but * takes the start X, then the step; then
+ *             A/B = next/previous row, C = plot
+ * Matrix:     1/2 = enter A/B (rows digit, cols digit, then * after each
+ *             cell), A = A+B, B = A-B, Shift+A = AB, 3 = det A,
+ *             4 = inverse of A, 5 = transpose of A, 6 = result to A,
+ *             0 = view the result (A/B = next/previous cell)
+ * RF:         as normal, but Shift+8 opens the RF menu first (1 dBm->mW,
+ *             2 mW->dBm, 3 dB->ratio, 4 ratio->dB, 5 MHz<->m, 6 = path
+ *             loss operator d L f); A there switches to the function menu
  */
 
 #include "calculator.h"
 #include "lcd.h"
+#include "glyph.h"
+#include "numformat.h"
+#include "system.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <float.h>
+#include <limits.h>
 
-// Initialize calculator
-void Calculator_Init(Calculator* calc) {
+// Internal helpers
+static CalcNumber Calculator_ApplyOperator(Calculator* calc, CalcNumber a, Operator op, CalcNumber b);
+static void       Calculator_CommitOperand(Calculator* calc);
+static void       Calculator_StashPower(Calculator* calc);
+static CalcNumber Calculator_Finish(Calculator* calc);
+static CalcNumber Calculator_Repeat(Calculator* calc);
+static void       Calculator_ShowResult(Calculator* calc, CalcNumber result);
+static void       Calculator_TapeOpenGroup(Calculator* calc);
+static void       Calculator_TapeCloseGroup(Calculator* calc);
+static void       Calculator_TapeVariable(Calculator* calc);
+static void       Calculator_BigCommitOperand(Calculator* calc);
+static void       Calculator_BigEquals(Calculator* calc);
+static void       Calculator_BigPage(Calculator* calc);
+static void       Calculator_FracCommitOperand(Calculator* calc);
+static void       Calculator_FracEquals(Calculator* calc);
+static void       Calculator_FracDisplay(Calculator* calc);
+static void       Calculator_RpnFunction(Calculator* calc, Operator fn);
+static void       Calculator_RpnDisplay(Calculator* calc);
+static void       Calculator_ProgramEnd(Calculator* calc);
+static void       Calculator_StatsKey(Calculator* calc, char key);
+static void       Calculator_SolveEquals(Calculator* calc);
+static void       Calculator_SolveKey(Calculator* calc, char key);
+static void       Calculator_IntegrateBound(Calculator* calc, float value);
+static void       Calculator_TableBound(Calculator* calc, float value);
+static int        Calculator_TableKey(Calculator* calc, char key);
+static void       Calculator_TableDisplay(Calculator* calc);
+static void       Calculator_MatrixKey(Calculator* calc, char key);
+static void       Calculator_MatrixDisplay(Calculator* calc);
+
+// Core clock, for the integrator's and programs' time readout
+#define CALC_CYCLES_PER_MS  (SYSTEM_CLOCK_HZ / 1000UL)
+
+// Powers of ten that fit a long long (10^0 .. 10^18), for the integer path
+static const long long int_pow10[19] = {
+    1LL,                 10LL,                 100LL,
+    1000LL,              10000LL,              100000LL,
+    1000000LL,           10000000LL,           100000000LL,
+    1000000000LL,        10000000000LL,        100000000000LL,
+    1000000000000LL,     10000000000000LL,     100000000000000LL,
+    1000000000000000LL,  10000000000000000LL,  100000000000000000LL,
+    1000000000000000000LL
+};
+
+// Statistics mode result pages, in the order * steps through them
+enum {
+    STATS_PAGE_COUNT,
+    STATS_PAGE_MEAN,
+    STATS_PAGE_STDDEV,
+    STATS_PAGE_MIN,
+    STATS_PAGE_MAX,
+    STATS_PAGE_SLOPE,
+    STATS_PAGE_INTERCEPT,
+    STATS_PAGE_R,
+    STATS_PAGES
+};
+
+static const char* const stats_page_labels[STATS_PAGES] = {
+    "n", "mean", "sd", "min", "max", "slope b", "intercept a", "r"
+};
+
+// Mode menu: the mode each digit picks, 1 to 9 then 0 as on the keypad,
+// and the screens ("A" pages on)
+static const CalcMode mode_menu_modes[] = {
+    MODE_NORMAL, MODE_BIGNUM, MODE_STATS, MODE_SOLVE, MODE_INTEGRATE, MODE_TABLE, MODE_MATRIX,
+    MODE_RF, MODE_FRACTION, MODE_RPN
+};
+#define MODE_MENU_MODES     ((int)(sizeof(mode_menu_modes) / sizeof(mode_menu_modes[0])))
+#define MODE_MENU_PAGES     2
+
+static const char* const mode_menu_lines[MODE_MENU_PAGES][2] = {
+    { "1Norm 2Big 3Stat", "4Solv 5Int 6Tab>" },
+    { "7Matrix 8RF",      "9Frac 0RPN     >" }
+};
+
+// Function menu: the function each digit applies, and the screens. RF mode
+// opens on its own screen and A switches between the two; the path loss
+// "function" enters its operator.
+#define FN_MENU_ITEMS       7
+#define FN_MENU_SCIENTIFIC  0
+#define FN_MENU_RF          1
+
+static const Operator fn_menu_functions[2][FN_MENU_ITEMS] = {
+    { OP_SQRT, OP_SIN, OP_COS, OP_TAN, OP_LN, OP_LOG10, OP_EXP },
+    { OP_DBM_TO_MW, OP_MW_TO_DBM, OP_DB_TO_RATIO, OP_RATIO_TO_DB, OP_WAVELENGTH, OP_PATH_LOSS, OP_NONE }
+};
+
+static const char* const fn_menu_lines[2][2] = {
+    { "1sqrt 2sin 3cos",  "4tan 5ln 6lg 7e^" },
+    { "1mW 2dBm 3x 4dB",  "5m/MHz 6FSPL   >" }
+};
+
+// RPN mode: the registers in the stack
+enum {
+    RPN_X,
+    RPN_Y,
+    RPN_Z,
+    RPN_T
+};
+
+// Matrix mode: the matrices in the pool, and the screens
+enum {
+    CALC_MATRIX_A,
+    CALC_MATRIX_B,
+    CALC_MATRIX_RESULT,
+    CALC_MATRIX_SCRATCH
+};
+
+enum {
+    MATRIX_SCREEN_MENU,                 // Sizes of A and B, waiting for an operation
+    MATRIX_SCREEN_SIZE,                 // Rows and columns of the matrix to enter
+    MATRIX_SCREEN_CELL,                 // Entering a cell
+    MATRIX_SCREEN_VIEW,                 // Stepping through a matrix's cells
+    MATRIX_SCREEN_DETERMINANT
+};
+
+// Turn any exception raised by the last reduction into an error message.
+// One flag read per reduction instead of a range check on every operation.
+static void Calculator_CheckExceptions(Calculator* calc) {
+    int flags = Number_TestExceptions();
+    
+    if(flags == 0 || calc->state == STATE_ERROR) {
+        return;
+    }
+    if(flags & NUMBER_INVALID) {
+        Calculator_SetError(calc, "Invalid result");
+    } else if(flags & NUMBER_OVERFLOW) {
+        Calculator_SetError(calc, "Overflow");
+    } else {
+        Calculator_SetError(calc, "Underflow");
+    }
+}
+
+// Reset everything except the statistics samples and the solver's equation
+static void Calculator_Reset(Calculator* calc) {
     calc->expression[0] = '0';
     calc->expression[1] = '\0';
     calc->input_buffer[0] = '\0';
     calc->input_pos = 0;
-    calc->operand_count = 0;
+    calc->input_start = 0;
     calc->operator_count = 0;
-    calc->current_number = 0.0f;
+    calc->function_count = 0;
+    calc->acc_sum = Number_Zero();
+    calc->acc_term = Number_Zero();
+    calc->acc_add_op = OP_ADD;
+    calc->pending_op = OP_NONE;
+    calc->pow_base = Number_Zero();
+    calc->pow_int = 0;
+    calc->pow_exact = 0;
+    calc->pow_op = OP_NONE;
+    calc->exact = 1;
+    calc->int_sum = 0;
+    calc->int_term = 0;
+    calc->tape_length = 0;
+    calc->tape_building = 0;
+    calc->tape_op_top = 0;
+    calc->repeat.op = OP_NONE;
+    calc->current_number = Number_Zero();
+    calc->int_result = 0;
+    calc->result_exact = 1;
+    calc->group_depth = 0;
+    calc->input_mantissa = 0;
     calc->has_decimal = 0;
     calc->decimal_places = 0;
     calc->state = STATE_ENTERING_NUMBER;
-    calc->memory = 0.0f;
+    calc->memory = Number_Zero();
     calc->shift_active = 0;
     calc->error_msg[0] = '\0';
+    calc->mode = MODE_NORMAL;
+    calc->mode_menu_active = 0;
+    calc->mode_menu_page = 0;
+    calc->fn_menu_active = 0;
+    calc->fn_menu_page = FN_MENU_SCIENTIFIC;
+    BigArena_Init(&calc->big_arena);
+    BigNum_Zero(&calc->big_sum);
+    BigNum_Zero(&calc->big_term);
+    BigNum_Zero(&calc->big_result);
+    calc->big_view = 0;
+    Fraction_FromInteger(&calc->frac_sum, 0);
+    Fraction_FromInteger(&calc->frac_term, 0);
+    Fraction_FromInteger(&calc->frac_result, 0);
+    calc->frac_decimal = 0;
+    calc->stats_x = 0.0f;
+    calc->stats_pair = 0;
+    calc->stats_page = 0;
+    calc->solve_shown = 0;
+    calc->solve_negative = 0;
+    calc->program_menu = 0;
+    calc->program_prompt = 0;
+    calc->program_shown = 0;
+}
+
+// Power-on state of every mode except the program store
+static void Calculator_Start(Calculator* calc) {
+    Calculator_Reset(calc);
+    Stats_Init(&calc->stats);
+    Solve_Init(&calc->solve_program);
+    calc->solve_x = 1.0f;
+    calc->solve_guess = 0;
+    calc->integrate_a = 0.0f;
+    calc->integrate_b = 1.0f;
+    calc->integrate_upper = 0;
+    calc->table_start = 0.0f;
+    calc->table_step = 1.0f;
+    calc->table_step_entry = 0;
+    Matrix_Init(&calc->matrix[CALC_MATRIX_A], 2, 2);
+    Matrix_Init(&calc->matrix[CALC_MATRIX_B], 2, 2);
+    Matrix_Init(&calc->matrix[CALC_MATRIX_RESULT], 1, 1);
+    calc->matrix_screen = MATRIX_SCREEN_MENU;
+    calc->matrix_menu_page = 0;
+    calc->matrix_edit = CALC_MATRIX_A;
+    calc->matrix_cell = 0;
+    calc->matrix_rows = 0;
+    calc->matrix_determinant = 0.0f;
+    for(int i = 0; i < CALC_RPN_LEVELS; i++) {
+        calc->rpn_stack[i] = Number_Zero();
+    }
+    calc->rpn_lift = 0;
+}
+
+// Initialize calculator
+void Calculator_Init(Calculator* calc) {
+    Calculator_Start(calc);
+    for(int i = 0; i < CALC_PROGRAMS; i++) {
+        Program_Clear(&calc->program[i]);
+    }
+    for(int i = 0; i < PROGRAM_REGISTERS; i++) {
+        calc->program_registers[i] = Number_Zero();
+    }
+    calc->program_recording = 0;
+    calc->program_steps = 0;
+    calc->program_cycles = 0;
+}
+
+// 1 in the modes whose expression is in X (compiled to a SolveProgram)
+static int Calculator_HasVariable(Calculator* calc) {
+    return calc->mode == MODE_SOLVE || calc->mode == MODE_INTEGRATE || calc->mode == MODE_TABLE;
+}
+
+// 1 in the modes that work as the everyday calculator, with memory, the
+// live preview and replay (RF mode only adds its conversions)
+static int Calculator_Everyday(Calculator* calc) {
+    return calc->mode == MODE_NORMAL || calc->mode == MODE_RF;
+}
+
+// 1 in the modes that work on CalcNumber expressions, where parentheses,
+// powers and functions are available
+static int Calculator_Scientific(Calculator* calc) {
+    return Calculator_Everyday(calc) || Calculator_HasVariable(calc);
 }
 
 // Toggle shift key
@@ -46,12 +304,74 @@ void Calculator_ProcessKey(Calculator* calc, char key) {
         Calculator_Clear(calc);
     }
     
+    // Mode menu: a digit picks the mode, A shows the next page, any other
+    // key cancels
+    if(calc->mode_menu_active) {
+        if(key == 'A') {
+            calc->mode_menu_page = (calc->mode_menu_page + 1) % MODE_MENU_PAGES;
+        } else {
+            calc->mode_menu_active = 0;
+            calc->mode_menu_page = 0;
+            int item = (key == '0') ? 9 : key - '1';
+            if(key >= '0' && key <= '9' && item < MODE_MENU_MODES) {
+                Calculator_SetMode(calc, mode_menu_modes[item]);
+            }
+        }
+        Calculator_DisplayUpdate(calc);
+        return;
+    }
+    
+    // Function menu: a digit applies the function, A switches screens in
+    // RF mode, any other key cancels
+    if(calc->fn_menu_active) {
+        if(key == 'A' && calc->mode == MODE_RF) {
+            calc->fn_menu_page = (calc->fn_menu_page == FN_MENU_RF) ? FN_MENU_SCIENTIFIC : FN_MENU_RF;
+        } else {
+            calc->fn_menu_active = 0;
+            if(key >= '1' && key < '1' + FN_MENU_ITEMS) {
+                Operator fn = fn_menu_functions[calc->fn_menu_page][key - '1'];
+                if(calc->mode == MODE_RPN) {
+                    Calculator_RpnFunction(calc, fn);
+                } else if(fn == OP_PATH_LOSS) {
+                    Calculator_EnterOperator(calc, fn);
+                } else {
+                    Calculator_ApplyFunction(calc, fn);
+                }
+            }
+        }
+        Calculator_DisplayUpdate(calc);
+        return;
+    }
+    
     // Handle shift key
     if(key == 'D') {
         Calculator_ToggleShift(calc);
         return;
     }
     
+    // Statistics, matrix and RPN modes, and the solver's starting guess (or
+    // the integral's bounds), have their own key maps
+    if(calc->mode == MODE_STATS) {
+        Calculator_StatsKey(calc, key);
+        Calculator_DisplayUpdate(calc);
+        return;
+    }
+    if(calc->mode == MODE_MATRIX) {
+        Calculator_MatrixKey(calc, key);
+        Calculator_DisplayUpdate(calc);
+        return;
+    }
+    if(calc->mode == MODE_RPN) {
+        Calculator_RpnKey(calc, key);
+        Calculator_DisplayUpdate(calc);
+        return;
+    }
+    if(Calculator_HasVariable(calc) && calc->solve_guess) {
+        Calculator_SolveKey(calc, key);
+        Calculator_DisplayUpdate(calc);
+        return;
+    }
+    
     // Process keys based on shift state
     if(calc->shift_active) {
         // Shifted mode
@@ -74,6 +394,47 @@ void Calculator_ProcessKey(Calculator* calc, char key) {
             // Delete entire entry (clear)
             Calculator_ClearEntry(calc);
             calc->shift_active = 0;
+        }
+        else if(key == '6') {
+            // Open parenthesis
+            Calculator_OpenGroup(calc);
+            calc->shift_active = 0;
+        }
+        else if(key == '7') {
+            // Close parenthesis
+            Calculator_CloseGroup(calc);
+            calc->shift_active = 0;
+        }
+        else if(key == '*') {
+            // Replay the last expression
+            Calculator_Replay(calc);
+            calc->shift_active = 0;
+        }
+        else if(key == '8') {
+            // Function menu (the functions work on CalcNumbers only)
+            calc->fn_menu_active = Calculator_Scientific(calc);
+            calc->fn_menu_page = (calc->mode == MODE_RF) ? FN_MENU_RF : FN_MENU_SCIENTIFIC;
+            calc->shift_active = 0;
+        }
+        else if(key == '0') {
+            // Power (x^y)
+            Calculator_EnterOperator(calc, OP_POWER);
+            calc->shift_active = 0;
+        }
+        else if(key == '9') {
+            // Mode menu
+            calc->mode_menu_active = 1;
+            calc->shift_active = 0;
+        }
+        else if(key == '1' && Calculator_HasVariable(calc)) {
+            // The variable X
+            Calculator_EnterVariable(calc);
+            calc->shift_active = 0;
+        }
+        else if(key >= '1' && key <= '5' && !Calculator_Everyday(calc)) {
+            // The memory register holds a CalcNumber, so bignum mode has no
+            // memory keys; the modes with an X use Shift+1 for it
+            calc->shift_active = 0;
         }
 				// ===== Memory keys in shifted mode =====
 				else if(key == '1') {
@@ -132,8 +493,16 @@ void Calculator_ProcessKey(Calculator* calc, char key) {
             Calculator_Equals(calc);
         }
         else if(key == '#') {
-            // Backspace
-            Calculator_Backspace(calc);
+            if(calc->mode == MODE_BIGNUM && calc->state == STATE_SHOW_RESULT) {
+                // Page through a long bignum result
+                Calculator_BigPage(calc);
+            } else if(calc->mode == MODE_FRACTION && calc->state == STATE_SHOW_RESULT) {
+                // Switch a fraction result between num/den and its decimal value
+                calc->frac_decimal = !calc->frac_decimal;
+            } else {
+                // Backspace
+                Calculator_Backspace(calc);
+            }
         }
     }
     
@@ -141,8 +510,42 @@ void Calculator_ProcessKey(Calculator* calc, char key) {
     Calculator_DisplayUpdate(calc);
 }
 
+// Value of the number being typed: mantissa  10^-decimal_places
+static CalcNumber Calculator_InputValue(Calculator* calc) {
+    return Number_FromInput(calc->input_mantissa, calc->decimal_places);
+}
+
+// Value the next action operates on: the number being typed, or the last result
+static CalcNumber Calculator_CurrentValue(Calculator* calc) {
+    if(calc->state == STATE_ENTERING_NUMBER) {
+        return Calculator_InputValue(calc);
+    }
+    return calc->current_number;
+}
+
+// As Calculator_CurrentValue, as an integer; returns 0 (and sets *value to
+// 0) if the value is not a whole number (typed digits after the point, or
+// an inexact result)
+static int Calculator_CurrentInteger(Calculator* calc, long long* value) {
+    if(calc->state == STATE_ENTERING_NUMBER) {
+        unsigned long long scale = (unsigned long long)int_pow10[calc->decimal_places];
+        if(calc->input_mantissa % scale != 0) {
+            *value = 0;
+            return 0;
+        }
+        *value = (long long)(calc->input_mantissa / scale);
+        return 1;
+    }
+    *value = calc->int_result;
+    return calc->result_exact;
+}
+
 // Enter a digit
 void Calculator_EnterDigit(Calculator* calc, char digit) {
+    if(calc->state == STATE_GROUP_CLOSED) {
+        // ")" must be followed by an operator
+        return;
+    }
     if(calc->state == STATE_SHOW_RESULT) {
         // Start new calculation after result
         Calculator_Clear(calc);
@@ -150,7 +553,7 @@ void Calculator_EnterDigit(Calculator* calc, char digit) {
     
     if(calc->state != STATE_ENTERING_NUMBER) {
         // Starting a new number after operator
-        calc->current_number = 0.0f;
+        calc->input_mantissa = 0;
         calc->has_decimal = 0;
         calc->decimal_places = 0;
         calc->input_buffer[0] = '\0';
@@ -158,25 +561,19 @@ void Calculator_EnterDigit(Calculator* calc, char digit) {
         calc->state = STATE_ENTERING_NUMBER;
     }
     
-    // Add to input buffer
-    if(calc->input_pos < MAX_INPUT_LENGTH - 1) {
-        calc->input_buffer[calc->input_pos++] = digit;
-        calc->input_buffer[calc->input_pos] = '\0';
+    // Add to input buffer (digits beyond the buffer are ignored, so the
+    // value always matches what is shown)
+    if(calc->input_pos >= MAX_INPUT_LENGTH - 1) {
+        return;
     }
+    calc->input_buffer[calc->input_pos++] = digit;
+    calc->input_buffer[calc->input_pos] = '\0';
     
-    int digit_value = digit - '0';
-    
+    // Append digit to the exact integer mantissa; a fractional digit just
+    // moves the decimal exponent down by one
+    calc->input_mantissa = calc->input_mantissa * 10 + (digit - '0');
     if(calc->has_decimal) {
-        // Add decimal digit
-        float divisor = 1.0f;
-        for(int i = 0; i <= calc->decimal_places; i++) {
-            divisor *= 10.0f;
-        }
-        calc->current_number += digit_value / divisor;
         calc->decimal_places++;
-    } else {
-        // Add integer digit
-        calc->current_number = calc->current_number * 10.0f + digit_value;
     }
     
     // Update expression display
@@ -185,12 +582,15 @@ void Calculator_EnterDigit(Calculator* calc, char digit) {
 
 // Enter decimal point
 void Calculator_EnterDecimal(Calculator* calc) {
+    if(calc->state == STATE_GROUP_CLOSED) {
+        return;
+    }
     if(calc->state == STATE_SHOW_RESULT) {
         Calculator_Clear(calc);
     }
     
     if(calc->state != STATE_ENTERING_NUMBER) {
-        calc->current_number = 0.0f;
+        calc->input_mantissa = 0;
         calc->has_decimal = 0;
         calc->decimal_places = 0;
         calc->input_buffer[0] = '0';
@@ -215,37 +615,25 @@ void Calculator_EnterDecimal(Calculator* calc) {
 
 // Backspace - remove last character
 void Calculator_Backspace(Calculator* calc) {
-    if(calc->state == STATE_SHOW_RESULT || calc->state == STATE_ERROR) {
+    if(calc->state == STATE_SHOW_RESULT || calc->state == STATE_ERROR ||
+       calc->state == STATE_GROUP_CLOSED) {
         return;
     }
     
     if(calc->state == STATE_ENTERING_NUMBER && calc->input_pos > 0) {
         // Remove last character from input buffer
         calc->input_pos--;
+        char removed = calc->input_buffer[calc->input_pos];
         calc->input_buffer[calc->input_pos] = '\0';
         
-        // Recalculate current number from input buffer
-        calc->current_number = 0.0f;
-        calc->has_decimal = 0;
-        calc->decimal_places = 0;
-        
-        int found_decimal = 0;
-        for(int i = 0; i < calc->input_pos; i++) {
-            if(calc->input_buffer[i] == '.') {
-                found_decimal = 1;
-                calc->has_decimal = 1;
-            } else {
-                int digit = calc->input_buffer[i] - '0';
-                if(!found_decimal) {
-                    calc->current_number = calc->current_number * 10.0f + digit;
-                } else {
-                    float divisor = 1.0f;
-                    for(int j = 0; j <= calc->decimal_places; j++) {
-                        divisor *= 10.0f;
-                    }
-                    calc->current_number += digit / divisor;
-                    calc->decimal_places++;
-                }
+        // Undo the last character: a digit drops out of the mantissa, the
+        // decimal point just clears has_decimal (nothing to re-parse)
+        if(removed == '.') {
+            calc->has_decimal = 0;
+        } else {
+            calc->input_mantissa /= 10;
+            if(calc->has_decimal) {
+                calc->decimal_places--;
             }
         }
         
@@ -254,7 +642,9 @@ void Calculator_Backspace(Calculator* calc) {
             calc->input_buffer[0] = '0';
             calc->input_buffer[1] = '\0';
             calc->input_pos = 1;
-            calc->current_number = 0.0f;
+            calc->input_mantissa = 0;
+            calc->has_decimal = 0;
+            calc->decimal_places = 0;
         }
         
         Calculator_UpdateInputBuffer(calc);
@@ -264,7 +654,7 @@ void Calculator_Backspace(Calculator* calc) {
 // Clear entry (keep expression)
 void Calculator_ClearEntry(Calculator* calc) {
     if(calc->state == STATE_ENTERING_NUMBER) {
-        calc->current_number = 0.0f;
+        calc->input_mantissa = 0;
         calc->has_decimal = 0;
         calc->decimal_places = 0;
         calc->input_buffer[0] = '0';
@@ -279,393 +669,2917 @@ void Calculator_ClearEntry(Calculator* calc) {
 
 // Update input buffer in expression
 void Calculator_UpdateInputBuffer(Calculator* calc) {
-    // Rebuild expression with current input
-    int len = strlen(calc->expression);
+    // Rebuild expression from the start of the current number; input_start is
+    // recorded when the operator is entered, so no rescan of the expression
+    calc->expression[calc->input_start] = '\0';
+    strncat(calc->expression, calc->input_buffer,
+            MAX_EXPRESSION_LENGTH - calc->input_start - 1);
+}
+
+// 1 right after "(", before the group has an operand ("(" clears
+// pending_op, and only an operator after an operand sets it again)
+static int Calculator_GroupEmpty(Calculator* calc) {
+    return calc->state == STATE_ENTERING_OPERATOR && calc->group_depth > 0 &&
+           calc->pending_op == OP_NONE;
+}
+
+// Enter an operator
+void Calculator_EnterOperator(Calculator* calc, Operator op) {
+    // Bignum and fraction modes have no x^y
+    if(calc->state == STATE_ERROR || (op == OP_POWER && !Calculator_Scientific(calc))) {
+        return;
+    }
     
-    // Find last operator position
-    int last_op = -1;
-    for(int i = len - 1; i >= 0; i--) {
-        if(calc->expression[i] == '+' || calc->expression[i] == '-' ||
-           calc->expression[i] == '*' || calc->expression[i] == '/' ||
-           calc->expression[i] == 'E') {
-            last_op = i;
-            break;
+    // "(" needs an operand before the next operator
+    if(Calculator_GroupEmpty(calc)) {
+        return;
+    }
+    if(calc->state == STATE_ENTERING_OPERATOR && calc->pending_op != OP_NONE) {
+        // ^ has already set its base aside, so it is not swapped with
+        // another operator
+        if(calc->pending_op == OP_POWER || op == OP_POWER) {
+            return;
         }
+        // Replace last operator (it has not been applied to anything yet)
+        calc->pending_op = op;
+        // Update display - remove last char and add new operator
+        int len = strlen(calc->expression);
+        if(len > 0) {
+            calc->expression[len - 1] = Calculator_OperatorToChar(op);
+        }
+        return;
     }
     
-    // Rebuild from operator or start
-    if(last_op >= 0) {
-        calc->expression[last_op + 1] = '\0';
-        strncat(calc->expression, calc->input_buffer, 
-                MAX_EXPRESSION_LENGTH - strlen(calc->expression) - 1);
+    // Expression is full: an error, since dropping the operator would run
+    // the next number's digits onto this one
+    if(calc->operator_count >= MAX_OPERATORS) {
+        Calculator_SetError(calc, "Too long");
+        return;
+    }
+    
+    // Save current number (or the previous result, to chain on from it)
+    if(calc->mode == MODE_BIGNUM) {
+        Calculator_BigCommitOperand(calc);
+    } else if(calc->mode == MODE_FRACTION) {
+        Calculator_FracCommitOperand(calc);
+    } else if(op == OP_POWER) {
+        Calculator_StashPower(calc);
     } else {
-        strncpy(calc->expression, calc->input_buffer, MAX_EXPRESSION_LENGTH - 1);
-        calc->expression[MAX_EXPRESSION_LENGTH - 1] = '\0';
+        Calculator_CommitOperand(calc);
     }
-}
-
-// Enter an operator
-void Calculator_EnterOperator(Calculator* calc, Operator op) {
     if(calc->state == STATE_ERROR) {
         return;
     }
+    calc->current_number = Number_Zero();
+    calc->int_result = 0;
+    calc->result_exact = 1;
+    calc->input_mantissa = 0;
+    calc->has_decimal = 0;
+    calc->decimal_places = 0;
+    calc->input_buffer[0] = '\0';
+    calc->input_pos = 0;
     
-    if(calc->state == STATE_ENTERING_NUMBER) {
-        // Save current number as operand
-        if(calc->operand_count < MAX_OPERANDS) {
-            calc->operands[calc->operand_count++] = calc->current_number;
-        }
-        calc->current_number = 0.0f;
-        calc->has_decimal = 0;
-        calc->decimal_places = 0;
-        calc->input_buffer[0] = '\0';
-        calc->input_pos = 0;
-    }
+    calc->operator_count++;
+    calc->pending_op = op;
     
-    // Add operator (or replace last operator if consecutive)
-    if(calc->operator_count < MAX_OPERATORS) {
-        if(calc->state == STATE_ENTERING_OPERATOR && calc->operator_count > 0) {
-            // Replace last operator
-            calc->operators[calc->operator_count - 1] = op;
-            // Update display - remove last char and add new operator
-            int len = strlen(calc->expression);
-            if(len > 0) {
-                calc->expression[len - 1] = Calculator_OperatorToChar(op);
-            }
-        } else {
-            calc->operators[calc->operator_count++] = op;
-            // Add operator to display
-            int len = strlen(calc->expression);
-            if(len < MAX_EXPRESSION_LENGTH - 1) {
-                calc->expression[len] = Calculator_OperatorToChar(op);
-                calc->expression[len + 1] = '\0';
-            }
-        }
+    // Add operator to display; the next number is typed after it
+    int len = strlen(calc->expression);
+    if(len < MAX_EXPRESSION_LENGTH - 1) {
+        calc->expression[len] = Calculator_OperatorToChar(op);
+        calc->expression[len + 1] = '\0';
+        len++;
     }
+    calc->input_start = len;
     
     calc->state = STATE_ENTERING_OPERATOR;
 }
 
-// Calculate result with PEMDAS precedence
-float Calculator_Calculate(Calculator* calc) {
-    // Add last number if we're entering one
-    if(calc->state == STATE_ENTERING_NUMBER) {
-        if(calc->operand_count < MAX_OPERANDS) {
-            calc->operands[calc->operand_count++] = calc->current_number;
-        }
+// Append one character to the expression; the next number is typed after it
+static void Calculator_AppendChar(Calculator* calc, char c) {
+    int len = strlen(calc->expression);
+    if(len < MAX_EXPRESSION_LENGTH - 1) {
+        calc->expression[len] = c;
+        calc->expression[len + 1] = '\0';
+        len++;
     }
+    calc->input_start = len;
+}
+
+// Save the running evaluation and start an empty one for the group
+static void Calculator_PushGroup(Calculator* calc) {
+    CalcGroup* group = &calc->groups[calc->group_depth++];
     
-    // Need at least 2 operands to calculate
-    if(calc->operand_count < 2) {
-        return calc->operand_count == 1 ? calc->operands[0] : 0.0f;
-    }
+    group->acc_sum = calc->acc_sum;
+    group->acc_term = calc->acc_term;
+    group->acc_add_op = calc->acc_add_op;
+    group->pending_op = calc->pending_op;
+    group->exact = calc->exact;
+    group->int_sum = calc->int_sum;
+    group->int_term = calc->int_term;
+    group->pow_base = calc->pow_base;
+    group->pow_int = calc->pow_int;
+    group->pow_exact = calc->pow_exact;
+    group->pow_op = calc->pow_op;
+    group->input_start = strlen(calc->expression);
     
-    // Create working copies for calculation
-    float values[MAX_OPERANDS];
-    Operator ops[MAX_OPERATORS];
-    int value_count = calc->operand_count;
-    int op_count = calc->operator_count;
+    calc->acc_sum = Number_Zero();
+    calc->acc_term = Number_Zero();
+    calc->acc_add_op = OP_ADD;
+    calc->pending_op = OP_NONE;
+    calc->exact = 1;
+    calc->int_sum = 0;
+    calc->int_term = 0;
+}
+
+// Restore the running evaluation of the enclosing expression
+static void Calculator_PopGroup(Calculator* calc) {
+    const CalcGroup* group = &calc->groups[--calc->group_depth];
     
-    for(int i = 0; i < value_count; i++) {
-        values[i] = calc->operands[i];
+    calc->acc_sum = group->acc_sum;
+    calc->acc_term = group->acc_term;
+    calc->acc_add_op = group->acc_add_op;
+    calc->pending_op = group->pending_op;
+    calc->exact = group->exact;
+    calc->int_sum = group->int_sum;
+    calc->int_term = group->int_term;
+    calc->pow_base = group->pow_base;
+    calc->pow_int = group->pow_int;
+    calc->pow_exact = group->pow_exact;
+    calc->pow_op = group->pow_op;
+}
+
+// Finish the innermost group: its value becomes the pending operand of the
+// enclosing expression, to be folded in with the operator saved by "("
+static void Calculator_EndGroup(Calculator* calc) {
+    calc->current_number = Calculator_Finish(calc);
+    if(calc->state == STATE_ERROR) {
+        return;
     }
-    for(int i = 0; i < op_count; i++) {
-        ops[i] = calc->operators[i];
+    Calculator_PopGroup(calc);
+    Calculator_TapeCloseGroup(calc);
+    calc->state = STATE_GROUP_CLOSED;
+}
+
+// Open parenthesis
+void Calculator_OpenGroup(Calculator* calc) {
+    // The bignum running value lives in the arena and has no group stack
+    if(!Calculator_Scientific(calc) || calc->state == STATE_ERROR) {
+        return;
+    }
+    if(calc->state == STATE_SHOW_RESULT) {
+        Calculator_Clear(calc);
     }
     
-    // First pass: Handle *, /, and E (higher precedence)
-    int i = 0;
-    while(i < op_count) {
-        if(ops[i] == OP_MULTIPLY || ops[i] == OP_DIVIDE || ops[i] == OP_POWER10) {
-            float result;
-            
-            if(ops[i] == OP_MULTIPLY) {
-                result = values[i] * values[i + 1];
-            } else if(ops[i] == OP_DIVIDE) {
-                if(values[i + 1] == 0.0f) {
-                    Calculator_SetError(calc, "Div by 0");
-                    return 0.0f;
-                }
-                result = values[i] / values[i + 1];
-            } else { // OP_POWER10
-                // Calculate values[i]  10^values[i+1]
-                float power = 1.0f;
-                int exponent = (int)values[i + 1];
-                if(exponent >= 0) {
-                    for(int j = 0; j < exponent; j++) {
-                        power *= 10.0f;
-                    }
-                } else {
-                    for(int j = 0; j < -exponent; j++) {
-                        power /= 10.0f;
-                    }
-                }
-                result = values[i] * power;
-            }
-            
-            // Replace two operands with result
-            values[i] = result;
-            
-            // Shift remaining values left
-            for(int j = i + 1; j < value_count - 1; j++) {
-                values[j] = values[j + 1];
-            }
-            value_count--;
-            
-            // Shift remaining operators left
-            for(int j = i; j < op_count - 1; j++) {
-                ops[j] = ops[j + 1];
-            }
-            op_count--;
-            
-            // Don't increment i, check same position again
-        } else {
-            i++;
+    // "2(" and ")(" multiply
+    if((calc->state == STATE_ENTERING_NUMBER && calc->input_pos > 0) ||
+       calc->state == STATE_GROUP_CLOSED) {
+        Calculator_EnterOperator(calc, OP_MULTIPLY);
+        if(calc->state != STATE_ENTERING_OPERATOR) {
+            return;
         }
     }
     
-    // Second pass: Handle + and - (lower precedence)
-    i = 0;
-    while(i < op_count) {
-        float result;
-        
-        if(ops[i] == OP_ADD) {
-            result = values[i] + values[i + 1];
-        } else { // OP_SUBTRACT
-            result = values[i] - values[i + 1];
-        }
-        
-        // Replace two operands with result
-        values[i] = result;
-        
-        // Shift remaining values left
-        for(int j = i + 1; j < value_count - 1; j++) {
-            values[j] = values[j + 1];
-        }
-        value_count--;
-        
-        // Shift remaining operators left
-        for(int j = i; j < op_count - 1; j++) {
-            ops[j] = ops[j + 1];
-        }
-        op_count--;
-        
-        // Don't increment i, check same position again
+    if(calc->group_depth >= MAX_PAREN_DEPTH) {
+        Calculator_SetError(calc, "Too many (");
+        return;
     }
     
-    return values[0];
+    // At the start of a calculation "(" replaces the "0" placeholder
+    if(calc->state == STATE_ENTERING_NUMBER) {
+        calc->expression[calc->input_start] = '\0';
+    }
+    
+    Calculator_TapeOpenGroup(calc);
+    Calculator_PushGroup(calc);
+    Calculator_AppendChar(calc, '(');
+    calc->state = STATE_ENTERING_OPERATOR;
 }
 
-// Calculate and display result
-void Calculator_Equals(Calculator* calc) {
-    if(calc->state == STATE_ERROR) {
+// Close parenthesis (needs an open group and an operand to end it with)
+void Calculator_CloseGroup(Calculator* calc) {
+    if(!Calculator_Scientific(calc) || calc->group_depth == 0 ||
+       (calc->state != STATE_ENTERING_NUMBER && calc->state != STATE_GROUP_CLOSED)) {
         return;
     }
     
-    float result = Calculator_Calculate(calc);
+    // The group's text, from its "(", is the operand a function applies to
+    int start = calc->groups[calc->group_depth - 1].input_start;
     
-    if(calc->state != STATE_ERROR) {
-        // Clear for new calculation but keep result
-        calc->current_number = result;
-        calc->operand_count = 0;
-        calc->operator_count = 0;
-        calc->has_decimal = 0;
-        calc->decimal_places = 0;
-        calc->input_buffer[0] = '\0';
-        calc->input_pos = 0;
-        
-        // Format result for display
-        Calculator_FormatNumber(calc->expression, result, MAX_EXPRESSION_LENGTH);
-        
-        calc->state = STATE_SHOW_RESULT;
+    Calculator_CommitOperand(calc);
+    if(calc->state == STATE_ERROR) {
+        return;
     }
+    Calculator_EndGroup(calc);
+    Calculator_AppendChar(calc, ')');
+    calc->input_start = start;
 }
 
-// Clear calculator
-void Calculator_Clear(Calculator* calc) {
-    Calculator_Init(calc);
-}
-
-// Update LCD display
-void Calculator_DisplayUpdate(Calculator* calc) {
-    LCD_Cmd(LCD_CLEAR);
+// Enter the variable X (in the modes with an X, while the equation is entered). It
+// stands in for an operand like a closed group: the tape gets an
+// OP_VARIABLE token for the solver, and the running value uses the last X.
+void Calculator_EnterVariable(Calculator* calc) {
+    if(!Calculator_HasVariable(calc) || calc->solve_guess) {
+        return;
+    }
     
-    if(calc->state == STATE_ERROR) {
-        LCD_String("Error:");
-        LCD_Cmd(LCD_LINE2);
-        LCD_String(calc->error_msg);
-    } else {
-        // Line 1: Shift indicator or Memory indicator
-        if(calc->shift_active) {
-            LCD_String("SHIFT");
-        } else if(calc->memory != 0.0f) {
-            LCD_String("M:");
-            char mem_buf[12];
-            Calculator_FormatNumber(mem_buf, calc->memory, 12);
-            LCD_String(mem_buf);
+    // "2X" and ")X" multiply
+    if((calc->state == STATE_ENTERING_NUMBER && calc->input_pos > 0) ||
+       calc->state == STATE_GROUP_CLOSED) {
+        Calculator_EnterOperator(calc, OP_MULTIPLY);
+        if(calc->state != STATE_ENTERING_OPERATOR) {
+            return;
         }
-        
-        // Line 2: Expression
-        LCD_Cmd(LCD_LINE2);
-        LCD_String(calc->expression);
     }
-}
-
-// Memory Store (MS) - Store current result in memory
-void Calculator_MemoryStore(Calculator* calc) {
-    if(calc->state == STATE_SHOW_RESULT) {
-        calc->memory = calc->current_number;
-    } else if(calc->state == STATE_ENTERING_NUMBER) {
-        calc->memory = calc->current_number;
+    
+    // At the start of the equation "X" replaces the "0" placeholder
+    if(calc->state == STATE_ENTERING_NUMBER) {
+        calc->expression[calc->input_start] = '\0';
     }
+    
+    int start = strlen(calc->expression);
+    Calculator_TapeVariable(calc);
+    Calculator_AppendChar(calc, 'X');
+    calc->input_start = start;
+    calc->current_number = Number_FromFloat(calc->solve_x);
+    calc->int_result = 0;
+    calc->result_exact = 0;
+    calc->state = STATE_GROUP_CLOSED;
 }
 
-// Memory Recall (MR) - Recall memory value
-void Calculator_MemoryRecall(Calculator* calc) {
-    Calculator_Clear(calc);
-    calc->current_number = calc->memory;
-    Calculator_FormatNumber(calc->expression, calc->memory, MAX_EXPRESSION_LENGTH);
-    calc->state = STATE_SHOW_RESULT;
-}
-
-// Memory Clear (MC) - Clear memory
-void Calculator_MemoryClear(Calculator* calc) {
-    calc->memory = 0.0f;
-}
-
-// Memory Add (M+) - Add current value to memory
-void Calculator_MemoryAdd(Calculator* calc) {
-    if(calc->state == STATE_SHOW_RESULT) {
-        calc->memory += calc->current_number;
-    } else if(calc->state == STATE_ENTERING_NUMBER) {
-        calc->memory += calc->current_number;
+// Apply a single binary operator (used by the evaluator for each reduction)
+static CalcNumber Calculator_ApplyOperator(Calculator* calc, CalcNumber a, Operator op, CalcNumber b) {
+    switch(op) {
+        case OP_ADD:
+            return Number_Add(a, b);
+        case OP_SUBTRACT:
+            return Number_Subtract(a, b);
+        case OP_MULTIPLY:
+            return Number_Multiply(a, b);
+        case OP_DIVIDE:
+            if(Number_IsZero(b)) {
+                Calculator_SetError(calc, "Div by 0");
+                return Number_Zero();
+            }
+            return Number_Divide(a, b);
+        case OP_POWER10: {
+            // a  10^b; the exponent is clamped to the display range, the
+            // backend reports anything that still overflows or underflows
+            float exponent = Number_ToFloat(b);
+            if(exponent > 99.0f) exponent = 99.0f;
+            if(exponent < -99.0f) exponent = -99.0f;
+            return Number_Scale10(a, (int)exponent);
+        }
+        case OP_POWER:
+            return Number_Power(a, b);
+        case OP_PATH_LOSS:
+            return Number_PathLoss(a, b);
+        default:
+            return b;
     }
 }
 
-// Memory Subtract (M-) - Subtract current value from memory
-void Calculator_MemorySubtract(Calculator* calc) {
-    if(calc->state == STATE_SHOW_RESULT) {
-        calc->memory -= calc->current_number;
-    } else if(calc->state == STATE_ENTERING_NUMBER) {
-        calc->memory -= calc->current_number;
+// Apply a function of one argument; domain and range errors come back as
+// exception flags
+static CalcNumber Calculator_EvalFunction(Operator fn, CalcNumber a) {
+    switch(fn) {
+        case OP_SQRT:  return Number_Sqrt(a);
+        case OP_SIN:   return Number_Sin(a);
+        case OP_COS:   return Number_Cos(a);
+        case OP_TAN:   return Number_Tan(a);
+        case OP_LN:    return Number_Ln(a);
+        case OP_LOG10: return Number_Log10(a);
+        case OP_EXP:   return Number_Exp(a);
+        case OP_DBM_TO_MW:
+        case OP_DB_TO_RATIO:
+            return Number_FromDb(a);
+        case OP_MW_TO_DBM:
+        case OP_RATIO_TO_DB:
+            return Number_ToDb(a);
+        case OP_WAVELENGTH:
+            return Number_Wavelength(a);
+        default:       return a;
     }
 }
 
-// Helper: Get operator precedence
-int Calculator_GetOperatorPrecedence(Operator op) {
+// Apply a single binary operator to integers. Returns 0, leaving *result
+// untouched, if the exact result does not fit a long long or is not an
+// integer (a  that leaves a remainder, E with a negative exponent that
+// does not divide out); the caller then redoes the step as a CalcNumber.
+static int Calculator_IntApply(long long a, Operator op, long long b, long long* result) {
     switch(op) {
-        case OP_MULTIPLY:
-        case OP_DIVIDE:
-        case OP_POWER10:
-            return 2;
         case OP_ADD:
+            if((b > 0 && a > LLONG_MAX - b) || (b < 0 && a < LLONG_MIN - b)) {
+                return 0;
+            }
+            *result = a + b;
+            return 1;
         case OP_SUBTRACT:
+            if((b < 0 && a > LLONG_MAX + b) || (b > 0 && a < LLONG_MIN + b)) {
+                return 0;
+            }
+            *result = a - b;
             return 1;
-        default:
+        case OP_MULTIPLY: {
+            // Both within 32 bits (the usual case): the product always fits
+            if(a >= -INT_MAX && a <= INT_MAX && b >= -INT_MAX && b <= INT_MAX) {
+                *result = a * b;
+                return 1;
+            }
+            if(a == LLONG_MIN || b == LLONG_MIN) {
+                return 0;
+            }
+            long long abs_a = (a < 0) ? -a : a;
+            long long abs_b = (b < 0) ? -b : b;
+            if(abs_b != 0 && abs_a > LLONG_MAX / abs_b) {
+                return 0;
+            }
+            *result = a * b;
+            return 1;
+        }
+        case OP_DIVIDE:
+            // Division by zero is reported by the CalcNumber path
+            if(b == 0 || (a == LLONG_MIN && b == -1) || a % b != 0) {
+                return 0;
+            }
+            *result = a / b;
+            return 1;
+        case OP_POWER10:
+            if(b >= 0 && b <= 18) {
+                return Calculator_IntApply(a, OP_MULTIPLY, int_pow10[b], result);
+            }
+            if(b < 0 && b >= -18) {
+                return Calculator_IntApply(a, OP_DIVIDE, int_pow10[-b], result);
+            }
+            return 0;
+        case OP_POWER: {
+            // Square-and-multiply; a negative exponent gives a fraction
+            long long power = 1;
+            if(b < 0) {
+                return 0;
+            }
+            for(;;) {
+                if((b & 1) && !Calculator_IntApply(power, OP_MULTIPLY, a, &power)) {
+                    return 0;
+                }
+                b >>= 1;
+                if(b == 0) {
+                    break;
+                }
+                if(!Calculator_IntApply(a, OP_MULTIPLY, a, &a)) {
+                    return 0;
+                }
+            }
+            *result = power;
+            return 1;
+        }
+        case OP_PATH_LOSS:
             return 0;
+        default:
+            *result = b;
+            return 1;
     }
 }
 
-// Helper: Convert operator to character
-char Calculator_OperatorToChar(Operator op) {
-    switch(op) {
-        case OP_ADD:      return '+';
-        case OP_SUBTRACT: return '-';
-        case OP_MULTIPLY: return '*';
-        case OP_DIVIDE:   return '/';
-        case OP_POWER10:  return 'E';
-        default:          return ' ';
+// Fold an integer operand into an integer running value, exactly as
+// Calculator_CommitOperand does for CalcNumbers. Returns 0, with nothing
+// modified, if any step falls off the integer path.
+static int Calculator_IntFold(long long* sum, Operator* add_op, long long* term,
+                              Operator op, long long value) {
+    if(op == OP_NONE) {
+        *term = value;
+    } else if(Calculator_GetOperatorPrecedence(op) == 2) {
+        return Calculator_IntApply(*term, op, value, term);
+    } else {
+        long long new_sum;
+        if(!Calculator_IntApply(*sum, *add_op, *term, &new_sum)) {
+            return 0;
+        }
+        *sum = new_sum;
+        *add_op = op;
+        *term = value;
     }
+    return 1;
 }
 
-// Helper: Map key to operator (with shift support)
-Operator Calculator_KeyToOperator(char key, int shifted) {
-    if(shifted) {
-        switch(key) {
-            case 'A': return OP_MULTIPLY;
-            case 'B': return OP_DIVIDE;
-            case 'C': return OP_POWER10;
-            default:  return OP_NONE;
-        }
+// Fold a CalcNumber operand into a running value (sum, add_op, term) with
+// the operator that precedes it: ,  and E extend the term, + and - fold
+// the finished term into the sum and start a new one
+static void Calculator_Fold(Calculator* calc, CalcNumber* sum, Operator* add_op,
+                            CalcNumber* term, Operator op, CalcNumber value) {
+    if(op == OP_NONE) {
+        // First operand of the expression
+        *term = value;
+    } else if(Calculator_GetOperatorPrecedence(op) == 2) {
+        *term = Calculator_ApplyOperator(calc, *term, op, value);
     } else {
-        switch(key) {
-            case 'A': return OP_ADD;
-            case 'B': return OP_SUBTRACT;
-            default:  return OP_NONE;
+        *sum = Calculator_ApplyOperator(calc, *sum, *add_op, *term);
+        *add_op = op;
+        *term = value;
+    }
+}
+
+// Move the running value off the integer path; from here on the expression
+// is evaluated with CalcNumbers
+static void Calculator_LeaveExact(Calculator* calc) {
+    if(calc->exact) {
+        calc->acc_sum = Number_FromInt64(calc->int_sum);
+        calc->acc_term = Number_FromInt64(calc->int_term);
+        calc->exact = 0;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Expression tape
+// ---------------------------------------------------------------------------
+// The expression is compiled to postfix while it is typed (shunting-yard):
+// an operator becomes final when its right-hand operand is committed, so
+// changing the last operator before then costs nothing. Equals flushes the
+// operator stack and the tape is kept, to be replayed with another first
+// operand. Each token is emitted once, so compiling is O(n) overall.
+
+static void Calculator_TapeEmit(Calculator* calc, const CalcTapeEntry* entry) {
+    if(calc->tape_length < MAX_TAPE_LENGTH) {
+        calc->tape[calc->tape_length++] = *entry;
+    }
+}
+
+static void Calculator_TapeEmitOperator(Calculator* calc, Operator op) {
+    CalcTapeEntry entry;
+    entry.op = op;
+    entry.exact = 0;
+    entry.int_value = 0;
+    entry.value = Number_Zero();
+    Calculator_TapeEmit(calc, &entry);
+}
+
+// The first token of a new expression replaces the stored tape
+static void Calculator_TapeStart(Calculator* calc) {
+    if(!calc->tape_building) {
+        calc->tape_length = 0;
+        calc->tape_op_top = 0;
+        calc->tape_building = 1;
+    }
+}
+
+// Emit stacked operators of equal or higher precedence (back to the
+// innermost "("), then stack op
+static void Calculator_TapeOperator(Calculator* calc, Operator op) {
+    int prec = Calculator_GetOperatorPrecedence(op);
+    while(calc->tape_op_top > 0 && calc->tape_ops[calc->tape_op_top - 1] != OP_LPAREN &&
+          Calculator_GetOperatorPrecedence(calc->tape_ops[calc->tape_op_top - 1]) >= prec) {
+        Calculator_TapeEmitOperator(calc, calc->tape_ops[--calc->tape_op_top]);
+    }
+    calc->tape_ops[calc->tape_op_top++] = op;
+}
+
+// An operand, preceded by the operator it is the right-hand side of
+static void Calculator_TapeOperand(Calculator* calc, CalcNumber value,
+                                   int exact, long long int_value) {
+    CalcTapeEntry entry;
+    
+    Calculator_TapeStart(calc);
+    if(calc->pending_op != OP_NONE) {
+        Calculator_TapeOperator(calc, calc->pending_op);
+    }
+    entry.op = OP_NONE;
+    entry.exact = exact;
+    entry.int_value = int_value;
+    entry.value = value;
+    Calculator_TapeEmit(calc, &entry);
+}
+
+// Solve mode's X, preceded by the operator it is the right-hand side of
+static void Calculator_TapeVariable(Calculator* calc) {
+    Calculator_TapeStart(calc);
+    if(calc->pending_op != OP_NONE) {
+        Calculator_TapeOperator(calc, calc->pending_op);
+    }
+    Calculator_TapeEmitOperator(calc, OP_VARIABLE);
+}
+
+// "(": the pending operator applies to the whole group
+static void Calculator_TapeOpenGroup(Calculator* calc) {
+    Calculator_TapeStart(calc);
+    if(calc->pending_op != OP_NONE) {
+        Calculator_TapeOperator(calc, calc->pending_op);
+    }
+    calc->tape_ops[calc->tape_op_top++] = OP_LPAREN;
+}
+
+// ")": emit the group's operators and drop its "("
+static void Calculator_TapeCloseGroup(Calculator* calc) {
+    while(calc->tape_op_top > 0 && calc->tape_ops[calc->tape_op_top - 1] != OP_LPAREN) {
+        Calculator_TapeEmitOperator(calc, calc->tape_ops[--calc->tape_op_top]);
+    }
+    if(calc->tape_op_top > 0) {
+        calc->tape_op_top--;
+    }
+}
+
+// Equals: emit everything left; the tape is complete
+static void Calculator_TapeFinish(Calculator* calc) {
+    while(calc->tape_op_top > 0) {
+        Operator op = calc->tape_ops[--calc->tape_op_top];
+        if(op != OP_LPAREN) {
+            Calculator_TapeEmitOperator(calc, op);
         }
     }
+    calc->tape_building = 0;
 }
 
-// Helper: Set error state
-void Calculator_SetError(Calculator* calc, const char* msg) {
-    calc->state = STATE_ERROR;
+// Evaluate the tape with first as its first operand. Like the running
+// evaluation, integers are used while every operand is a whole number and
+// every step is exact (and no function is applied); otherwise the tape is
+// run again on CalcNumbers.
+// Sets int_result/result_exact.
+static CalcNumber Calculator_RunTape(Calculator* calc, const CalcTapeEntry* first) {
+    long long* ints = calc->tape_ints;
+    CalcNumber* values = calc->tape_values;
+    int top = 0;
     int i;
-    for(i = 0; msg[i] != '\0' && i < 19; i++) {
-        calc->error_msg[i] = msg[i];
+    
+    if(first->exact) {
+        for(i = 0; i < calc->tape_length; i++) {
+            const CalcTapeEntry* entry = (i == 0) ? first : &calc->tape[i];
+            if(entry->op == OP_NONE) {
+                if(!entry->exact) {
+                    break;
+                }
+                ints[top++] = entry->int_value;
+            } else if(Calculator_IsFunction(entry->op)) {
+                break;
+            } else {
+                top--;
+                if(!Calculator_IntApply(ints[top - 1], entry->op, ints[top], &ints[top - 1])) {
+                    break;
+                }
+            }
+        }
+        if(i == calc->tape_length) {
+            calc->int_result = ints[0];
+            calc->result_exact = 1;
+            return Number_FromInt64(ints[0]);
+        }
     }
-    calc->error_msg[i] = '\0';
+    calc->result_exact = 0;
+    
+    top = 0;
+    Number_ClearExceptions();
+    for(i = 0; i < calc->tape_length; i++) {
+        const CalcTapeEntry* entry = (i == 0) ? first : &calc->tape[i];
+        if(entry->op == OP_NONE) {
+            values[top++] = entry->value;
+        } else if(Calculator_IsFunction(entry->op)) {
+            values[top - 1] = Calculator_EvalFunction(entry->op, values[top - 1]);
+        } else {
+            top--;
+            values[top - 1] = Calculator_ApplyOperator(calc, values[top - 1], entry->op, values[top]);
+            if(calc->state == STATE_ERROR) {
+                return Number_Zero();
+            }
+        }
+    }
+    Calculator_CheckExceptions(calc);
+    
+    return values[0];
 }
 
-// Helper: Format number for display
-void Calculator_FormatNumber(char* buffer, float number, int buffer_size) {
-    // Handle special cases
-    if(number == 0.0f) {
-        buffer[0] = '0';
-        buffer[1] = '\0';
+// Take the operand waiting to be committed: emit it to the tape and
+// remember "op operand" for repeated equals. Returns 1 if *int_value
+// holds it exactly.
+static int Calculator_TakeOperand(Calculator* calc, CalcNumber* value, long long* int_value) {
+    int is_integer = Calculator_CurrentInteger(calc, int_value);
+    
+    *value = Calculator_CurrentValue(calc);
+    // A closed group is already on the tape as its own tokens
+    if(calc->state != STATE_GROUP_CLOSED) {
+        Calculator_TapeOperand(calc, *value, is_integer, *int_value);
+    }
+    if(calc->pending_op != OP_NONE) {
+        calc->repeat.op = calc->pending_op;
+        calc->repeat.exact = is_integer;
+        calc->repeat.int_value = *int_value;
+        calc->repeat.value = *value;
+    }
+    return is_integer;
+}
+
+// Raise the stashed base to the operand (the exponent) and restore the
+// operator that came before the base. Returns 1 if *int_value holds the
+// result exactly.
+static int Calculator_ResolvePower(Calculator* calc, CalcNumber* value,
+                                   int is_integer, long long* int_value) {
+    calc->pending_op = calc->pow_op;
+    if(calc->pow_exact && is_integer &&
+       Calculator_IntApply(calc->pow_int, OP_POWER, *int_value, int_value)) {
+        *value = Number_FromInt64(*int_value);
+        return 1;
+    }
+    Number_ClearExceptions();
+    *value = Number_Power(calc->pow_base, *value);
+    Calculator_CheckExceptions(calc);
+    return 0;
+}
+
+// Fold an operand into the running value with the pending operator: , 
+// and E extend the current term, while + and - first fold the finished
+// term into the sum. While every operand is a whole number the fold is
+// done in integers.
+static void Calculator_FoldOperand(Calculator* calc, CalcNumber value,
+                                   int is_integer, long long int_value) {
+    if(calc->exact && is_integer) {
+        long long sum = calc->int_sum;
+        long long term = calc->int_term;
+        Operator add_op = calc->acc_add_op;
+        if(Calculator_IntFold(&sum, &add_op, &term, calc->pending_op, int_value)) {
+            calc->int_sum = sum;
+            calc->int_term = term;
+            calc->acc_add_op = add_op;
+            calc->pending_op = OP_NONE;
+            return;
+        }
+    }
+    Calculator_LeaveExact(calc);
+    
+    Number_ClearExceptions();
+    Calculator_Fold(calc, &calc->acc_sum, &calc->acc_add_op, &calc->acc_term,
+                    calc->pending_op, value);
+    calc->pending_op = OP_NONE;
+    Calculator_CheckExceptions(calc);
+}
+
+// Commit an operand to the token stream and fold it into the running value,
+// after raising a pending ^ base to it. O(1) per operand, so equals only has
+// to combine acc_sum and acc_term.
+static void Calculator_CommitOperand(Calculator* calc) {
+    CalcNumber value;
+    long long int_value;
+    int is_integer = Calculator_TakeOperand(calc, &value, &int_value);
+    
+    if(calc->pending_op == OP_POWER) {
+        is_integer = Calculator_ResolvePower(calc, &value, is_integer, &int_value);
+        if(calc->state == STATE_ERROR) {
+            return;
+        }
+    }
+    Calculator_FoldOperand(calc, value, is_integer, int_value);
+}
+
+// "^": set the operand aside as the base instead of folding it in. In
+// "2^3^2" the first power is resolved here, so ^ is left-associative.
+static void Calculator_StashPower(Calculator* calc) {
+    CalcNumber value;
+    long long int_value;
+    int is_integer = Calculator_TakeOperand(calc, &value, &int_value);
+    
+    if(calc->pending_op == OP_POWER) {
+        is_integer = Calculator_ResolvePower(calc, &value, is_integer, &int_value);
+        if(calc->state == STATE_ERROR) {
+            return;
+        }
+    }
+    calc->pow_base = value;
+    calc->pow_int = int_value;
+    calc->pow_exact = is_integer;
+    calc->pow_op = calc->pending_op;
+    calc->pending_op = OP_POWER;
+}
+
+// Name shown in the expression for a function, e.g. "sin" in "sin(2)"
+static const char* Calculator_FunctionName(Operator fn) {
+    switch(fn) {
+        case OP_SQRT:  return "sqrt";
+        case OP_SIN:   return "sin";
+        case OP_COS:   return "cos";
+        case OP_TAN:   return "tan";
+        case OP_LN:    return "ln";
+        case OP_LOG10: return "log";
+        case OP_EXP:   return "exp";
+        case OP_DBM_TO_MW:   return "mW";
+        case OP_MW_TO_DBM:   return "dBm";
+        case OP_DB_TO_RATIO: return "x";
+        case OP_RATIO_TO_DB: return "dB";
+        case OP_WAVELENGTH:  return "c/";
+        default:       return "";
+    }
+}
+
+// Wrap the operand's text (from input_start) in "name(...)"; a group
+// already has its parentheses and only gets the name
+static void Calculator_WrapOperand(Calculator* calc, const char* name) {
+    char operand[MAX_EXPRESSION_LENGTH];
+    int start = calc->input_start;
+    int room = MAX_EXPRESSION_LENGTH - start - 1;
+    int group = (calc->expression[start] == '(');
+    
+    strcpy(operand, calc->expression + start);
+    calc->expression[start] = '\0';
+    strncat(calc->expression, name, room);
+    if(!group) {
+        strncat(calc->expression, "(", room - strlen(calc->expression + start));
+    }
+    strncat(calc->expression, operand, room - strlen(calc->expression + start));
+    if(!group) {
+        strncat(calc->expression, ")", room - strlen(calc->expression + start));
+    }
+}
+
+// Apply a function to the current operand: the number being typed, the
+// group ")" has just closed, or the result on display. The value is worked
+// out at once and stands in for the operand, like a closed group; the
+// function goes on the tape after its argument, so replay sees it too.
+void Calculator_ApplyFunction(Calculator* calc, Operator fn) {
+    if(!Calculator_Scientific(calc) || !Calculator_IsFunction(fn)) {
         return;
     }
     
-    // Convert float to string with appropriate precision
-    int int_part = (int)number;
-    float frac_part = number - int_part;
+    if(calc->state == STATE_SHOW_RESULT) {
+        // A function of a result is a new result; the stored tape is kept
+        Number_ClearExceptions();
+        CalcNumber result = Calculator_EvalFunction(fn, calc->current_number);
+        calc->result_exact = 0;
+        Calculator_CheckExceptions(calc);
+        Calculator_ShowResult(calc, result);
+        return;
+    }
     
-    if(frac_part < 0) frac_part = -frac_part;
+    if(calc->state != STATE_ENTERING_NUMBER && calc->state != STATE_GROUP_CLOSED) {
+        return;
+    }
+    if(calc->function_count >= MAX_FUNCTIONS) {
+        Calculator_SetError(calc, "Too long");
+        return;
+    }
+    if(calc->state == STATE_ENTERING_NUMBER) {
+        // The typed number goes on the tape as the argument
+        long long int_value;
+        int is_integer = Calculator_CurrentInteger(calc, &int_value);
+        calc->current_number = Calculator_InputValue(calc);
+        Calculator_TapeOperand(calc, calc->current_number, is_integer, int_value);
+    }
+    Calculator_TapeEmitOperator(calc, fn);
+    calc->function_count++;
     
-    // Handle negative numbers
-    int pos = 0;
-    if(number < 0 && int_part == 0) {
-        buffer[pos++] = '-';
-        int_part = -int_part;
+    Number_ClearExceptions();
+    calc->current_number = Calculator_EvalFunction(fn, calc->current_number);
+    calc->int_result = 0;
+    calc->result_exact = 0;
+    Calculator_CheckExceptions(calc);
+    if(calc->state == STATE_ERROR) {
+        return;
     }
     
-    // Convert integer part
-    if(int_part == 0) {
-        buffer[pos++] = '0';
-    } else {
-        char temp[16];
-        int temp_pos = 0;
-        int num = int_part;
-        if(num < 0) num = -num;
-        
-        while(num > 0 && temp_pos < 15) {
-            temp[temp_pos++] = '0' + (num % 10);
-            num /= 10;
+    Calculator_WrapOperand(calc, Calculator_FunctionName(fn));
+    calc->state = STATE_GROUP_CLOSED;
+}
+
+// 1 if an operand is waiting to be committed: a number being typed, or the
+// value of a group that ")" has just closed
+static int Calculator_OperandPending(Calculator* calc) {
+    return calc->state == STATE_ENTERING_NUMBER || calc->state == STATE_GROUP_CLOSED;
+}
+
+// 1 if a live partial result can be shown: an expression is being entered
+// and does not end in a "(" that has no operand yet
+static int Calculator_CanPreview(Calculator* calc) {
+    if(!Calculator_Everyday(calc) ||
+       (calc->operator_count == 0 && calc->function_count == 0 && calc->group_depth == 0)) {
+        return 0;
+    }
+    if(calc->state == STATE_ENTERING_OPERATOR) {
+        return !Calculator_GroupEmpty(calc);
+    }
+    return Calculator_OperandPending(calc);
+}
+
+// Value of the expression so far, as if equals were pressed now (open
+// groups are closed, innermost first).
+// Does not modify the calculator; returns 0 when there is nothing to preview
+// (no operator entered yet, a result is showing, or the next step would fail).
+// A step fails where equals would report an error: dividing by zero, or
+// any exception Calculator_CheckExceptions turns into one, so an "=Inf"
+// preview never stands in for "Overflow".
+int Calculator_Preview(Calculator* calc, CalcNumber* result) {
+    if(!Calculator_CanPreview(calc)) {
+        return 0;
+    }
+    
+    Number_ClearExceptions();
+    CalcNumber term = calc->exact ? Number_FromInt64(calc->int_term) : calc->acc_term;
+    CalcNumber sum = calc->exact ? Number_FromInt64(calc->int_sum) : calc->acc_sum;
+    Operator add_op = calc->acc_add_op;
+    Operator op = calc->pending_op;
+    CalcNumber value;
+    
+    if(Calculator_OperandPending(calc) || op == OP_POWER) {
+        if(!Calculator_OperandPending(calc)) {
+            // Trailing "^": the base is the last operand
+            value = calc->pow_base;
+            op = calc->pow_op;
+        } else {
+            value = Calculator_CurrentValue(calc);
+            if(op == OP_POWER) {
+                value = Number_Power(calc->pow_base, value);
+                op = calc->pow_op;
+            }
         }
-        
-        if(int_part < 0 && pos == 0) {
-            buffer[pos++] = '-';
+        if(op == OP_DIVIDE && Number_IsZero(value)) {
+            return 0;
         }
-        
-        // Reverse temp into buffer
-        for(int i = temp_pos - 1; i >= 0 && pos < buffer_size - 1; i--) {
-            buffer[pos++] = temp[i];
+        Calculator_Fold(calc, &sum, &add_op, &term, op, value);
+    }
+    value = Calculator_ApplyOperator(calc, sum, add_op, term);
+    
+    for(int depth = calc->group_depth - 1; depth >= 0; depth--) {
+        const CalcGroup* group = &calc->groups[depth];
+        term = group->exact ? Number_FromInt64(group->int_term) : group->acc_term;
+        sum = group->exact ? Number_FromInt64(group->int_sum) : group->acc_sum;
+        add_op = group->acc_add_op;
+        op = group->pending_op;
+        if(op == OP_POWER) {
+            value = Number_Power(group->pow_base, value);
+            op = group->pow_op;
         }
+        if(op == OP_DIVIDE && Number_IsZero(value)) {
+            return 0;
+        }
+        Calculator_Fold(calc, &sum, &add_op, &term, op, value);
+        value = Calculator_ApplyOperator(calc, sum, add_op, term);
     }
     
-    // Add decimal part if exists and space allows
-    if(frac_part > 0.0001f && pos < buffer_size - 3) {
-        buffer[pos++] = '.';
-        
-        // Add up to 4 decimal places
-        int decimal_digits = 0;
-        while(frac_part > 0.0001f && decimal_digits < 4 && pos < buffer_size - 1) {
-            frac_part *= 10;
-            int digit = (int)frac_part;
-            buffer[pos++] = '0' + digit;
-            frac_part -= digit;
-            decimal_digits++;
+    // Flags are sticky: one test covers every step above
+    if(Number_TestExceptions() != 0) {
+        return 0;
+    }
+    *result = value;
+    return 1;
+}
+
+// Calculator_Preview for the integer path: the exact value of the expression
+// so far. Returns 0 once any operand or step has left the integer path.
+int Calculator_PreviewExact(Calculator* calc, long long* result) {
+    if(!calc->exact || !Calculator_CanPreview(calc)) {
+        return 0;
+    }
+    
+    long long term = calc->int_term;
+    long long sum = calc->int_sum;
+    Operator add_op = calc->acc_add_op;
+    Operator op = calc->pending_op;
+    long long value;
+    
+    if(Calculator_OperandPending(calc)) {
+        if(!Calculator_CurrentInteger(calc, &value)) {
+            return 0;
+        }
+        if(op == OP_POWER) {
+            if(!calc->pow_exact || !Calculator_IntApply(calc->pow_int, OP_POWER, value, &value)) {
+                return 0;
+            }
+            op = calc->pow_op;
+        }
+        if(!Calculator_IntFold(&sum, &add_op, &term, op, value)) {
+            return 0;
+        }
+    } else if(op == OP_POWER) {
+        if(!calc->pow_exact || !Calculator_IntFold(&sum, &add_op, &term, calc->pow_op, calc->pow_int)) {
+            return 0;
         }
     }
+    if(!Calculator_IntApply(sum, add_op, term, &value)) {
+        return 0;
+    }
     
-    buffer[pos] = '\0';
-}
\ No newline at end of file
+    for(int depth = calc->group_depth - 1; depth >= 0; depth--) {
+        const CalcGroup* group = &calc->groups[depth];
+        term = group->int_term;
+        sum = group->int_sum;
+        add_op = group->acc_add_op;
+        op = group->pending_op;
+        if(!group->exact) {
+            return 0;
+        }
+        if(op == OP_POWER) {
+            if(!group->pow_exact || !Calculator_IntApply(group->pow_int, OP_POWER, value, &value)) {
+                return 0;
+            }
+            op = group->pow_op;
+        }
+        if(!Calculator_IntFold(&sum, &add_op, &term, op, value) ||
+           !Calculator_IntApply(sum, add_op, term, &value)) {
+            return 0;
+        }
+    }
+    
+    *result = value;
+    return 1;
+}
+
+// Value of the innermost expression: combine the running sum and term.
+// Sets int_result/result_exact when the integer path still holds it.
+static CalcNumber Calculator_Finish(Calculator* calc) {
+    // A trailing "^" leaves its base as the last operand
+    if(calc->pending_op == OP_POWER) {
+        calc->pending_op = calc->pow_op;
+        Calculator_FoldOperand(calc, calc->pow_base, calc->pow_exact, calc->pow_int);
+        if(calc->state == STATE_ERROR) {
+            return Number_Zero();
+        }
+    }
+    
+    // A trailing operator (e.g. "2+3+" then equals) has no right-hand operand
+    // and is ignored
+    if(calc->exact) {
+        long long result;
+        if(Calculator_IntApply(calc->int_sum, calc->acc_add_op, calc->int_term, &result)) {
+            calc->int_result = result;
+            calc->result_exact = 1;
+            return Number_FromInt64(result);
+        }
+        Calculator_LeaveExact(calc);
+    }
+    calc->result_exact = 0;
+    
+    Number_ClearExceptions();
+    CalcNumber result = Calculator_ApplyOperator(calc, calc->acc_sum, calc->acc_add_op, calc->acc_term);
+    Calculator_CheckExceptions(calc);
+    
+    return result;
+}
+
+// Calculate result with PEMDAS precedence
+// The running value is already reduced down to one sum and one pending term
+// per open group, so this is constant time however long the expression is
+// (plus one step per group left open, at most MAX_PAREN_DEPTH).
+CalcNumber Calculator_Calculate(Calculator* calc) {
+    // Add last number if we're entering one (or repeating equals on a result)
+    if(Calculator_OperandPending(calc) || calc->state == STATE_SHOW_RESULT) {
+        Calculator_CommitOperand(calc);
+    }
+    
+    // Close any groups left open, as if ")" had been pressed
+    while(calc->group_depth > 0 && calc->state != STATE_ERROR) {
+        if(Calculator_GroupEmpty(calc)) {
+            // An empty group is dropped, like a trailing operator
+            Calculator_PopGroup(calc);
+            calc->tape_op_top--;
+            if(calc->pending_op != OP_NONE) {
+                calc->tape_op_top--;
+            }
+        } else {
+            Calculator_EndGroup(calc);
+            if(calc->state != STATE_ERROR) {
+                Calculator_CommitOperand(calc);
+            }
+        }
+    }
+    
+    if(calc->state == STATE_ERROR) {
+        return Number_Zero();
+    }
+    
+    Calculator_TapeFinish(calc);
+    return Calculator_Finish(calc);
+}
+
+// Calculate and display result
+void Calculator_Equals(Calculator* calc) {
+    if(calc->state == STATE_ERROR) {
+        return;
+    }
+    if(calc->mode == MODE_BIGNUM) {
+        Calculator_BigEquals(calc);
+        return;
+    }
+    if(calc->mode == MODE_FRACTION) {
+        Calculator_FracEquals(calc);
+        return;
+    }
+    if(Calculator_HasVariable(calc)) {
+        Calculator_SolveEquals(calc);
+        return;
+    }
+    
+    CalcNumber result;
+    if(calc->state == STATE_SHOW_RESULT) {
+        // Constant mode: apply the last operator and operand again, O(1)
+        result = Calculator_Repeat(calc);
+    } else {
+        result = Calculator_Calculate(calc);
+    }
+    Calculator_ShowResult(calc, result);
+}
+
+// Repeated equals: result (op) operand, with the pair saved from the last
+// expression. Returns the result unchanged if that had no operator.
+static CalcNumber Calculator_Repeat(Calculator* calc) {
+    const CalcTapeEntry* repeat = &calc->repeat;
+    
+    if(repeat->op == OP_NONE) {
+        return calc->current_number;
+    }
+    if(calc->result_exact && repeat->exact &&
+       Calculator_IntApply(calc->int_result, repeat->op, repeat->int_value, &calc->int_result)) {
+        return Number_FromInt64(calc->int_result);
+    }
+    calc->result_exact = 0;
+    
+    Number_ClearExceptions();
+    CalcNumber result = Calculator_ApplyOperator(calc, calc->current_number, repeat->op, repeat->value);
+    Calculator_CheckExceptions(calc);
+    return result;
+}
+
+// Replay: evaluate the stored tape again with the number just typed (or the
+// result on display) as its first operand, e.g. "23+1=" then "5" replay
+// shows 16. Only valid before any operator of a new expression is entered.
+void Calculator_Replay(Calculator* calc) {
+    CalcTapeEntry first;
+    
+    if(!Calculator_Everyday(calc) || calc->tape_building || calc->tape_length == 0 ||
+       calc->operator_count != 0 || calc->group_depth != 0 ||
+       (calc->state != STATE_ENTERING_NUMBER && calc->state != STATE_SHOW_RESULT)) {
+        return;
+    }
+    
+    first.op = OP_NONE;
+    first.value = Calculator_CurrentValue(calc);
+    first.exact = Calculator_CurrentInteger(calc, &first.int_value);
+    Calculator_ShowResult(calc, Calculator_RunTape(calc, &first));
+}
+
+// Show a result and reset for the next calculation (the result is kept to
+// chain on from)
+static void Calculator_ShowResult(Calculator* calc, CalcNumber result) {
+    if(calc->state != STATE_ERROR) {
+        // Clear for new calculation but keep result
+        calc->current_number = result;
+        calc->operator_count = 0;
+        calc->function_count = 0;
+        calc->acc_sum = Number_Zero();
+        calc->acc_term = Number_Zero();
+        calc->acc_add_op = OP_ADD;
+        calc->pending_op = OP_NONE;
+        calc->exact = 1;
+        calc->int_sum = 0;
+        calc->int_term = 0;
+        calc->input_mantissa = 0;
+        calc->has_decimal = 0;
+        calc->decimal_places = 0;
+        calc->input_buffer[0] = '\0';
+        calc->input_pos = 0;
+        
+        // Format result for display (every digit of an integer result)
+        if(calc->result_exact) {
+            Calculator_FormatInteger(calc->expression, calc->int_result, MAX_EXPRESSION_LENGTH);
+        } else {
+            Calculator_FormatNumber(calc->expression, result, MAX_EXPRESSION_LENGTH);
+        }
+        calc->input_start = 0;
+        
+        calc->state = STATE_SHOW_RESULT;
+    }
+}
+
+// Clear calculator (the selected mode, the statistics samples and the last
+// completed expression, for replay and repeated equals, are kept)
+void Calculator_Clear(Calculator* calc) {
+    CalcMode mode = calc->mode;
+    int tape_length = calc->tape_building ? 0 : calc->tape_length;
+    CalcTapeEntry repeat = calc->repeat;
+    
+    Calculator_Reset(calc);
+    calc->mode = mode;
+    calc->tape_length = tape_length;
+    if(tape_length > 0) {
+        calc->repeat = repeat;
+    }
+}
+
+// Switch mode; the calculation in progress is cleared (a program being
+// recorded ends there, and the program store is kept)
+void Calculator_SetMode(Calculator* calc, CalcMode mode) {
+    if(calc->program_recording) {
+        Calculator_ProgramEnd(calc);
+    }
+    Calculator_Start(calc);
+    calc->mode = mode;
+}
+
+// Right-align "<prefix><n>" on LCD line 1 (e.g. "n=12"), if it fits after
+// the first used columns
+static void Calculator_ShowCount(const char* prefix, uint32_t n, int used) {
+    char count[16];
+    int pos = 0;
+    
+    while(prefix[pos] != '\0') {
+        count[pos] = prefix[pos];
+        pos++;
+    }
+    NumFormat_WriteDigits(count + pos, n, NumFormat_DigitCount(n));
+    pos += NumFormat_DigitCount(n);
+    count[pos] = '\0';
+    if(pos + used < LCD_COLUMNS) {
+        LCD_SetCursor(0, LCD_COLUMNS - pos);
+        LCD_String(count);
+    }
+}
+
+// Right-align a time on LCD line 1 in milliseconds, to 0.1 ms (e.g.
+// "12.5ms"), if it fits after the first used columns
+static void Calculator_ShowTime(unsigned long cycles, int used) {
+    char time[16];
+    uint32_t tenths = (uint32_t)(cycles / (CALC_CYCLES_PER_MS / 10));
+    int pos = NumFormat_DigitCount(tenths / 10);
+    
+    NumFormat_WriteDigits(time, tenths / 10, pos);
+    time[pos++] = '.';
+    time[pos++] = (char)('0' + tenths % 10);
+    time[pos++] = 'm';
+    time[pos++] = 's';
+    time[pos] = '\0';
+    if(pos + used < LCD_COLUMNS) {
+        LCD_SetCursor(0, LCD_COLUMNS - pos);
+        LCD_String(time);
+    }
+}
+
+// Update LCD display: the screen is redrawn from blank in the LCD's
+// shadow, and only the cells that changed are sent at the end
+void Calculator_DisplayUpdate(Calculator* calc) {
+    LCD_BeginFrame();
+    LCD_Cmd(LCD_CLEAR);
+    
+    if(calc->state == STATE_ERROR) {
+        LCD_String("Error:");
+        LCD_Cmd(LCD_LINE2);
+        LCD_String(calc->error_msg);
+    } else if(calc->mode_menu_active) {
+        LCD_String((char*)mode_menu_lines[calc->mode_menu_page][0]);
+        LCD_Cmd(LCD_LINE2);
+        LCD_String((char*)mode_menu_lines[calc->mode_menu_page][1]);
+    } else if(calc->fn_menu_active) {
+        LCD_String((char*)fn_menu_lines[calc->fn_menu_page][0]);
+        LCD_Cmd(LCD_LINE2);
+        LCD_String((char*)fn_menu_lines[calc->fn_menu_page][1]);
+    } else if(calc->mode == MODE_STATS) {
+        // Line 1: Shift indicator, or "STAT" / the result's name, and the count
+        const char* label = "STAT";
+        if(calc->state == STATE_SHOW_RESULT) {
+            label = stats_page_labels[calc->stats_page];
+        }
+        LCD_String(calc->shift_active ? "SHIFT" : (char*)label);
+        Calculator_ShowCount("n=", (uint32_t)calc->stats.count, strlen(label));
+        
+        // Line 2: Entry, or the result
+        LCD_Cmd(LCD_LINE2);
+        LCD_String(calc->expression);
+    } else if(calc->mode == MODE_SOLVE) {
+        // Line 1: Shift indicator, what is being entered, or how the solve
+        // went and the time it took
+        if(calc->shift_active) {
+            LCD_String("SHIFT");
+        } else if(!calc->solve_guess) {
+            LCD_String("SOLVE f(X)=0");
+        } else if(!calc->solve_shown) {
+            LCD_String("Guess X=");
+        } else {
+            char status[16];
+            int pos;
+            if(calc->solve_result.status == SOLVE_CONVERGED) {
+                uint32_t iterations = (uint32_t)calc->solve_result.iterations;
+                strcpy(status, "Root it=");
+                pos = strlen(status);
+                NumFormat_WriteDigits(status + pos, iterations, NumFormat_DigitCount(iterations));
+                pos += NumFormat_DigitCount(iterations);
+                status[pos] = '\0';
+            } else {
+                strcpy(status, "No conv");
+                pos = strlen(status);
+            }
+            LCD_String(status);
+            Calculator_ShowTime(calc->solve_cycles, pos);
+        }
+        
+        // Line 2: Equation, guess or X
+        LCD_Cmd(LCD_LINE2);
+        LCD_String(calc->expression);
+    } else if(calc->mode == MODE_INTEGRATE) {
+        // Line 1: Shift indicator, what is being entered, or the evaluations
+        // and time the integral took ("~" if it missed the tolerance)
+        if(calc->shift_active) {
+            LCD_String("SHIFT");
+        } else if(!calc->solve_guess) {
+            LCD_String("INTEGRATE f(X)");
+        } else if(!calc->solve_shown) {
+            LCD_String(calc->integrate_upper ? "To b=" : "From a=");
+        } else {
+            char count[16];
+            uint32_t evaluations = (uint32_t)calc->integrate_result.evaluations;
+            int pos = 0;
+            if(calc->integrate_result.status == INTEGRATE_INACCURATE) {
+                count[pos++] = '~';
+            }
+            count[pos++] = 'e';
+            count[pos++] = 'v';
+            count[pos++] = '=';
+            NumFormat_WriteDigits(count + pos, evaluations, NumFormat_DigitCount(evaluations));
+            pos += NumFormat_DigitCount(evaluations);
+            count[pos] = '\0';
+            LCD_String(count);
+            Calculator_ShowTime(calc->integrate_cycles, pos);
+        }
+        
+        // Line 2: Integrand, bound or integral
+        LCD_Cmd(LCD_LINE2);
+        LCD_String(calc->expression);
+    } else if(calc->mode == MODE_TABLE && calc->solve_shown) {
+        Calculator_TableDisplay(calc);
+    } else if(calc->mode == MODE_TABLE) {
+        // Line 1: Shift indicator, or what is being entered
+        if(calc->shift_active) {
+            LCD_String("SHIFT");
+        } else if(!calc->solve_guess) {
+            LCD_String("TABLE f(X)");
+        } else {
+            LCD_String(calc->table_step_entry ? "Step=" : "Start X=");
+        }
+        
+        // Line 2: Expression or number being entered
+        LCD_Cmd(LCD_LINE2);
+        LCD_String(calc->expression);
+    } else if(calc->mode == MODE_MATRIX) {
+        Calculator_MatrixDisplay(calc);
+    } else if(calc->mode == MODE_FRACTION) {
+        Calculator_FracDisplay(calc);
+    } else if(calc->mode == MODE_RPN) {
+        Calculator_RpnDisplay(calc);
+    } else if(calc->mode == MODE_BIGNUM) {
+        // Line 1: Shift indicator, or "BIG" with the result view position
+        if(calc->shift_active) {
+            LCD_String("SHIFT");
+        } else {
+            LCD_String("BIG");
+            if(calc->state == STATE_SHOW_RESULT) {
+                char position[16];
+                int length = BigNum_TextLength(&calc->big_arena, &calc->big_result);
+                int pos = NumFormat_DigitCount(calc->big_view + 1);
+                NumFormat_WriteDigits(position, calc->big_view + 1, pos);
+                position[pos++] = '/';
+                NumFormat_WriteDigits(position + pos, length, NumFormat_DigitCount(length));
+                pos += NumFormat_DigitCount(length);
+                position[pos] = '\0';
+                LCD_SetCursor(0, LCD_COLUMNS - pos);
+                LCD_String(position);
+            }
+        }
+        
+        // Line 2: Expression, or one screen of the result
+        LCD_Cmd(LCD_LINE2);
+        if(calc->state == STATE_SHOW_RESULT) {
+            for(int i = 0; i < LCD_COLUMNS; i++) {
+                LCD_Char(BigNum_CharAt(&calc->big_arena, &calc->big_result, calc->big_view + i));
+            }
+        } else {
+            LCD_String(calc->expression);
+        }
+    } else {
+        CalcNumber preview;
+        long long exact_preview;
+        int exact = Calculator_PreviewExact(calc, &exact_preview);
+        
+        // Line 1: Shift indicator, live result preview or Memory indicator
+        if(calc->shift_active) {
+            LCD_String("SHIFT");
+        } else if(exact || Calculator_Preview(calc, &preview)) {
+            // "M" flags a non-zero memory, preview is right-aligned as "=value"
+            char preview_buf[15];
+            if(exact) {
+                Calculator_FormatInteger(preview_buf, exact_preview, 15);
+            } else {
+                Calculator_FormatNumber(preview_buf, preview, 15);
+            }
+            if(!Number_IsZero(calc->memory)) {
+                LCD_String("M");
+            }
+            LCD_SetCursor(0, 15 - strlen(preview_buf));
+            LCD_Char('=');
+            LCD_String(preview_buf);
+        } else {
+            // "RF" marks RF mode (a preview takes the whole line)
+            if(calc->mode == MODE_RF) {
+                LCD_String("RF ");
+            }
+            if(!Number_IsZero(calc->memory)) {
+                LCD_String("M:");
+                char mem_buf[12];
+                Calculator_FormatNumber(mem_buf, calc->memory, 12);
+                LCD_String(mem_buf);
+            }
+        }
+        
+        // Line 2: Expression
+        LCD_Cmd(LCD_LINE2);
+        LCD_String(calc->expression);
+    }
+    LCD_EndFrame();
+}
+
+// Memory Store (MS) - Store current result in memory
+void Calculator_MemoryStore(Calculator* calc) {
+    if(calc->state == STATE_SHOW_RESULT || calc->state == STATE_ENTERING_NUMBER) {
+        calc->memory = Calculator_CurrentValue(calc);
+    }
+}
+
+// Memory Recall (MR) - Recall memory value
+void Calculator_MemoryRecall(Calculator* calc) {
+    Calculator_Clear(calc);
+    calc->current_number = calc->memory;
+    calc->result_exact = 0;
+    Calculator_FormatNumber(calc->expression, calc->memory, MAX_EXPRESSION_LENGTH);
+    calc->state = STATE_SHOW_RESULT;
+}
+
+// Memory Clear (MC) - Clear memory
+void Calculator_MemoryClear(Calculator* calc) {
+    calc->memory = Number_Zero();
+}
+
+// Memory Add (M+) - Add current value to memory
+void Calculator_MemoryAdd(Calculator* calc) {
+    if(calc->state == STATE_SHOW_RESULT || calc->state == STATE_ENTERING_NUMBER) {
+        calc->memory = Number_Add(calc->memory, Calculator_CurrentValue(calc));
+    }
+}
+
+// Memory Subtract (M-) - Subtract current value from memory
+void Calculator_MemorySubtract(Calculator* calc) {
+    if(calc->state == STATE_SHOW_RESULT || calc->state == STATE_ENTERING_NUMBER) {
+        calc->memory = Number_Subtract(calc->memory, Calculator_CurrentValue(calc));
+    }
+}
+
+// Helper: Get operator precedence
+int Calculator_GetOperatorPrecedence(Operator op) {
+    switch(op) {
+        case OP_POWER:
+            return 3;
+        case OP_MULTIPLY:
+        case OP_DIVIDE:
+        case OP_POWER10:
+        case OP_PATH_LOSS:
+            return 2;
+        case OP_ADD:
+        case OP_SUBTRACT:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// Helper: Convert operator to character
+char Calculator_OperatorToChar(Operator op) {
+    switch(op) {
+        case OP_ADD:      return '+';
+        case OP_SUBTRACT: return '-';
+        case OP_MULTIPLY: return '*';
+        case OP_DIVIDE:   return '/';
+        case OP_POWER10:  return 'E';
+        case OP_POWER:    return '^';
+        case OP_PATH_LOSS: return 'L';
+        default:          return ' ';
+    }
+}
+
+// Helper: 1 for a function of one argument (sqrt, sin, ..., the RF conversions)
+int Calculator_IsFunction(Operator op) {
+    return op >= OP_SQRT && op <= OP_WAVELENGTH;
+}
+
+// Helper: Map key to operator (with shift support)
+Operator Calculator_KeyToOperator(char key, int shifted) {
+    if(shifted) {
+        switch(key) {
+            case 'A': return OP_MULTIPLY;
+            case 'B': return OP_DIVIDE;
+            case 'C': return OP_POWER10;
+            case '0': return OP_POWER;
+            default:  return OP_NONE;
+        }
+    } else {
+        switch(key) {
+            case 'A': return OP_ADD;
+            case 'B': return OP_SUBTRACT;
+            default:  return OP_NONE;
+        }
+    }
+}
+
+// Helper: Set error state
+void Calculator_SetError(Calculator* calc, const char* msg) {
+    // While an equation in X is entered X has no value yet, so the running
+    // value is only a stand-in and its errors (e.g. "1/X") are not errors
+    if(Calculator_HasVariable(calc) && !calc->solve_guess) {
+        return;
+    }
+    calc->state = STATE_ERROR;
+    int i;
+    for(i = 0; msg[i] != '\0' && i < 19; i++) {
+        calc->error_msg[i] = msg[i];
+    }
+    calc->error_msg[i] = '\0';
+}
+
+// Helper: Format number for display
+void Calculator_FormatNumber(char* buffer, CalcNumber number, int buffer_size) {
+    Number_Format(buffer, number, buffer_size);
+}
+
+// Format an exact integer result: all of its digits when they fit the
+// display, otherwise the same d.dddEnn layout as a CalcNumber
+void Calculator_FormatInteger(char* buffer, long long number, int buffer_size) {
+    char digits[20];
+    int count = 0;
+    int negative = (number < 0);
+    unsigned long long magnitude = negative ? 0ULL - (unsigned long long)number
+                                            : (unsigned long long)number;
+    
+    if(magnitude == 0) {
+        buffer[0] = '0';
+        buffer[1] = '\0';
+        return;
+    }
+    
+    // Digits are produced least significant first, then reversed
+    while(magnitude != 0) {
+        digits[count++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    }
+    for(int i = 0; i < count / 2; i++) {
+        char swap = digits[i];
+        digits[i] = digits[count - 1 - i];
+        digits[count - 1 - i] = swap;
+    }
+    
+    int exponent = count - 1;
+    while(count > 1 && digits[count - 1] == '0') {
+        count--;
+    }
+    NumFormat_Layout(buffer, buffer_size, negative, digits, count, exponent);
+}
+
+// ---------------------------------------------------------------------------
+// Bignum mode
+// ---------------------------------------------------------------------------
+
+// Turn a bignum status into an error message; returns 1 on error
+static int Calculator_BigCheck(Calculator* calc, int status) {
+    if(status == BIGNUM_OK) {
+        return 0;
+    }
+    if(status == BIGNUM_NO_MEMORY) {
+        Calculator_SetError(calc, "Out of memory");
+    } else if(status == BIGNUM_DIV_ZERO) {
+        Calculator_SetError(calc, "Div by 0");
+    } else {
+        Calculator_SetError(calc, "Invalid result");
+    }
+    return 1;
+}
+
+// Bignum version of Calculator_ApplyOperator
+static int Calculator_BigApply(BigArena* arena, BigNum* result, const BigNum* a,
+                               Operator op, const BigNum* b) {
+    BigNum zero;
+    
+    switch(op) {
+        case OP_ADD:      return BigNum_Add(arena, result, a, b);
+        case OP_SUBTRACT: return BigNum_Subtract(arena, result, a, b);
+        case OP_MULTIPLY: return BigNum_Multiply(arena, result, a, b);
+        case OP_DIVIDE:   return BigNum_Divide(arena, result, a, b);
+        case OP_POWER10:  return BigNum_Scale10(arena, result, a, b);
+        default:
+            // Copy b (results never share limbs)
+            BigNum_Zero(&zero);
+            return BigNum_Add(arena, result, &zero, b);
+    }
+}
+
+// result = big_sum (acc_add_op) big_term. Adding a term to an empty sum
+// just takes the term over, so a long value is not copied in the arena.
+static int Calculator_BigFold(Calculator* calc, BigNum* result) {
+    if(BigNum_IsZero(&calc->big_sum) && calc->acc_add_op == OP_ADD) {
+        *result = calc->big_term;
+        BigNum_Zero(&calc->big_term);
+        return BIGNUM_OK;
+    }
+    return Calculator_BigApply(&calc->big_arena, result, &calc->big_sum,
+                               calc->acc_add_op, &calc->big_term);
+}
+
+// Bignum version of Calculator_CommitOperand: the operand is the typed
+// number (converted exactly) or the last result. Superseded values are
+// dropped by compacting the arena down to the sum, term and result.
+static void Calculator_BigCommitOperand(Calculator* calc) {
+    BigArena* arena = &calc->big_arena;
+    BigNum value;
+    BigNum result;
+    int status = BIGNUM_OK;
+    
+    if(calc->state == STATE_ENTERING_NUMBER) {
+        status = BigNum_FromInput(arena, &value, calc->input_mantissa, calc->decimal_places);
+    } else {
+        // Chain on from the last result (it is consumed, not copied)
+        value = calc->big_result;
+        BigNum_Zero(&calc->big_result);
+    }
+    
+    if(status == BIGNUM_OK) {
+        if(calc->pending_op == OP_NONE) {
+            calc->big_term = value;
+        } else if(Calculator_GetOperatorPrecedence(calc->pending_op) == 2) {
+            status = Calculator_BigApply(arena, &result, &calc->big_term, calc->pending_op, &value);
+            calc->big_term = result;
+        } else {
+            status = Calculator_BigFold(calc, &result);
+            calc->big_sum = result;
+            calc->acc_add_op = calc->pending_op;
+            calc->big_term = value;
+        }
+    }
+    calc->pending_op = OP_NONE;
+    
+    if(Calculator_BigCheck(calc, status)) {
+        return;
+    }
+    
+    BigNum* live[3] = { &calc->big_sum, &calc->big_term, &calc->big_result };
+    BigArena_Compact(arena, live, 3);
+}
+
+// Bignum version of Calculator_Equals
+static void Calculator_BigEquals(Calculator* calc) {
+    BigNum result;
+    
+    if(calc->state == STATE_ENTERING_NUMBER || calc->state == STATE_SHOW_RESULT) {
+        Calculator_BigCommitOperand(calc);
+        if(calc->state == STATE_ERROR) {
+            return;
+        }
+    }
+    
+    if(Calculator_BigCheck(calc, Calculator_BigFold(calc, &result))) {
+        return;
+    }
+    
+    // Keep only the result in the arena
+    calc->big_result = result;
+    BigNum_Zero(&calc->big_sum);
+    BigNum_Zero(&calc->big_term);
+    BigNum* live[1] = { &calc->big_result };
+    BigArena_Compact(&calc->big_arena, live, 1);
+    
+    calc->operator_count = 0;
+    calc->acc_add_op = OP_ADD;
+    calc->pending_op = OP_NONE;
+    calc->input_mantissa = 0;
+    calc->has_decimal = 0;
+    calc->decimal_places = 0;
+    calc->input_buffer[0] = '\0';
+    calc->input_pos = 0;
+    
+    // The start of the result also goes in expression[] (easter-egg and
+    // game codes are matched against it)
+    int length = BigNum_TextLength(&calc->big_arena, &calc->big_result);
+    int i;
+    for(i = 0; i < length && i < MAX_EXPRESSION_LENGTH - 1; i++) {
+        calc->expression[i] = BigNum_CharAt(&calc->big_arena, &calc->big_result, i);
+    }
+    calc->expression[i] = '\0';
+    calc->input_start = 0;
+    calc->big_view = 0;
+    
+    calc->state = STATE_SHOW_RESULT;
+}
+
+// Show the next screen of a bignum result, back to the start after the end
+static void Calculator_BigPage(Calculator* calc) {
+    calc->big_view += LCD_COLUMNS;
+    if(calc->big_view >= BigNum_TextLength(&calc->big_arena, &calc->big_result)) {
+        calc->big_view = 0;
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Fraction mode
+// ---------------------------------------------------------------------------
+// The bignum mode evaluation on exact fractions. Nothing is converted to a
+// CalcNumber until # asks for the decimal value of a result.
+
+// Turn a fraction status into an error message; returns 1 on error
+static int Calculator_FracCheck(Calculator* calc, FractionStatus status) {
+    if(status == FRACTION_OK) {
+        return 0;
+    }
+    if(status == FRACTION_OVERFLOW) {
+        Calculator_SetError(calc, "Overflow");
+    } else if(status == FRACTION_DIV_ZERO) {
+        Calculator_SetError(calc, "Div by 0");
+    } else {
+        Calculator_SetError(calc, "Invalid result");
+    }
+    return 1;
+}
+
+// Fraction version of Calculator_ApplyOperator
+static FractionStatus Calculator_FracApply(Fraction* result, const Fraction* a,
+                                           Operator op, const Fraction* b) {
+    switch(op) {
+        case OP_ADD:      return Fraction_Add(result, a, b);
+        case OP_SUBTRACT: return Fraction_Subtract(result, a, b);
+        case OP_MULTIPLY: return Fraction_Multiply(result, a, b);
+        case OP_DIVIDE:   return Fraction_Divide(result, a, b);
+        case OP_POWER10:  return Fraction_Scale10(result, a, b);
+        default:
+            *result = *b;
+            return FRACTION_OK;
+    }
+}
+
+// result = frac_sum (acc_add_op) frac_term
+static FractionStatus Calculator_FracFold(Calculator* calc, Fraction* result) {
+    return Calculator_FracApply(result, &calc->frac_sum, calc->acc_add_op, &calc->frac_term);
+}
+
+// Fraction version of Calculator_CommitOperand: the operand is the typed
+// number (as an exact decimal fraction) or the last result
+static void Calculator_FracCommitOperand(Calculator* calc) {
+    Fraction value;
+    FractionStatus status = FRACTION_OK;
+    
+    if(calc->state == STATE_ENTERING_NUMBER) {
+        status = Fraction_FromInput(&value, calc->input_mantissa, calc->decimal_places);
+    } else {
+        value = calc->frac_result;
+    }
+    
+    if(status == FRACTION_OK) {
+        if(calc->pending_op == OP_NONE) {
+            calc->frac_term = value;
+        } else if(Calculator_GetOperatorPrecedence(calc->pending_op) == 2) {
+            status = Calculator_FracApply(&calc->frac_term, &calc->frac_term, calc->pending_op, &value);
+        } else {
+            status = Calculator_FracFold(calc, &calc->frac_sum);
+            calc->acc_add_op = calc->pending_op;
+            calc->frac_term = value;
+        }
+    }
+    calc->pending_op = OP_NONE;
+    
+    Calculator_FracCheck(calc, status);
+}
+
+// Exact digits of value (with its sign) at buffer; returns the length
+static int Calculator_FracDigits(char* buffer, long long value) {
+    char digits[20];
+    int count = 0;
+    int pos = 0;
+    unsigned long long magnitude = (value < 0) ? 0ULL - (unsigned long long)value
+                                               : (unsigned long long)value;
+    
+    if(value < 0) {
+        buffer[pos++] = '-';
+    }
+    do {
+        digits[count++] = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while(magnitude != 0);
+    while(count > 0) {
+        buffer[pos++] = digits[--count];
+    }
+    return pos;
+}
+
+// "num/den", or just "num" for a whole number; returns the length. The
+// buffer needs room for two 20-character numbers, the slash and the end.
+static int Calculator_FracText(char* buffer, const Fraction* value) {
+    int pos = Calculator_FracDigits(buffer, value->num);
+    if(value->den != 1) {
+        buffer[pos++] = '/';
+        pos += Calculator_FracDigits(buffer + pos, value->den);
+    }
+    buffer[pos] = '\0';
+    return pos;
+}
+
+// Fraction version of Calculator_Equals
+static void Calculator_FracEquals(Calculator* calc) {
+    Fraction result;
+    char text[42];
+    
+    if(calc->state == STATE_ENTERING_NUMBER || calc->state == STATE_SHOW_RESULT) {
+        Calculator_FracCommitOperand(calc);
+        if(calc->state == STATE_ERROR) {
+            return;
+        }
+    }
+    
+    if(Calculator_FracCheck(calc, Calculator_FracFold(calc, &result))) {
+        return;
+    }
+    
+    calc->frac_result = result;
+    Fraction_FromInteger(&calc->frac_sum, 0);
+    Fraction_FromInteger(&calc->frac_term, 0);
+    calc->frac_decimal = 0;
+    
+    calc->operator_count = 0;
+    calc->acc_add_op = OP_ADD;
+    calc->pending_op = OP_NONE;
+    calc->input_mantissa = 0;
+    calc->has_decimal = 0;
+    calc->decimal_places = 0;
+    calc->input_buffer[0] = '\0';
+    calc->input_pos = 0;
+    
+    // The start of the result also goes in expression[] (easter-egg and
+    // game codes are matched against it)
+    Calculator_FracText(text, &calc->frac_result);
+    strncpy(calc->expression, text, MAX_EXPRESSION_LENGTH - 1);
+    calc->expression[MAX_EXPRESSION_LENGTH - 1] = '\0';
+    calc->input_start = 0;
+    
+    calc->state = STATE_SHOW_RESULT;
+}
+
+static void Calculator_FracDisplay(Calculator* calc) {
+    const Fraction* result = &calc->frac_result;
+    char text[42];
+    
+    // Line 1: Shift indicator, or "FRAC" ("FRAC dec" for the decimal view)
+    if(calc->shift_active) {
+        LCD_String("SHIFT");
+    } else {
+        LCD_String((calc->state == STATE_SHOW_RESULT && calc->frac_decimal) ? "FRAC dec" : "FRAC");
+    }
+    
+    LCD_Cmd(LCD_LINE2);
+    if(calc->state != STATE_SHOW_RESULT) {
+        LCD_String(calc->expression);
+    } else if(calc->frac_decimal) {
+        // Decimal value, worked out only now
+        Calculator_FormatNumber(text, Number_Divide(Number_FromInt64(result->num),
+                                                    Number_FromInt64(result->den)),
+                                LCD_COLUMNS + 1);
+        LCD_String(text);
+    } else if(Calculator_FracText(text, result) <= LCD_COLUMNS) {
+        LCD_String(text);
+    } else {
+        // Too wide for one line: the numerator goes at the right of line 1
+        // and "/den" on line 2
+        Calculator_FormatInteger(text, result->num, LCD_COLUMNS - 3);
+        LCD_SetCursor(0, LCD_COLUMNS - strlen(text));
+        LCD_String(text);
+        LCD_SetCursor(1, 0);
+        LCD_Char('/');
+        Calculator_FormatInteger(text, result->den, LCD_COLUMNS);
+        LCD_String(text);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// RPN mode
+// ---------------------------------------------------------------------------
+// HP-style entry: * (ENTER) pushes the number typed onto the stack and
+// each operator takes Y and X off it and leaves its result in X at once.
+// There is no expression, precedence or parentheses, so every key is a
+// fixed number of register moves. Shift+6 rolls the stack down and
+// Shift+7 swaps X and Y (they are the parenthesis keys elsewhere).
+
+// 1 if a number is being typed (it is X until it is terminated)
+static int Calculator_RpnTyped(Calculator* calc) {
+    return calc->state == STATE_ENTERING_NUMBER && calc->input_pos > 0;
+}
+
+// Push X up the stack (T drops off the top); X keeps its value
+static void Calculator_RpnLift(Calculator* calc) {
+    calc->rpn_stack[RPN_T] = calc->rpn_stack[RPN_Z];
+    calc->rpn_stack[RPN_Z] = calc->rpn_stack[RPN_Y];
+    calc->rpn_stack[RPN_Y] = calc->rpn_stack[RPN_X];
+}
+
+// Before a digit or point: a new number lifts the stack unless ENTER or
+// clear X has just freed X for it
+static void Calculator_RpnStartEntry(Calculator* calc) {
+    if(!Calculator_RpnTyped(calc) && calc->rpn_lift) {
+        Calculator_RpnLift(calc);
+    }
+}
+
+// Stop recording: resolve the program's jumps. A GTO to a label the
+// program does not have leaves it empty.
+static void Calculator_ProgramEnd(Calculator* calc) {
+    Program* program = &calc->program[calc->program_recording - 1];
+    
+    calc->program_recording = 0;
+    if(Program_Link(program) != PROGRAM_OK) {
+        Program_Clear(program);
+        Calculator_SetError(calc, "Missing label");
+    }
+}
+
+// While recording, add the instruction of a key that has just been carried
+// out (keys that failed are not recorded)
+static void Calculator_ProgramRecord(Calculator* calc, ProgramOpcode op, int operand) {
+    if(!calc->program_recording || calc->state == STATE_ERROR) {
+        return;
+    }
+    if(Program_EmitOperand(&calc->program[calc->program_recording - 1], op, operand) != PROGRAM_OK) {
+        Calculator_SetError(calc, "Program full");
+        Calculator_ProgramEnd(calc);
+    }
+}
+
+// Program opcode for an RPN operator or function (PROGRAM_OP_END if it has none)
+static ProgramOpcode Calculator_ProgramOpcode(Operator op) {
+    switch(op) {
+        case OP_ADD:      return PROGRAM_OP_ADD;
+        case OP_SUBTRACT: return PROGRAM_OP_SUBTRACT;
+        case OP_MULTIPLY: return PROGRAM_OP_MULTIPLY;
+        case OP_DIVIDE:   return PROGRAM_OP_DIVIDE;
+        case OP_POWER10:  return PROGRAM_OP_SCALE10;
+        case OP_POWER:    return PROGRAM_OP_POWER;
+        case OP_SQRT:     return PROGRAM_OP_SQRT;
+        case OP_SIN:      return PROGRAM_OP_SIN;
+        case OP_COS:      return PROGRAM_OP_COS;
+        case OP_TAN:      return PROGRAM_OP_TAN;
+        case OP_LN:       return PROGRAM_OP_LN;
+        case OP_LOG10:    return PROGRAM_OP_LOG10;
+        case OP_EXP:      return PROGRAM_OP_EXP;
+        default:          return PROGRAM_OP_END;
+    }
+}
+
+// End number entry: the typed number becomes X (recorded as one number
+// instruction), and the next number pushes it up. The state is left as
+// after an infix operator, so the next digit starts a number without
+// clearing anything.
+static void Calculator_RpnTerminate(Calculator* calc) {
+    if(Calculator_RpnTyped(calc)) {
+        calc->rpn_stack[RPN_X] = Calculator_InputValue(calc);
+        calc->rpn_lift = 1;
+        if(calc->program_recording &&
+           Program_EmitNumber(&calc->program[calc->program_recording - 1], calc->input_mantissa,
+                              calc->decimal_places) != PROGRAM_OK) {
+            Calculator_SetError(calc, "Program full");
+            Calculator_ProgramEnd(calc);
+        }
+    }
+    calc->input_pos = 0;
+    if(calc->state != STATE_ERROR) {
+        calc->state = STATE_ENTERING_OPERATOR;
+    }
+}
+
+// Y (op) X into X, dropping Z to Y and T to Z (T is kept, so it refills
+// the stack). On an error the stack is left as it was.
+static void Calculator_RpnOperator(Calculator* calc, Operator op) {
+    Calculator_RpnTerminate(calc);
+    
+    Number_ClearExceptions();
+    CalcNumber result = Calculator_ApplyOperator(calc, calc->rpn_stack[RPN_Y], op,
+                                                 calc->rpn_stack[RPN_X]);
+    Calculator_CheckExceptions(calc);
+    if(calc->state == STATE_ERROR) {
+        return;
+    }
+    
+    calc->rpn_stack[RPN_X] = result;
+    calc->rpn_stack[RPN_Y] = calc->rpn_stack[RPN_Z];
+    calc->rpn_stack[RPN_Z] = calc->rpn_stack[RPN_T];
+    calc->rpn_lift = 1;
+    Calculator_ProgramRecord(calc, Calculator_ProgramOpcode(op), 0);
+}
+
+// A function menu entry: f(X) into X, or the path loss operator
+static void Calculator_RpnFunction(Calculator* calc, Operator fn) {
+    if(fn == OP_PATH_LOSS) {
+        Calculator_RpnOperator(calc, fn);
+        return;
+    }
+    if(!Calculator_IsFunction(fn)) {
+        return;
+    }
+    Calculator_RpnTerminate(calc);
+    
+    Number_ClearExceptions();
+    CalcNumber result = Calculator_EvalFunction(fn, calc->rpn_stack[RPN_X]);
+    Calculator_CheckExceptions(calc);
+    if(calc->state == STATE_ERROR) {
+        return;
+    }
+    calc->rpn_stack[RPN_X] = result;
+    calc->rpn_lift = 1;
+    Calculator_ProgramRecord(calc, Calculator_ProgramOpcode(fn), 0);
+}
+
+// Roll down: X goes to T and the others move down one
+static void Calculator_RpnRoll(Calculator* calc) {
+    Calculator_RpnTerminate(calc);
+    CalcNumber x = calc->rpn_stack[RPN_X];
+    calc->rpn_stack[RPN_X] = calc->rpn_stack[RPN_Y];
+    calc->rpn_stack[RPN_Y] = calc->rpn_stack[RPN_Z];
+    calc->rpn_stack[RPN_Z] = calc->rpn_stack[RPN_T];
+    calc->rpn_stack[RPN_T] = x;
+    calc->rpn_lift = 1;
+    Calculator_ProgramRecord(calc, PROGRAM_OP_ROLL, 0);
+}
+
+static void Calculator_RpnSwap(Calculator* calc) {
+    Calculator_RpnTerminate(calc);
+    CalcNumber x = calc->rpn_stack[RPN_X];
+    calc->rpn_stack[RPN_X] = calc->rpn_stack[RPN_Y];
+    calc->rpn_stack[RPN_Y] = x;
+    calc->rpn_lift = 1;
+    Calculator_ProgramRecord(calc, PROGRAM_OP_SWAP, 0);
+}
+
+// Program menu: the screens, and the instruction each digit records (STO
+// and RCL are also carried out). The first screen's 3 starts or ends
+// recording; the second screen is only for recording.
+#define PROGRAM_MENU_ITEMS      5
+#define PROGRAM_MENU_PAGES      2
+#define PROGRAM_PROMPT_RECORD   PROGRAM_OPCODES     // Waiting for the program to record
+
+static const unsigned char program_menu_ops[PROGRAM_MENU_PAGES][PROGRAM_MENU_ITEMS] = {
+    { PROGRAM_OP_STORE, PROGRAM_OP_RECALL, PROGRAM_OP_END, PROGRAM_OP_END, PROGRAM_OP_END },
+    { PROGRAM_OP_LABEL, PROGRAM_OP_GOTO, PROGRAM_OP_DSZ, PROGRAM_OP_IF_ZERO, PROGRAM_OP_IF_NEGATIVE }
+};
+
+static const char* const program_menu_lines[PROGRAM_MENU_PAGES][2] = {
+    { "1Sto 2Rcl 3Rec",   "              >" },
+    { "1Lbl 2Gto 3Dsz",   "4x=0? 5x<0?   >" }
+};
+
+// An instruction with a digit: register for STO, RCL and DSZ, label for
+// LBL and GTO
+static void Calculator_ProgramOperand(Calculator* calc, ProgramOpcode op, int digit) {
+    if(op == PROGRAM_OP_STORE) {
+        Calculator_RpnTerminate(calc);
+        calc->program_registers[digit] = calc->rpn_stack[RPN_X];
+        calc->rpn_lift = 1;
+    } else if(op == PROGRAM_OP_RECALL) {
+        Calculator_RpnTerminate(calc);
+        if(calc->rpn_lift) {
+            Calculator_RpnLift(calc);
+        }
+        calc->rpn_stack[RPN_X] = calc->program_registers[digit];
+        calc->rpn_lift = 1;
+    } else {
+        // Recorded, not carried out: a loop or test only means something
+        // when the program runs
+        Calculator_RpnTerminate(calc);
+    }
+    Calculator_ProgramRecord(calc, op, digit);
+}
+
+// A key while the program menu or its digit prompt is open
+static void Calculator_ProgramMenuKey(Calculator* calc, char key) {
+    int page = calc->program_menu - 1;
+    int prompt = calc->program_prompt;
+    
+    calc->program_menu = 0;
+    calc->program_prompt = 0;
+    if(prompt == PROGRAM_PROMPT_RECORD) {
+        if(key >= '1' && key < '1' + CALC_PROGRAMS) {
+            Calculator_RpnTerminate(calc);
+            calc->program_recording = key - '0';
+            Program_Clear(&calc->program[calc->program_recording - 1]);
+        }
+        return;
+    }
+    if(prompt != 0) {
+        if(key >= '0' && key <= '9') {
+            Calculator_ProgramOperand(calc, (ProgramOpcode)prompt, key - '0');
+        }
+        return;
+    }
+    if(key == 'A') {
+        calc->program_menu = (page + 1) % PROGRAM_MENU_PAGES + 1;
+        return;
+    }
+    if(key < '1' || key >= '1' + PROGRAM_MENU_ITEMS) {
+        return;
+    }
+    
+    ProgramOpcode op = (ProgramOpcode)program_menu_ops[page][key - '1'];
+    if(page == 0 && key == '3') {
+        // Record, or end the recording
+        if(calc->program_recording) {
+            Calculator_RpnTerminate(calc);
+            Calculator_ProgramEnd(calc);
+        } else {
+            calc->program_prompt = PROGRAM_PROMPT_RECORD;
+        }
+    } else if(op == PROGRAM_OP_END || (page == 1 && !calc->program_recording)) {
+        return;
+    } else if(op == PROGRAM_OP_IF_ZERO || op == PROGRAM_OP_IF_NEGATIVE) {
+        Calculator_RpnTerminate(calc);
+        Calculator_ProgramRecord(calc, op, 0);
+    } else {
+        calc->program_prompt = op;
+    }
+}
+
+// Run program n on the stack and R0-R9, timing it
+static void Calculator_ProgramRun(Calculator* calc, int n) {
+    ProgramMachine machine = { calc->rpn_stack, &calc->rpn_lift, calc->program_registers };
+    
+    Calculator_RpnTerminate(calc);
+    if(calc->program[n].length == 0) {
+        Calculator_SetError(calc, "Empty program");
+        return;
+    }
+    unsigned long start = CycleCounter_Read();
+    ProgramStatus status = Program_Run(&calc->program[n], &machine, &calc->program_steps);
+    calc->program_cycles = CycleCounter_Read() - start;
+    if(status == PROGRAM_DIV_ZERO) {
+        Calculator_SetError(calc, "Div by 0");
+    } else if(status == PROGRAM_TOO_LONG) {
+        Calculator_SetError(calc, "Too many steps");
+    } else {
+        Calculator_CheckExceptions(calc);
+    }
+    calc->program_shown = n + 1;
+}
+
+void Calculator_RpnKey(Calculator* calc, char key) {
+    int shifted = calc->shift_active;
+    calc->shift_active = 0;
+    calc->program_shown = 0;
+    
+    if(calc->program_menu || calc->program_prompt) {
+        Calculator_ProgramMenuKey(calc, key);
+        return;
+    }
+    if(shifted) {
+        if(key == 'A') {
+            Calculator_RpnOperator(calc, OP_MULTIPLY);
+        } else if(key == 'B') {
+            Calculator_RpnOperator(calc, OP_DIVIDE);
+        } else if(key == 'C') {
+            Calculator_RpnOperator(calc, OP_POWER10);
+        } else if(key == '0') {
+            Calculator_RpnOperator(calc, OP_POWER);
+        } else if(key == '6') {
+            Calculator_RpnRoll(calc);
+        } else if(key == '7') {
+            Calculator_RpnSwap(calc);
+        } else if(key >= '1' && key < '1' + CALC_PROGRAMS) {
+            // Run a program (not from inside a recording)
+            if(!calc->program_recording) {
+                Calculator_ProgramRun(calc, key - '1');
+            }
+        } else if(key == '5') {
+            calc->program_menu = 1;
+        } else if(key == '#') {
+            // Clear the whole stack
+            for(int i = 0; i < CALC_RPN_LEVELS; i++) {
+                calc->rpn_stack[i] = Number_Zero();
+            }
+            calc->rpn_lift = 0;
+            Calculator_Clear(calc);
+            Calculator_ProgramRecord(calc, PROGRAM_OP_CLEAR_STACK, 0);
+        } else if(key == '8') {
+            calc->fn_menu_active = 1;
+            calc->fn_menu_page = FN_MENU_SCIENTIFIC;
+        } else if(key == '9') {
+            calc->mode_menu_active = 1;
+        }
+        return;
+    }
+    
+    if(key >= '0' && key <= '9') {
+        Calculator_RpnStartEntry(calc);
+        Calculator_EnterDigit(calc, key);
+    } else if(key == 'C') {
+        Calculator_RpnStartEntry(calc);
+        Calculator_EnterDecimal(calc);
+    } else if(key == '*') {
+        // ENTER: copy X into Y; the next number typed replaces the copy
+        Calculator_RpnTerminate(calc);
+        Calculator_RpnLift(calc);
+        calc->rpn_lift = 0;
+        Calculator_ProgramRecord(calc, PROGRAM_OP_ENTER, 0);
+    } else if(key == 'A') {
+        Calculator_RpnOperator(calc, OP_ADD);
+    } else if(key == 'B') {
+        Calculator_RpnOperator(calc, OP_SUBTRACT);
+    } else if(key == '#') {
+        if(Calculator_RpnTyped(calc)) {
+            Calculator_Backspace(calc);
+        } else {
+            // Clear X; the next number typed replaces it
+            calc->rpn_stack[RPN_X] = Number_Zero();
+            calc->rpn_lift = 0;
+            calc->state = STATE_ENTERING_OPERATOR;
+            Calculator_ProgramRecord(calc, PROGRAM_OP_CLEAR_X, 0);
+        }
+    }
+}
+
+static void Calculator_RpnDisplay(Calculator* calc) {
+    char text[LCD_COLUMNS + 1];
+    
+    if(calc->program_menu) {
+        const char* const* lines = program_menu_lines[calc->program_menu - 1];
+        LCD_String((char*)((calc->program_menu == 1 && calc->program_recording) ? "1Sto 2Rcl 3End"
+                                                                                 : lines[0]));
+        LCD_Cmd(LCD_LINE2);
+        LCD_String((char*)lines[1]);
+        return;
+    }
+    
+    // Line 1: Shift indicator, the digit asked for, the program being
+    // recorded with its instruction count, the last run's instruction count
+    // and time, or "RPN" and Y at the right
+    if(calc->shift_active) {
+        LCD_String("SHIFT");
+    } else if(calc->program_prompt == PROGRAM_PROMPT_RECORD) {
+        LCD_String("Record prog 1-4");
+    } else if(calc->program_prompt == PROGRAM_OP_STORE || calc->program_prompt == PROGRAM_OP_RECALL ||
+              calc->program_prompt == PROGRAM_OP_DSZ) {
+        LCD_String("Register 0-9");
+    } else if(calc->program_prompt != 0) {
+        LCD_String("Label 0-9");
+    } else if(calc->program_recording) {
+        text[0] = 'P';
+        text[1] = 'R';
+        text[2] = 'G';
+        text[3] = (char)('0' + calc->program_recording);
+        text[4] = '\0';
+        LCD_String(text);
+        Calculator_ShowCount("i=", (uint32_t)calc->program[calc->program_recording - 1].count, 4);
+    } else if(calc->program_shown) {
+        uint32_t steps = (uint32_t)calc->program_steps;
+        int pos = 0;
+        text[pos++] = 'P';
+        text[pos++] = (char)('0' + calc->program_shown);
+        text[pos++] = ' ';
+        text[pos++] = 'n';
+        text[pos++] = '=';
+        NumFormat_WriteDigits(text + pos, steps, NumFormat_DigitCount(steps));
+        pos += NumFormat_DigitCount(steps);
+        text[pos] = '\0';
+        LCD_String(text);
+        Calculator_ShowTime(calc->program_cycles, pos);
+    } else {
+        LCD_String("RPN");
+        Calculator_FormatNumber(text, calc->rpn_stack[RPN_Y], LCD_COLUMNS - 5);
+        LCD_SetCursor(0, LCD_COLUMNS - strlen(text));
+        LCD_String(text);
+    }
+    
+    // Line 2: The number being typed, or X
+    LCD_Cmd(LCD_LINE2);
+    if(Calculator_RpnTyped(calc)) {
+        LCD_String(calc->input_buffer);
+    } else {
+        Calculator_FormatNumber(text, calc->rpn_stack[RPN_X], LCD_COLUMNS + 1);
+        LCD_String(text);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Statistics mode
+// ---------------------------------------------------------------------------
+// Each number entered is a sample y, paired with its sample number as x,
+// or an "x,y" pair. Samples go straight into the streaming accumulators,
+// so the count is not limited by the expression arrays.
+
+// Value of the entry being typed, as a float sample
+static float Calculator_StatsInput(Calculator* calc) {
+    return Number_ToFloat(Calculator_InputValue(calc));
+}
+
+// 1 if a number has been typed
+static int Calculator_StatsTyped(Calculator* calc) {
+    return calc->state == STATE_ENTERING_NUMBER && calc->input_pos > 0;
+}
+
+// Add the entry as a sample and start a new one
+static void Calculator_StatsAdd(Calculator* calc) {
+    if(!Calculator_StatsTyped(calc)) {
+        return;
+    }
+    float y = Calculator_StatsInput(calc);
+    float x = calc->stats_pair ? calc->stats_x : (float)(calc->stats.count + 1);
+    Stats_Add(&calc->stats, x, y);
+    Calculator_Clear(calc);
+}
+
+// ",": the number typed so far is x, the next one is y
+static void Calculator_StatsComma(Calculator* calc) {
+    if(!Calculator_StatsTyped(calc) || calc->stats_pair) {
+        return;
+    }
+    calc->stats_x = Calculator_StatsInput(calc);
+    calc->stats_pair = 1;
+    Calculator_AppendChar(calc, ',');
+    calc->state = STATE_ENTERING_OPERATOR;
+}
+
+// Show the current result page on line 2 ("-" if it is not defined yet)
+static void Calculator_StatsShowPage(Calculator* calc) {
+    const StatsAccumulator* stats = &calc->stats;
+    float value = 0.0f;
+    int defined;
+    
+    switch(calc->stats_page) {
+        case STATS_PAGE_MEAN:      defined = Stats_Mean(stats, &value);        break;
+        case STATS_PAGE_STDDEV:    defined = Stats_StdDev(stats, &value);      break;
+        case STATS_PAGE_MIN:       defined = Stats_Min(stats, &value);         break;
+        case STATS_PAGE_MAX:       defined = Stats_Max(stats, &value);         break;
+        case STATS_PAGE_SLOPE:     defined = Stats_Slope(stats, &value);       break;
+        case STATS_PAGE_INTERCEPT: defined = Stats_Intercept(stats, &value);   break;
+        case STATS_PAGE_R:         defined = Stats_Correlation(stats, &value); break;
+        default:                   defined = 0;                                break;
+    }
+    
+    if(calc->stats_page == STATS_PAGE_COUNT) {
+        Calculator_FormatInteger(calc->expression, (long long)stats->count, MAX_EXPRESSION_LENGTH);
+    } else if(defined) {
+        Calculator_FormatNumber(calc->expression, Number_FromFloat(value), MAX_EXPRESSION_LENGTH);
+    } else {
+        strcpy(calc->expression, "-");
+    }
+    calc->state = STATE_SHOW_RESULT;
+}
+
+static void Calculator_StatsKey(Calculator* calc, char key) {
+    int shifted = calc->shift_active;
+    calc->shift_active = 0;
+    
+    if(shifted) {
+        if(key == 'C') {
+            Calculator_StatsComma(calc);
+        } else if(key == '#') {
+            // Clear the entry; on an empty entry, clear all samples
+            if(calc->state == STATE_ENTERING_NUMBER && calc->input_pos == 0) {
+                Stats_Init(&calc->stats);
+            }
+            Calculator_Clear(calc);
+        } else if(key == '*') {
+            // Batch recompute from the buffer, then show the mean
+            if(!Stats_Recompute(&calc->stats)) {
+                Calculator_SetError(calc, "Too many samples");
+            } else if(calc->stats.count > 0) {
+                calc->stats_page = STATS_PAGE_MEAN;
+                Calculator_StatsShowPage(calc);
+            }
+        } else if(key == '9') {
+            calc->mode_menu_active = 1;
+        }
+        return;
+    }
+    
+    if(key >= '0' && key <= '9') {
+        Calculator_EnterDigit(calc, key);
+    } else if(key == 'C') {
+        Calculator_EnterDecimal(calc);
+    } else if(key == '#') {
+        Calculator_Backspace(calc);
+    } else if(key == 'A') {
+        Calculator_StatsAdd(calc);
+    } else if(key == '*') {
+        // Add a typed sample first; on a result, step to the next page
+        if(calc->state == STATE_SHOW_RESULT) {
+            calc->stats_page = (calc->stats_page + 1) % STATS_PAGES;
+        } else {
+            Calculator_StatsAdd(calc);
+            calc->stats_page = STATS_PAGE_COUNT;
+        }
+        if(calc->stats.count > 0) {
+            Calculator_StatsShowPage(calc);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Solve mode
+// ---------------------------------------------------------------------------
+// The equation f(X) is entered like any expression, with Shift+1 for X.
+// Equals compiles its tape to a SolveProgram (solve.c); the starting guess
+// is then typed and equals runs the solver from it. The program is kept
+// until a new equation is started, so other roots can be looked for from
+// other guesses without entering it again.
+
+// Solver opcode for a tape token
+static SolveOpcode Calculator_SolveOpcode(Operator op) {
+    switch(op) {
+        case OP_VARIABLE: return SOLVE_OP_X;
+        case OP_ADD:      return SOLVE_OP_ADD;
+        case OP_SUBTRACT: return SOLVE_OP_SUBTRACT;
+        case OP_MULTIPLY: return SOLVE_OP_MULTIPLY;
+        case OP_DIVIDE:   return SOLVE_OP_DIVIDE;
+        case OP_POWER10:  return SOLVE_OP_SCALE10;
+        case OP_POWER:    return SOLVE_OP_POWER;
+        case OP_SQRT:     return SOLVE_OP_SQRT;
+        case OP_SIN:      return SOLVE_OP_SIN;
+        case OP_COS:      return SOLVE_OP_COS;
+        case OP_TAN:      return SOLVE_OP_TAN;
+        case OP_LN:       return SOLVE_OP_LN;
+        case OP_LOG10:    return SOLVE_OP_LOG10;
+        case OP_EXP:      return SOLVE_OP_EXP;
+        default:          return SOLVE_OP_CONST;    // Not an operation; Solve_Emit rejects it
+    }
+}
+
+// Compile the tape into solve_program, once per equation. Returns 0, with
+// an error shown, if it does not fit or has no X to solve for (a constant
+// is a valid integrand).
+static int Calculator_SolveCompile(Calculator* calc) {
+    SolveProgram* program = &calc->solve_program;
+    int ok = 1;
+    
+    Solve_Init(program);
+    for(int i = 0; i < calc->tape_length && ok; i++) {
+        const CalcTapeEntry* entry = &calc->tape[i];
+        if(entry->op == OP_NONE) {
+            ok = Solve_EmitConstant(program, Number_ToFloat(entry->value));
+        } else {
+            ok = Solve_Emit(program, Calculator_SolveOpcode(entry->op));
+        }
+    }
+    
+    if(!ok || !Solve_IsComplete(program)) {
+        Calculator_SetError(calc, "Equation too long");
+        return 0;
+    }
+    if(!program->uses_x && calc->mode == MODE_SOLVE) {
+        Calculator_SetError(calc, "No X in equation");
+        return 0;
+    }
+    return 1;
+}
+
+// Show a value on line 2 as a result: the next guess or bound, or (when
+// shown is 1) the solver's X or the integral
+static void Calculator_SolveShowValue(Calculator* calc, float value, int shown) {
+    Calculator_Clear(calc);
+    calc->current_number = Number_FromFloat(value);
+    calc->result_exact = 0;
+    Calculator_FormatNumber(calc->expression, calc->current_number, MAX_EXPRESSION_LENGTH);
+    calc->state = STATE_SHOW_RESULT;
+    calc->solve_shown = shown;
+}
+
+static void Calculator_SolveShowX(Calculator* calc, int shown) {
+    Calculator_SolveShowValue(calc, calc->solve_x, shown);
+}
+
+// Equals on the equation: finish and compile it, then ask for the guess
+// (the last X is offered), the integral's lower bound or the table's start
+static void Calculator_SolveEquals(Calculator* calc) {
+    Calculator_Calculate(calc);
+    
+    // From here on errors are reported
+    calc->solve_guess = 1;
+    if(!Calculator_SolveCompile(calc)) {
+        // Back to a new equation once the error is cleared
+        calc->solve_guess = 0;
+        return;
+    }
+    if(calc->mode == MODE_INTEGRATE) {
+        calc->integrate_upper = 0;
+        calc->solve_x = calc->integrate_a;
+    } else if(calc->mode == MODE_TABLE) {
+        calc->table_step_entry = 0;
+        calc->solve_x = calc->table_start;
+    }
+    Calculator_SolveShowX(calc, 0);
+}
+
+// Run the solver from x0 and show where it ended: the root, or the point
+// with the smallest |f(X)| if it did not converge
+static void Calculator_SolveRun(Calculator* calc, float x0) {
+    unsigned long start = CycleCounter_Read();
+    Solve_Root(&calc->solve_program, x0, &calc->solve_result);
+    calc->solve_cycles = CycleCounter_Read() - start;
+    if(calc->solve_result.status == SOLVE_UNDEFINED) {
+        Calculator_SetError(calc, "f(X) undefined");
+        return;
+    }
+    calc->solve_x = calc->solve_result.x;
+    Calculator_SolveShowX(calc, 1);
+}
+
+// Change the sign of the number being typed ("-" in front of the digits)
+static void Calculator_SolveNegate(Calculator* calc) {
+    calc->solve_negative = !calc->solve_negative;
+    calc->expression[0] = '-';
+    calc->input_start = calc->solve_negative ? 1 : 0;
+    Calculator_UpdateInputBuffer(calc);
+    if(calc->input_pos == 0) {
+        strcpy(calc->expression + calc->input_start, "0");
+    }
+}
+
+// Number keys at a prompt that offers solve_x (the guess, a bound, a table
+// range or a matrix cell): digits, point and backspace edit a typed number,
+// and B changes its sign, or the sign of the value offered. Returns 0 for
+// any other key.
+static int Calculator_PromptKey(Calculator* calc, char key) {
+    if(key >= '0' && key <= '9') {
+        Calculator_EnterDigit(calc, key);
+    } else if(key == 'C') {
+        Calculator_EnterDecimal(calc);
+    } else if(key == '#') {
+        Calculator_Backspace(calc);
+    } else if(key == 'B') {
+        if(calc->state == STATE_ENTERING_NUMBER) {
+            Calculator_SolveNegate(calc);
+        } else if(!calc->solve_shown || calc->mode == MODE_SOLVE) {
+            // (An integral or a table on display is not a value offered)
+            calc->solve_x = -calc->solve_x;
+            Calculator_SolveShowX(calc, 0);
+        }
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+// The number typed at a prompt, or the value offered if none was typed
+static float Calculator_PromptValue(Calculator* calc) {
+    float value = calc->solve_x;
+    if(calc->state == STATE_ENTERING_NUMBER) {
+        value = Number_ToFloat(Calculator_InputValue(calc));
+        if(calc->solve_negative) {
+            value = -value;
+        }
+    }
+    return value;
+}
+
+// Keys while the starting guess, a bound or the table range is entered
+// (the equation is compiled), and on the result
+static void Calculator_SolveKey(Calculator* calc, char key) {
+    int shifted = calc->shift_active;
+    calc->shift_active = 0;
+    
+    if(shifted) {
+        if(key == '#') {
+            // Clear a typed guess; otherwise start a new equation
+            if(calc->state == STATE_ENTERING_NUMBER) {
+                Calculator_SolveShowX(calc, 0);
+            } else {
+                calc->solve_guess = 0;
+                Calculator_Clear(calc);
+            }
+        } else if(key == '9') {
+            calc->mode_menu_active = 1;
+        }
+        return;
+    }
+    if(calc->mode == MODE_TABLE && calc->solve_shown && Calculator_TableKey(calc, key)) {
+        return;
+    }
+    
+    if(Calculator_PromptKey(calc, key)) {
+        return;
+    }
+    if(key == '*') {
+        // Solve from the typed guess, or from the X on display (integrate
+        // and table modes take it as the next bound)
+        float x0 = Calculator_PromptValue(calc);
+        if(calc->mode == MODE_INTEGRATE) {
+            Calculator_IntegrateBound(calc, x0);
+        } else if(calc->mode == MODE_TABLE) {
+            Calculator_TableBound(calc, x0);
+        } else {
+            Calculator_SolveRun(calc, x0);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Integrate mode
+// ---------------------------------------------------------------------------
+// The integrand is entered and compiled as in solve mode; equals then takes
+// a and b in turn (the last bounds are offered) and integrates with
+// integrate.c. Line 1 shows how many evaluations and how long it took, from
+// the cycle counter.
+
+// Equals on a bound: a, then b and integrate. On a shown integral equals
+// starts over from a, for a new range.
+static void Calculator_IntegrateBound(Calculator* calc, float value) {
+    if(calc->solve_shown) {
+        calc->integrate_upper = 0;
+        calc->solve_x = calc->integrate_a;
+        Calculator_SolveShowX(calc, 0);
+        return;
+    }
+    if(!calc->integrate_upper) {
+        calc->integrate_a = value;
+        calc->integrate_upper = 1;
+        calc->solve_x = calc->integrate_b;
+        Calculator_SolveShowX(calc, 0);
+        return;
+    }
+    
+    calc->integrate_b = value;
+    calc->integrate_upper = 0;
+    calc->solve_x = calc->integrate_a;
+    unsigned long start = CycleCounter_Read();
+    Integrate_Run(&calc->solve_program, calc->integrate_a, calc->integrate_b,
+                  &calc->integrate_stack, &calc->integrate_result);
+    calc->integrate_cycles = CycleCounter_Read() - start;
+    if(calc->integrate_result.status == INTEGRATE_UNDEFINED) {
+        Calculator_SetError(calc, "f(X) undefined");
+        return;
+    }
+    Calculator_SolveShowValue(calc, calc->integrate_result.value, 1);
+}
+
+// ---------------------------------------------------------------------------
+// Table mode
+// ---------------------------------------------------------------------------
+// The expression is entered and compiled as in solve mode; equals then
+// takes the start X and the step (the last ones are offered) and evaluates
+// every row into the table at once (table.c). Paging through the rows and
+// switching to the plot only redraw from it, and the plot's custom
+// characters are sent to the LCD once per table.
+
+// Format a float from the table into at most size - 1 columns
+static void Calculator_TableFormat(char* buffer, float value, int size) {
+    Calculator_FormatNumber(buffer, Number_FromFloat(value), size);
+}
+
+// Equals on the range: the start, then the step and fill the table. On a
+// shown table equals starts over from the start, for a new range.
+static void Calculator_TableBound(Calculator* calc, float value) {
+    if(calc->solve_shown) {
+        calc->table_step_entry = 0;
+        calc->solve_x = calc->table_start;
+        Calculator_SolveShowX(calc, 0);
+        return;
+    }
+    if(!calc->table_step_entry) {
+        calc->table_start = value;
+        calc->table_step_entry = 1;
+        calc->solve_x = calc->table_step;
+        Calculator_SolveShowX(calc, 0);
+        return;
+    }
+    
+    calc->table_step = value;
+    calc->table_step_entry = 0;
+    calc->solve_x = calc->table_start;
+    Table_Fill(&calc->table, &calc->solve_program, calc->table_start, calc->table_step);
+    calc->table_row = 0;
+    calc->table_plot = 0;
+    for(int g = 0; g < TABLE_GLYPHS; g++) {
+        Glyph_Define((GlyphId)(GLYPH_PLOT_0 + g), calc->table.glyph[g]);
+    }
+    
+    Calculator_Clear(calc);
+    calc->state = STATE_SHOW_RESULT;
+    calc->solve_shown = 1;
+}
+
+// Keys on a shown table; returns 0 for keys that act as during entry
+static int Calculator_TableKey(Calculator* calc, char key) {
+    if(key == 'A' || key == 'B') {
+        // Next or previous row (the plot has no row to move)
+        if(key == 'A' && !calc->table_plot && calc->table_row < TABLE_POINTS - 1) {
+            calc->table_row++;
+        } else if(key == 'B' && !calc->table_plot && calc->table_row > 0) {
+            calc->table_row--;
+        }
+        return 1;
+    }
+    if(key == 'C') {
+        calc->table_plot = !calc->table_plot;
+        return 1;
+    }
+    return 0;
+}
+
+// Table view: X and f(X) of a row. Plot view: the sparkline with the
+// largest and smallest f(X).
+static void Calculator_TableDisplay(Calculator* calc) {
+    char number[LCD_COLUMNS + 1];
+    
+    if(calc->table_plot) {
+        if(calc->shift_active) {
+            LCD_String("SHIFT");
+        } else if(calc->table.defined == 0) {
+            LCD_String("f(X) undefined");
+        } else {
+            LCD_String("max ");
+            Calculator_TableFormat(number, calc->table.max, LCD_COLUMNS - 4 + 1);
+            LCD_String(number);
+        }
+        
+        // Line 2: the plot, then the smallest f(X) in the columns left
+        LCD_Cmd(LCD_LINE2);
+        for(int g = 0; g < TABLE_GLYPHS; g++) {
+            LCD_Char(Glyph_Get((GlyphId)(GLYPH_PLOT_0 + g)));
+        }
+        if(calc->table.defined > 0) {
+            LCD_Char(' ');
+            Calculator_TableFormat(number, calc->table.min, LCD_COLUMNS - TABLE_GLYPHS - 1 + 1);
+            LCD_String(number);
+        }
+        return;
+    }
+    
+    // Line 1: X and the row number
+    if(calc->shift_active) {
+        LCD_String("SHIFT");
+    } else {
+        LCD_String("X=");
+        Calculator_TableFormat(number, Table_X(&calc->table, calc->table_row), LCD_COLUMNS - 2 + 1);
+        LCD_String(number);
+        Calculator_ShowCount("#", (uint32_t)(calc->table_row + 1), 2 + strlen(number));
+    }
+    
+    // Line 2: f(X)
+    float y = calc->table.y[calc->table_row];
+    LCD_Cmd(LCD_LINE2);
+    if(y - y == 0.0f) {
+        LCD_String("f=");
+        Calculator_TableFormat(number, y, LCD_COLUMNS - 2 + 1);
+        LCD_String(number);
+    } else {
+        LCD_String("f undefined");
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Matrix mode
+// ---------------------------------------------------------------------------
+// A and B are entered cell by cell, row by row: the size first (a digit for
+// the rows, one for the columns), then each cell at the number prompt, with
+// the cell's current value offered. Operations put their answer in the
+// result matrix (matrix.c does the work, in the CMSIS-DSP kernels on the
+// target), which is then stepped through a cell at a time. The pool lives
+// in the context, so none of the matrices are on the small startup stack.
+
+// Menu line 2, a page at a time (* turns the page): the operations on A
+// and B, then transpose, R to A, show R and the operators (Sx = Shift + A)
+#define MATRIX_MENU_PAGES   2
+
+static const char* const matrix_menu_lines[MATRIX_MENU_PAGES] = {
+    "1A 2B 3det 4inv>",
+    "5T 6R>A 0R +-Sx>"
+};
+
+// Letter of a matrix in the pool
+static char Calculator_MatrixName(int which) {
+    return (which == CALC_MATRIX_A) ? 'A' : (which == CALC_MATRIX_B) ? 'B' : 'R';
+}
+
+// "<rows>x<cols>" into buffer; returns its length
+static int Calculator_MatrixSize(char* buffer, const Matrix* matrix) {
+    buffer[0] = (char)('0' + matrix->rows);
+    buffer[1] = 'x';
+    buffer[2] = (char)('0' + matrix->cols);
+    buffer[3] = '\0';
+    return 3;
+}
+
+// Back to the menu (its first page), with the entry cleared
+static void Calculator_MatrixMenu(Calculator* calc) {
+    Calculator_Clear(calc);
+    calc->matrix_screen = MATRIX_SCREEN_MENU;
+    calc->matrix_menu_page = 0;
+}
+
+// Offer the current cell of the matrix being entered at the number prompt
+static void Calculator_MatrixOfferCell(Calculator* calc) {
+    calc->solve_x = calc->matrix[calc->matrix_edit].data[calc->matrix_cell];
+    Calculator_SolveShowX(calc, 0);
+    calc->matrix_screen = MATRIX_SCREEN_CELL;
+}
+
+// Size typed or accepted: resize (a new size starts from zeros) and enter
+// the cells from the first
+static void Calculator_MatrixStartCells(Calculator* calc, int rows, int cols) {
+    Matrix* matrix = &calc->matrix[calc->matrix_edit];
+    if(rows != matrix->rows || cols != matrix->cols) {
+        Matrix_Init(matrix, rows, cols);
+    }
+    calc->matrix_rows = 0;
+    calc->matrix_cell = 0;
+    Calculator_MatrixOfferCell(calc);
+}
+
+// Equals on a cell: store it and offer the next one, or go back to the
+// menu after the last
+static void Calculator_MatrixStoreCell(Calculator* calc) {
+    Matrix* matrix = &calc->matrix[calc->matrix_edit];
+    matrix->data[calc->matrix_cell] = Calculator_PromptValue(calc);
+    calc->matrix_cell++;
+    if(calc->matrix_cell < matrix->rows * matrix->cols) {
+        Calculator_MatrixOfferCell(calc);
+    } else {
+        Calculator_MatrixMenu(calc);
+    }
+}
+
+// Show the result of an operation from its first cell, or the error
+static void Calculator_MatrixShowResult(Calculator* calc, MatrixStatus status) {
+    Calculator_MatrixMenu(calc);
+    if(status == MATRIX_SIZE_MISMATCH) {
+        Calculator_SetError(calc, "Size mismatch");
+    } else if(status == MATRIX_SINGULAR) {
+        Calculator_SetError(calc, "Singular matrix");
+    } else {
+        calc->matrix_edit = CALC_MATRIX_RESULT;
+        calc->matrix_cell = 0;
+        calc->matrix_screen = MATRIX_SCREEN_VIEW;
+    }
+}
+
+// Operation keys on the menu
+static void Calculator_MatrixOperation(Calculator* calc, char key) {
+    const Matrix* a = &calc->matrix[CALC_MATRIX_A];
+    const Matrix* b = &calc->matrix[CALC_MATRIX_B];
+    Matrix* result = &calc->matrix[CALC_MATRIX_RESULT];
+    Matrix* scratch = &calc->matrix[CALC_MATRIX_SCRATCH];
+    
+    if((key == '3' || key == '4') && a->rows != a->cols) {
+        Calculator_SetError(calc, "A not square");
+        return;
+    }
+    switch(key) {
+        case 'A': Calculator_MatrixShowResult(calc, Matrix_Add(a, b, result));            break;
+        case 'B': Calculator_MatrixShowResult(calc, Matrix_Subtract(a, b, result));       break;
+        case 'x': Calculator_MatrixShowResult(calc, Matrix_Multiply(a, b, result));       break;
+        case '4': Calculator_MatrixShowResult(calc, Matrix_Inverse(a, result, scratch));  break;
+        case '5': Calculator_MatrixShowResult(calc, Matrix_Transpose(a, result));         break;
+        case '0': Calculator_MatrixShowResult(calc, MATRIX_OK);                           break;
+        case '3':
+            Matrix_Determinant(a, &calc->matrix_determinant, scratch);
+            calc->matrix_screen = MATRIX_SCREEN_DETERMINANT;
+            break;
+        case '6':
+            // Result to A, to carry on from it
+            calc->matrix[CALC_MATRIX_A] = *result;
+            break;
+        default:
+            break;
+    }
+}
+
+static void Calculator_MatrixKey(Calculator* calc, char key) {
+    int shifted = calc->shift_active;
+    calc->shift_active = 0;
+    
+    if(shifted) {
+        if(key == '9') {
+            calc->mode_menu_active = 1;
+        } else if(key == '#') {
+            // Clear a typed cell; otherwise back to the menu
+            if(calc->matrix_screen == MATRIX_SCREEN_CELL && calc->state == STATE_ENTERING_NUMBER) {
+                Calculator_MatrixOfferCell(calc);
+            } else {
+                Calculator_MatrixMenu(calc);
+            }
+        } else if(key == 'A' && calc->matrix_screen == MATRIX_SCREEN_MENU) {
+            Calculator_MatrixOperation(calc, 'x');
+        }
+        return;
+    }
+    
+    switch(calc->matrix_screen) {
+        case MATRIX_SCREEN_MENU:
+            if(key == '1' || key == '2') {
+                calc->matrix_edit = (key == '1') ? CALC_MATRIX_A : CALC_MATRIX_B;
+                calc->matrix_rows = 0;
+                calc->matrix_screen = MATRIX_SCREEN_SIZE;
+            } else if(key == '*') {
+                calc->matrix_menu_page = (calc->matrix_menu_page + 1) % MATRIX_MENU_PAGES;
+            } else {
+                Calculator_MatrixOperation(calc, key);
+            }
+            break;
+        
+        case MATRIX_SCREEN_SIZE:
+            if(key >= '1' && key <= '0' + MATRIX_MAX_SIZE) {
+                // Rows, then columns
+                if(calc->matrix_rows == 0) {
+                    calc->matrix_rows = key - '0';
+                } else {
+                    Calculator_MatrixStartCells(calc, calc->matrix_rows, key - '0');
+                }
+            } else if(key == '*' && calc->matrix_rows == 0) {
+                // Keep the size
+                const Matrix* matrix = &calc->matrix[calc->matrix_edit];
+                Calculator_MatrixStartCells(calc, matrix->rows, matrix->cols);
+            } else if(key == '#') {
+                if(calc->matrix_rows == 0) {
+                    Calculator_MatrixMenu(calc);
+                } else {
+                    calc->matrix_rows = 0;
+                }
+            }
+            break;
+        
+        case MATRIX_SCREEN_CELL:
+            if(!Calculator_PromptKey(calc, key) && key == '*') {
+                Calculator_MatrixStoreCell(calc);
+            }
+            break;
+        
+        case MATRIX_SCREEN_VIEW: {
+            const Matrix* matrix = &calc->matrix[calc->matrix_edit];
+            if(key == 'A' && calc->matrix_cell < matrix->rows * matrix->cols - 1) {
+                calc->matrix_cell++;
+            } else if(key == 'B' && calc->matrix_cell > 0) {
+                calc->matrix_cell--;
+            } else if(key == '*' || key == '#') {
+                Calculator_MatrixMenu(calc);
+            }
+            break;
+        }
+        
+        default:
+            // The determinant
+            if(key == '*' || key == '#') {
+                Calculator_MatrixMenu(calc);
+            }
+            break;
+    }
+}
+
+static void Calculator_MatrixDisplay(Calculator* calc) {
+    const Matrix* matrix = &calc->matrix[calc->matrix_edit];
+    char name = Calculator_MatrixName(calc->matrix_edit);
+    char text[LCD_COLUMNS + 1];
+    int pos = 0;
+    
+    // Line 1: Shift indicator, or what is on display
+    if(calc->shift_active) {
+        LCD_String("SHIFT");
+    } else if(calc->matrix_screen == MATRIX_SCREEN_MENU) {
+        // "MATRIX" and the sizes of A and B
+        LCD_String("MATRIX");
+        text[pos++] = 'A';
+        pos += Calculator_MatrixSize(text + pos, &calc->matrix[CALC_MATRIX_A]);
+        text[pos++] = ' ';
+        text[pos++] = 'B';
+        pos += Calculator_MatrixSize(text + pos, &calc->matrix[CALC_MATRIX_B]);
+        LCD_SetCursor(0, LCD_COLUMNS - pos);
+        LCD_String(text);
+    } else if(calc->matrix_screen == MATRIX_SCREEN_SIZE) {
+        // "Size of A" and its size now
+        LCD_String("Size of ");
+        LCD_Char(name);
+        Calculator_MatrixSize(text, matrix);
+        LCD_SetCursor(0, LCD_COLUMNS - 3);
+        LCD_String(text);
+    } else if(calc->matrix_screen == MATRIX_SCREEN_DETERMINANT) {
+        LCD_String("det A");
+    } else {
+        // "A(row,col)", "=" while entering, and the size when viewing
+        text[pos++] = name;
+        text[pos++] = '(';
+        text[pos++] = (char)('1' + calc->matrix_cell / matrix->cols);
+        text[pos++] = ',';
+        text[pos++] = (char)('1' + calc->matrix_cell % matrix->cols);
+        text[pos++] = ')';
+        if(calc->matrix_screen == MATRIX_SCREEN_CELL) {
+            text[pos++] = '=';
+        }
+        text[pos] = '\0';
+        LCD_String(text);
+        if(calc->matrix_screen == MATRIX_SCREEN_VIEW) {
+            Calculator_MatrixSize(text, matrix);
+            LCD_SetCursor(0, LCD_COLUMNS - 3);
+            LCD_String(text);
+        }
+    }
+    
+    // Line 2: The operations, the size being typed, or a value
+    LCD_Cmd(LCD_LINE2);
+    if(calc->matrix_screen == MATRIX_SCREEN_MENU) {
+        LCD_String((char*)matrix_menu_lines[calc->matrix_menu_page]);
+    } else if(calc->matrix_screen == MATRIX_SCREEN_SIZE) {
+        LCD_String("Rows x cols: ");
+        if(calc->matrix_rows > 0) {
+            LCD_Char((char)('0' + calc->matrix_rows));
+            LCD_Char('x');
+        }
+    } else if(calc->matrix_screen == MATRIX_SCREEN_CELL) {
+        LCD_String(calc->expression);
+    } else {
+        float value = (calc->matrix_screen == MATRIX_SCREEN_VIEW) ?
+                      matrix->data[calc->matrix_cell] : calc->matrix_determinant;
+        Calculator_FormatNumber(text, Number_FromFloat(value), LCD_COLUMNS + 1);
+        LCD_String(text);
+    }
+}
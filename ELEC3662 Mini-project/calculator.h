@@ -1,17 +1,48 @@
 #ifndef CALCULATOR_H
 #define CALCULATOR_H
 
+#include "number.h"
+#include "bignum.h"
+#include "fraction.h"
+#include "stats.h"
+#include "solve.h"
+#include "integrate.h"
+#include "table.h"
+#include "matrix.h"
+#include "program.h"
+
 // -----------------------------
 // Calculator configuration
 // -----------------------------
 
 // Maximum length of the full expression string shown on the LCD
 #define MAX_EXPRESSION_LENGTH   32
-// Maximum number of operators and operands stored for PEMDAS evaluation
-#define MAX_OPERATORS           8
-#define MAX_OPERANDS            9
+// Maximum number of binary operators in one expression.
+// The evaluator is single-pass, so this can be raised freely (-DMAX_OPERATORS=n);
+// it only costs RAM in the Calculator context.
+#ifndef MAX_OPERATORS
+#define MAX_OPERATORS           16
+#endif
+#define MAX_OPERANDS            (MAX_OPERATORS + 1)
+// Maximum number of functions (sqrt, sin, ...) in one expression
+#ifndef MAX_FUNCTIONS
+#define MAX_FUNCTIONS           8
+#endif
+// Compiled postfix tape: every operand, binary operator and function
+#define MAX_TAPE_LENGTH         (MAX_OPERANDS + MAX_OPERATORS + MAX_FUNCTIONS)
+// Maximum nesting of parentheses. Each open group saves one CalcGroup in
+// the Calculator context, so RAM use is fixed at build time (-DMAX_PAREN_DEPTH=n).
+#ifndef MAX_PAREN_DEPTH
+#define MAX_PAREN_DEPTH         8
+#endif
 // Maximum length of the current numeric input (digits + decimal point)
 #define MAX_INPUT_LENGTH        16
+// Matrix mode's pool: A, B, the result and a scratch matrix for the kernels
+#define CALC_MATRICES           4
+// RPN mode's register stack: X, Y, Z and T
+#define CALC_RPN_LEVELS         4
+// Keystroke programs in RPN mode's store, run by Shift+1 to Shift+4
+#define CALC_PROGRAMS           4
 
 // -----------------------------
 // Calculator state machine
@@ -23,6 +54,8 @@ typedef enum {
     STATE_ENTERING_OPERATOR,
     // A result has been calculated and is being shown
     STATE_SHOW_RESULT,
+    // A ')' has closed a group; its value (current_number) is the pending operand
+    STATE_GROUP_CLOSED,
     // An error has occurred (e.g. divide by zero)
     STATE_ERROR
 } CalcState;
@@ -37,9 +70,93 @@ typedef enum {
     OP_MULTIPLY,
     OP_DIVIDE,
     // Multiply by 10^n for scientific notation (value  10^exponent)
-    OP_POWER10
+    OP_POWER10,
+    // Grouping; "(" is stacked in tape_ops while the expression is compiled
+    OP_LPAREN,
+    // x^y, binds tighter than  and  (left-associative: 2^3^2 = 64)
+    OP_POWER,
+    // Free-space path loss, d (km) L f (MHz), in dB; binds like 
+    OP_PATH_LOSS,
+    // Functions of one argument (Shift+8 menu). Postfix on the tape: each
+    // applies to the operand or group just before it
+    OP_SQRT,
+    OP_SIN,
+    OP_COS,
+    OP_TAN,
+    OP_LN,
+    OP_LOG10,
+    OP_EXP,
+    // RF conversions (RF mode's function menu): dBm to mW, mW to dBm, dB to
+    // a power ratio, a ratio to dB, and MHz to metres (or metres to MHz)
+    OP_DBM_TO_MW,
+    OP_MW_TO_DBM,
+    OP_DB_TO_RATIO,
+    OP_RATIO_TO_DB,
+    OP_WAVELENGTH,
+    // The variable X of solve, integrate and table modes. Only used on the
+    // tape, where it is an operand whose value is supplied later
+    OP_VARIABLE
 } Operator;
 
+// -----------------------------
+// Calculator modes (Shift+9 opens the mode menu)
+// -----------------------------
+typedef enum {
+    // Everyday arithmetic on CalcNumber values (float or decimal backend)
+    MODE_NORMAL = 0,
+    // Exact arbitrary-precision arithmetic, limbs held in the context's arena
+    MODE_BIGNUM,
+    // Streaming statistics: each number entered is a sample
+    MODE_STATS,
+    // Equation solver: an expression in X is compiled and solved for f(X) = 0
+    MODE_SOLVE,
+    // Definite integral of an expression in X, compiled as for the solver
+    MODE_INTEGRATE,
+    // Table and plot of an expression in X over a range
+    MODE_TABLE,
+    // Small matrices (up to 4  4) with the CMSIS-DSP matrix kernels
+    MODE_MATRIX,
+    // Normal arithmetic with dB, wavelength and path loss conversions
+    MODE_RF,
+    // Exact fractions: results kept as a reduced numerator and denominator
+    MODE_FRACTION,
+    // Reverse Polish entry on an X/Y/Z/T register stack
+    MODE_RPN
+} CalcMode;
+
+// -----------------------------
+// Parenthesis stack entry
+// -----------------------------
+// Running evaluation of the enclosing expression, saved by '(' and restored
+// by ')'. The group's value is then folded in with the saved pending_op.
+typedef struct {
+    CalcNumber acc_sum;
+    CalcNumber acc_term;
+    Operator   acc_add_op;
+    Operator   pending_op;
+    int        exact;
+    long long  int_sum;
+    long long  int_term;
+    CalcNumber pow_base;
+    long long  pow_int;
+    int        pow_exact;
+    Operator   pow_op;
+    int        input_start;                  // Index in expression[] of the "("
+} CalcGroup;
+
+// -----------------------------
+// Compiled expression (RPN tape) entry
+// -----------------------------
+// op == OP_NONE pushes the operand (OP_VARIABLE pushes X); a function
+// replaces the top value and any other op pops two values and pushes the result. Also used for the operator and operand that
+// repeated equals re-applies.
+typedef struct {
+    Operator   op;
+    int        exact;                        // 1 if int_value holds the operand exactly
+    long long  int_value;
+    CalcNumber value;
+} CalcTapeEntry;
+
 // -----------------------------
 // Calculator context
 // -----------------------------
@@ -49,26 +166,159 @@ typedef struct {
     char expression[MAX_EXPRESSION_LENGTH];  // Full expression/result shown on LCD line 2
     char input_buffer[MAX_INPUT_LENGTH];     // Current number being typed as a string
     int  input_pos;                          // Current position in input_buffer
+    int  input_start;                        // Index in expression[] where the current number begins
+
+    // Slots used, per token type; each has its own limit, and a token
+    // beyond it is an error rather than being dropped
+    int        operator_count;               // Binary operators (MAX_OPERATORS)
+    int        function_count;               // Functions (MAX_FUNCTIONS)
+
+    // Running evaluation, updated as each operand is committed so that
+    // equals only has to finalize: value = acc_sum (acc_add_op) acc_term
+    CalcNumber acc_sum;                      // Committed sum of all completed +/- terms
+    CalcNumber acc_term;                     // Pending product/quotient term being built
+    Operator   acc_add_op;                   // + or - that joins acc_term onto acc_sum
+    Operator   pending_op;                   // Last operator entered, applied to the next operand
+
+    // x^y binds tighter than the term, so its base waits here until the
+    // exponent is committed; the result is then folded in with pow_op
+    CalcNumber pow_base;
+    long long  pow_int;
+    int        pow_exact;                    // 1 if pow_int holds pow_base exactly
+    Operator   pow_op;                       // Operator before the base
 
-    float    operands[MAX_OPERANDS];         // Stored operands for expression evaluation
-    Operator operators[MAX_OPERATORS];       // Stored operators between operands
-    int      operand_count;                  // Number of valid entries in operands[]
-    int      operator_count;                 // Number of valid entries in operators[]
+    // Exact integer path: while every operand so far is a whole number the
+    // running value is kept in int_sum/int_term (same roles as acc_sum and
+    // acc_term) and + -  are done in 64-bit integers with overflow checks.
+    // The first fraction, inexact  or overflow moves it to acc_sum/acc_term.
+    int        exact;                        // 1 while int_sum/int_term hold the running value
+    long long  int_sum;                      // As acc_sum
+    long long  int_term;                     // As acc_term
+    long long  int_result;                   // Last result as an integer
+    int        result_exact;                 // 1 if int_result holds current_number exactly
 
-    float current_number;                    // Current numeric value being edited
+    // Open parentheses, innermost last. Explicit fixed-size stack: no
+    // recursion, O(1) per '(' or ')'
+    CalcGroup  groups[MAX_PAREN_DEPTH];
+    int        group_depth;                  // Number of open groups
+
+    // Postfix tape, compiled while the expression is entered (shunting-yard
+    // on tape_ops) and kept after equals so it can be replayed
+    CalcTapeEntry tape[MAX_TAPE_LENGTH];
+    int        tape_length;
+    int        tape_building;                // 1 while the tape belongs to the expression being entered
+    Operator   tape_ops[MAX_OPERATORS + MAX_PAREN_DEPTH]; // Operators and "(" not yet emitted to the tape
+    int        tape_op_top;
+    CalcTapeEntry repeat;                    // Last operator and operand, re-applied by repeated equals
+    // Value stacks for running the tape (replay); kept here rather than on
+    // the main stack, which interrupts share
+    long long  tape_ints[MAX_OPERANDS];
+    CalcNumber tape_values[MAX_OPERANDS];
+
+    CalcNumber current_number;               // Last result (value used when no number is being typed)
+    unsigned long long input_mantissa;       // Digits typed so far as an exact integer
     int   has_decimal;                       // 1 if a decimal point has been entered
-    int   decimal_places;                    // Number of decimal digits entered so far
+    int   decimal_places;                    // Number of decimal digits entered so far (value = mantissa  10^-decimal_places)
 
     CalcState state;                         // Current calculator state
 
     // Memory register used by MS/MR/MC/M+/M- functions
-    float memory;
+    CalcNumber memory;
 
     // When 1, the next key is interpreted as a shifted function (, , E, clear, memory)
     int shift_active;
 
     // Short error message shown when STATE_ERROR is set
     char error_msg[20];
+
+    // Active mode; mode_menu_active is 1 while waiting for the mode digit
+    CalcMode mode;
+    int      mode_menu_active;
+    int      mode_menu_page;                 // Mode menu screen on display
+
+    // 1 while the function menu (Shift+8) waits for the function digit
+    int      fn_menu_active;
+    int      fn_menu_page;                   // Function menu screen on display
+
+    // Bignum mode: the running evaluation and last result as arena numbers
+    BigNum   big_sum;                        // As acc_sum
+    BigNum   big_term;                       // As acc_term
+    BigNum   big_result;                     // Last result (chained on like current_number)
+    int      big_view;                       // First character of big_result shown on line 2
+    BigArena big_arena;                      // Limb storage for all bignum values (no malloc)
+
+    // Fraction mode: the running evaluation and last result as exact fractions
+    Fraction frac_sum;                       // As acc_sum
+    Fraction frac_term;                      // As acc_term
+    Fraction frac_result;                    // Last result (chained on like current_number)
+    int      frac_decimal;                   // 1 while the result is shown as a decimal
+
+    // Statistics mode: the samples so far (kept across clear), the x of an
+    // "x,y" pair being entered and the result page on display
+    StatsAccumulator stats;
+    float    stats_x;
+    int      stats_pair;                     // 1 once "," has been entered
+    int      stats_page;
+
+    // Solve mode: the equation compiled from the tape and the last solve
+    // (kept across clear), the starting guess being typed, and the X used
+    // for the next solve. Integrate and table modes share the equation,
+    // and every prompt shares the number entry: solve_x is the value
+    // offered (the next bound, or a matrix cell).
+    SolveProgram solve_program;
+    SolveResult  solve_result;
+    unsigned long solve_cycles;              // Core clock cycles the last solve took
+    float    solve_x;
+    int      solve_guess;                    // 1 once the equation is compiled and a guess is entered
+    int      solve_shown;                    // 1 while solve_result (or integrate_result) is on display
+    int      solve_negative;                 // 1 if the number being typed is negative
+
+    // Integrate mode: the bounds (kept across clear), which one is being
+    // entered, the interval stack and the last integral with its time
+    float    integrate_a;
+    float    integrate_b;
+    int      integrate_upper;                // 1 while b is entered
+    IntegrateStack  integrate_stack;
+    IntegrateResult integrate_result;
+    unsigned long   integrate_cycles;        // Core clock cycles the integral took
+
+    // Table mode: the range (kept across clear), whether the step is being
+    // entered, the table with its plot, and what is on display
+    float    table_start;
+    float    table_step;
+    int      table_step_entry;               // 1 while the step is entered
+    TableData table;
+    int      table_row;
+    int      table_plot;                     // 1 while the plot is shown
+
+    // Matrix mode: the matrix pool (kept across clear), the screen on
+    // display, the matrix and cell being entered or viewed, and the
+    // determinant last worked out
+    Matrix   matrix[CALC_MATRICES];
+    int      matrix_screen;
+    int      matrix_menu_page;               // Line 2 of the menu: operations 1-4 or the rest
+    int      matrix_edit;
+    int      matrix_cell;
+    int      matrix_rows;                    // Rows typed on the size screen (0 = none yet)
+    float    matrix_determinant;
+
+    // RPN mode: the register stack (kept across clear), X first, and
+    // whether the next number typed pushes X up (stack lift) or replaces it
+    CalcNumber rpn_stack[CALC_RPN_LEVELS];
+    int      rpn_lift;
+
+    // Keystroke programs and their registers R0-R9 (kept across clear and
+    // mode changes), the program being recorded (n + 1, 0 if none), the
+    // program menu (page + 1, 0 if closed) or the instruction waiting for
+    // its digit, and the last run with its time
+    Program  program[CALC_PROGRAMS];
+    CalcNumber program_registers[PROGRAM_REGISTERS];
+    int      program_recording;
+    int      program_menu;
+    int      program_prompt;                 // Opcode waiting for its digit (0 if none)
+    int      program_shown;                  // Program last run (n + 1) while its count is on display
+    long     program_steps;
+    unsigned long program_cycles;            // Core clock cycles the run took
 } Calculator;
 
 // -----------------------------
@@ -78,7 +328,7 @@ void Calculator_Init(Calculator* calc);           // Reset all state to power-on
 void Calculator_ProcessKey(Calculator* calc, char key); // Handle a single key press
 void Calculator_Clear(Calculator* calc);          // Clear entire calculator state
 void Calculator_ClearEntry(Calculator* calc);     // Clear only the current number
-float Calculator_Calculate(Calculator* calc);     // Evaluate expression with operator precedence
+CalcNumber Calculator_Calculate(Calculator* calc); // Evaluate expression with operator precedence
 void Calculator_DisplayUpdate(Calculator* calc);  // Refresh LCD based on current state
 
 // -----------------------------
@@ -87,7 +337,12 @@ void Calculator_DisplayUpdate(Calculator* calc);  // Refresh LCD based on curren
 void Calculator_EnterDigit(Calculator* calc, char digit); // Handle 09
 void Calculator_EnterDecimal(Calculator* calc);           // Handle decimal point
 void Calculator_EnterOperator(Calculator* calc, Operator op); // Handle +, -, , , E
+void Calculator_OpenGroup(Calculator* calc);              // Handle (
+void Calculator_CloseGroup(Calculator* calc);             // Handle )
+void Calculator_EnterVariable(Calculator* calc);          // Handle X (solve, integrate and table modes)
+void Calculator_ApplyFunction(Calculator* calc, Operator fn); // Apply sqrt, sin, ... to the current operand
 void Calculator_Equals(Calculator* calc);                 // Handle equals key
+void Calculator_Replay(Calculator* calc);                 // Re-run the last expression on a new first operand
 void Calculator_Backspace(Calculator* calc);              // Delete last input digit
 
 // -----------------------------
@@ -95,6 +350,12 @@ void Calculator_Backspace(Calculator* calc);              // Delete last input d
 // -----------------------------
 void Calculator_ToggleShift(Calculator* calc);
 
+// -----------------------------
+// Modes
+// -----------------------------
+void Calculator_SetMode(Calculator* calc, CalcMode mode); // Switch mode (starts a new calculation)
+void Calculator_RpnKey(Calculator* calc, char key);       // Handle a key in RPN mode (no display update)
+
 // -----------------------------
 // Memory functions (MS/MR/MC/M+/M-)
 // -----------------------------
@@ -108,10 +369,14 @@ void Calculator_MemorySubtract(Calculator* calc); // M- 
 // Utility helpers
 // -----------------------------
 int  Calculator_GetOperatorPrecedence(Operator op);
+int  Calculator_IsFunction(Operator op);
 char Calculator_OperatorToChar(Operator op);
 void Calculator_SetError(Calculator* calc, const char* msg);
-void Calculator_FormatNumber(char* buffer, float number, int buffer_size);
+void Calculator_FormatNumber(char* buffer, CalcNumber number, int buffer_size);
 void Calculator_UpdateInputBuffer(Calculator* calc);
+int  Calculator_Preview(Calculator* calc, CalcNumber* result); // Live partial result (1 if available)
+int  Calculator_PreviewExact(Calculator* calc, long long* result); // As Calculator_Preview, while the integer path is active
+void Calculator_FormatInteger(char* buffer, long long number, int buffer_size);
 
 // Map a raw keypad key to an operator depending on shift state
 Operator Calculator_KeyToOperator(char key, int shifted);
@@ -0,0 +1,339 @@
+/*
+ * Decimal Arithmetic Implementation
+ *
+ * 16-digit decimal floating point with correct round-half-even results.
+ * Coefficients are normalised to exactly 16 digits, so every operation
+ * works on integers below 10^19 (a single uint64_t) plus a sticky flag
+ * for digits that were shifted out:
+ *   add/subtract - align with two guard digits and a sticky bit
+ *   multiply     - 8-digit halves, four 32x32->64 partial products
+ *   divide       - restoring long division, one digit per step
+ *   E scaling    - exponent addition only (exact)
+ */
+
+#include "decimal.h"
+#include "numformat.h"
+#include <float.h>
+
+#define COEFF_MIN   1000000000000000ULL     // 10^15
+#define COEFF_LIMIT 10000000000000000ULL    // 10^16
+#define HALF_LIMIT  100000000ULL            // 10^8
+
+// Powers of ten that fit a uint64_t (10^0 .. 10^19)
+static const uint64_t pow10_u64[20] = {
+    1ULL,                    10ULL,                    100ULL,
+    1000ULL,                 10000ULL,                 100000ULL,
+    1000000ULL,              10000000ULL,              100000000ULL,
+    1000000000ULL,           10000000000ULL,           100000000000ULL,
+    1000000000000ULL,        10000000000000ULL,        100000000000000ULL,
+    1000000000000000ULL,     10000000000000000ULL,     100000000000000000ULL,
+    1000000000000000000ULL,  10000000000000000000ULL
+};
+
+// Sticky status, cleared by Decimal_ClearStatus
+static int decimal_status = 0;
+
+void Decimal_ClearStatus(void) {
+    decimal_status = 0;
+}
+
+int Decimal_TestStatus(void) {
+    return decimal_status;
+}
+
+Decimal Decimal_Zero(void) {
+    Decimal zero;
+    zero.coefficient = 0;
+    zero.exponent = 0;
+    zero.negative = 0;
+    return zero;
+}
+
+// Normalise coefficient  10^exponent to 16 digits and round half-even.
+// sticky is non-zero if digits below the coefficient were already lost.
+// The coefficient may be up to 19 digits; it is only scaled up when exact.
+static Decimal Decimal_Pack(int negative, uint64_t coefficient, int exponent, int sticky) {
+    Decimal result;
+    unsigned int round_digit = 0;
+
+    if(coefficient == 0) {
+        result = Decimal_Zero();
+        if(sticky) {
+            decimal_status |= DECIMAL_UNDERFLOW;
+        }
+        return result;
+    }
+
+    // Too many digits: shift out the excess, remembering the last one
+    while(coefficient >= COEFF_LIMIT) {
+        sticky |= (round_digit != 0);
+        round_digit = (unsigned int)(coefficient % 10);
+        coefficient /= 10;
+        exponent++;
+    }
+
+    // Round half to even
+    if(round_digit > 5 || (round_digit == 5 && (sticky || (coefficient & 1)))) {
+        coefficient++;
+        if(coefficient == COEFF_LIMIT) {
+            coefficient /= 10;
+            exponent++;
+        }
+    }
+
+    // Too few digits: scale up (exact, nothing was shifted out)
+    while(coefficient < COEFF_MIN) {
+        coefficient *= 10;
+        exponent--;
+    }
+
+    // Range check on the adjusted exponent (the power of the first digit)
+    if(exponent + DECIMAL_DIGITS - 1 > DECIMAL_EMAX) {
+        decimal_status |= DECIMAL_OVERFLOW;
+        coefficient = COEFF_LIMIT - 1;
+        exponent = DECIMAL_EMAX - (DECIMAL_DIGITS - 1);
+    } else if(exponent + DECIMAL_DIGITS - 1 < DECIMAL_EMIN) {
+        decimal_status |= DECIMAL_UNDERFLOW;
+        return Decimal_Zero();
+    }
+
+    result.coefficient = coefficient;
+    result.exponent = exponent;
+    result.negative = negative;
+    return result;
+}
+
+Decimal Decimal_FromDigits(uint64_t mantissa, int exponent) {
+    return Decimal_Pack(0, mantissa, exponent, 0);
+}
+
+Decimal Decimal_FromFloat(float value) {
+    char digits[NUMFORMAT_MAX_DIGITS];
+    int exponent;
+    int negative = 0;
+    uint64_t mantissa = 0;
+
+    if(value == 0.0f) {
+        return Decimal_Zero();
+    }
+    if(value != value) {
+        decimal_status |= DECIMAL_INVALID;
+        return Decimal_Zero();
+    }
+    if(value < 0) {
+        negative = 1;
+        value = -value;
+    }
+    if(value > FLT_MAX) {
+        // Infinity: saturate like any other overflow
+        return Decimal_Pack(negative, COEFF_LIMIT - 1, DECIMAL_EMAX, 0);
+    }
+
+    // The shortest round-trip digits are the decimal the float stands for
+    int count = NumFormat_Shortest(value, digits, &exponent);
+    for(int i = 0; i < count; i++) {
+        mantissa = mantissa * 10 + (digits[i] - '0');
+    }
+    return Decimal_Pack(negative, mantissa, exponent - count + 1, 0);
+}
+
+float Decimal_ToFloat(Decimal value) {
+    double result = (double)value.coefficient;
+    int exponent = value.exponent;
+
+    // 10^15 is exact in double; apply the exponent in at most a few steps
+    while(exponent > 15) {
+        result *= 1e15;
+        exponent -= 15;
+    }
+    while(exponent < -15) {
+        result /= 1e15;
+        exponent += 15;
+    }
+    if(exponent >= 0) {
+        result *= (double)pow10_u64[exponent];
+    } else {
+        result /= (double)pow10_u64[-exponent];
+    }
+
+    return (float)(value.negative ? -result : result);
+}
+
+int Decimal_IsZero(Decimal value) {
+    return value.coefficient == 0;
+}
+
+int Decimal_Compare(Decimal a, Decimal b) {
+    int sign;
+
+    if(a.coefficient == 0 && b.coefficient == 0) {
+        return 0;
+    }
+    if(a.coefficient == 0) {
+        return b.negative ? 1 : -1;
+    }
+    if(b.coefficient == 0 || a.negative != b.negative) {
+        return a.negative ? -1 : 1;
+    }
+
+    // Same sign, both normalised: exponent decides first, then coefficient
+    sign = a.negative ? -1 : 1;
+    if(a.exponent != b.exponent) {
+        return (a.exponent > b.exponent) ? sign : -sign;
+    }
+    if(a.coefficient != b.coefficient) {
+        return (a.coefficient > b.coefficient) ? sign : -sign;
+    }
+    return 0;
+}
+
+Decimal Decimal_Add(Decimal a, Decimal b) {
+    uint64_t big;
+    uint64_t small;
+    int sticky = 0;
+
+    if(b.coefficient == 0) {
+        return a;
+    }
+    if(a.coefficient == 0) {
+        return b;
+    }
+
+    // Let a be the operand with the larger exponent (and so the larger magnitude)
+    if(b.exponent > a.exponent) {
+        Decimal swap = a;
+        a = b;
+        b = swap;
+    }
+
+    // Two guard digits on a; b is shifted to match and loses any digits
+    // below them into the sticky flag
+    int shift = a.exponent - b.exponent;
+    big = a.coefficient * 100;
+    if(shift <= 2) {
+        small = b.coefficient * pow10_u64[2 - shift];
+    } else if(shift - 2 <= DECIMAL_DIGITS) {
+        uint64_t divisor = pow10_u64[shift - 2];
+        small = b.coefficient / divisor;
+        sticky = (b.coefficient % divisor) != 0;
+    } else {
+        small = 0;
+        sticky = 1;
+    }
+
+    if(a.negative == b.negative) {
+        return Decimal_Pack(a.negative, big + small, a.exponent - 2, sticky);
+    }
+
+    // Different signs: the lost digits of b make the true difference
+    // slightly smaller, so borrow one and keep the sticky flag
+    if(big >= small) {
+        uint64_t difference = big - small - (sticky ? 1 : 0);
+        if(difference == 0 && !sticky) {
+            return Decimal_Zero();
+        }
+        return Decimal_Pack(a.negative, difference, a.exponent - 2, sticky);
+    }
+    return Decimal_Pack(b.negative, small - big, a.exponent - 2, 0);
+}
+
+Decimal Decimal_Subtract(Decimal a, Decimal b) {
+    b.negative = !b.negative;
+    return Decimal_Add(a, b);
+}
+
+Decimal Decimal_Multiply(Decimal a, Decimal b) {
+    if(a.coefficient == 0 || b.coefficient == 0) {
+        return Decimal_Zero();
+    }
+
+    // Split both coefficients into 8-digit halves
+    uint32_t a1 = (uint32_t)(a.coefficient / HALF_LIMIT);
+    uint32_t a0 = (uint32_t)(a.coefficient % HALF_LIMIT);
+    uint32_t b1 = (uint32_t)(b.coefficient / HALF_LIMIT);
+    uint32_t b0 = (uint32_t)(b.coefficient % HALF_LIMIT);
+
+    uint64_t low = (uint64_t)a0 * b0;
+    uint64_t middle = (uint64_t)a1 * b0 + (uint64_t)a0 * b1;
+    uint64_t high = (uint64_t)a1 * b1;
+
+    // Product as four base-10^8 limbs: l3 l2 l1 l0 (31 or 32 digits)
+    uint64_t l0 = low % HALF_LIMIT;
+    middle += low / HALF_LIMIT;
+    uint64_t l1 = middle % HALF_LIMIT;
+    high += middle / HALF_LIMIT;
+    uint64_t l2 = high % HALF_LIMIT;
+    uint64_t l3 = high / HALF_LIMIT;
+
+    // Keep the top 18-19 digits (product / 10^13), the rest is sticky
+    uint64_t top = l3 * 100000000000ULL + l2 * 1000 + l1 / 100000;
+    int sticky = (l1 % 100000) != 0 || l0 != 0;
+
+    return Decimal_Pack(a.negative != b.negative, top,
+                        a.exponent + b.exponent + 13, sticky);
+}
+
+Decimal Decimal_Divide(Decimal a, Decimal b) {
+    if(b.coefficient == 0) {
+        decimal_status |= (a.coefficient == 0) ? DECIMAL_INVALID : DECIMAL_DIV_ZERO;
+        return Decimal_Zero();
+    }
+    if(a.coefficient == 0) {
+        return Decimal_Zero();
+    }
+
+    // Long division: both coefficients have 16 digits, so the quotient's
+    // first digit is at most 9; produce 17 digits (16 + one guard digit)
+    // and use the remainder as the sticky flag
+    uint64_t remainder = a.coefficient;
+    uint64_t divisor = b.coefficient;
+    uint64_t quotient = 0;
+    int exponent = a.exponent - b.exponent;
+    int digits = 0;
+
+    while(digits < DECIMAL_DIGITS + 1) {
+        unsigned int digit = 0;
+        while(remainder >= divisor) {
+            remainder -= divisor;
+            digit++;
+        }
+        quotient = quotient * 10 + digit;
+        if(quotient != 0) {
+            digits++;
+        }
+        remainder *= 10;
+        exponent--;
+    }
+
+    return Decimal_Pack(a.negative != b.negative, quotient, exponent + 1, remainder != 0);
+}
+
+Decimal Decimal_Scale10(Decimal a, int exponent) {
+    if(a.coefficient == 0) {
+        return a;
+    }
+    // Clamp so the exponent sum cannot wrap before the range check
+    if(exponent > 2 * DECIMAL_EMAX) exponent = 2 * DECIMAL_EMAX;
+    if(exponent < 2 * DECIMAL_EMIN) exponent = 2 * DECIMAL_EMIN;
+    return Decimal_Pack(a.negative, a.coefficient, a.exponent + exponent, 0);
+}
+
+void Decimal_Format(char* buffer, Decimal value, int buffer_size) {
+    char digits[DECIMAL_DIGITS];
+    int count = DECIMAL_DIGITS;
+
+    if(value.coefficient == 0) {
+        buffer[0] = '0';
+        buffer[1] = '\0';
+        return;
+    }
+
+    NumFormat_WriteDigits(digits, (uint32_t)(value.coefficient / HALF_LIMIT), 8);
+    NumFormat_WriteDigits(digits + 8, (uint32_t)(value.coefficient % HALF_LIMIT), 8);
+    while(count > 1 && digits[count - 1] == '0') {
+        count--;
+    }
+
+    NumFormat_Layout(buffer, buffer_size, value.negative, digits, count,
+                     value.exponent + DECIMAL_DIGITS - 1);
+}
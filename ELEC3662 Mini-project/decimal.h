@@ -0,0 +1,59 @@
+/*
+ * Decimal Arithmetic Header
+ * 
+ * 16-digit decimal floating point: value = coefficient  10^exponent,
+ * with the coefficient kept as a binary integer (the IEEE 754-2008 BID
+ * layout) so the Cortex-M4's 32x32 multiplier does the digit arithmetic.
+ * Every result is rounded to 16 significant digits with round-half-even,
+ * so decimal inputs such as 0.1 are exact and 0.1 + 0.2 == 0.3.
+ * 
+ * Errors are recorded in sticky status flags, like the FPU's FPSCR.
+ */
+
+#ifndef DECIMAL_H
+#define DECIMAL_H
+
+#include <stdint.h>
+
+// Precision and range
+#define DECIMAL_DIGITS          16
+#define DECIMAL_EMAX            99      // Largest value 9.999...E+99
+#define DECIMAL_EMIN            (-99)   // Smallest normal value 1E-99
+
+// Sticky status flags
+#define DECIMAL_INVALID         0x01
+#define DECIMAL_DIV_ZERO        0x02
+#define DECIMAL_OVERFLOW        0x04
+#define DECIMAL_UNDERFLOW       0x08
+
+typedef struct {
+    uint64_t coefficient;   // 0, or exactly 16 digits (10^15 <= c < 10^16)
+    int      exponent;      // Power of ten applied to the coefficient
+    int      negative;      // 1 if the value is negative
+} Decimal;
+
+// Construction and conversion
+Decimal Decimal_Zero(void);
+Decimal Decimal_FromDigits(uint64_t mantissa, int exponent);  // mantissa  10^exponent
+Decimal Decimal_FromFloat(float value);                       // Shortest decimal of the float
+float   Decimal_ToFloat(Decimal value);
+
+// Arithmetic (correctly rounded to 16 digits)
+Decimal Decimal_Add(Decimal a, Decimal b);
+Decimal Decimal_Subtract(Decimal a, Decimal b);
+Decimal Decimal_Multiply(Decimal a, Decimal b);
+Decimal Decimal_Divide(Decimal a, Decimal b);
+Decimal Decimal_Scale10(Decimal a, int exponent);             // a  10^exponent (exact)
+
+// Queries
+int Decimal_IsZero(Decimal value);
+int Decimal_Compare(Decimal a, Decimal b);                    // -1, 0 or 1
+
+// Status flags
+void Decimal_ClearStatus(void);
+int  Decimal_TestStatus(void);
+
+// Display: shortest digits (trailing zeros removed) laid out like a float
+void Decimal_Format(char* buffer, Decimal value, int buffer_size);
+
+#endif // DECIMAL_H
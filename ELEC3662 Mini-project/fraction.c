@@ -0,0 +1,220 @@
+/*
+ * Exact Fraction Implementation
+ *
+ * Stein's GCD: gcd(2^k a, 2^k b) = 2^k gcd(a, b), and for odd a <= b,
+ * gcd(a, b) = gcd(a, b - a) where b - a is even, so its trailing zeros can
+ * be shifted out at once. Every step at least halves b, giving at most 64
+ * iterations of a compare, a subtract and a count-trailing-zeros, against
+ * Euclid's 64-bit division per step (a library call on the Cortex-M4).
+ */
+
+#include "fraction.h"
+#include <stdint.h>
+#include <limits.h>
+
+// Trailing zero bits of a nonzero word. RBIT needs Thumb-2 (Armv7 on,
+// so the Cortex-M3/M4/M7, not the M0) as well as CLZ; this is about the
+// instruction set, not whether there is an FPU.
+#if defined(__ARM_FEATURE_CLZ) && defined(__ARM_ARCH) && __ARM_ARCH >= 7
+static int Fraction_Ctz32(uint32_t x) {
+    uint32_t zeros;
+    // Bit-reverse, then count the leading zeros
+    __asm ("rbit %0, %1" : "=r" (zeros) : "r" (x));
+    __asm ("clz %0, %1" : "=r" (zeros) : "r" (zeros));
+    return (int)zeros;
+}
+#else
+// Isolate the lowest set bit and look its position up with a de Bruijn
+// multiply (no branches, unlike a bit-by-bit loop)
+static const unsigned char fraction_debruijn[32] = {
+     0,  1, 28,  2, 29, 14, 24,  3, 30, 22, 20, 15, 25, 17,  4,  8,
+    31, 27, 13, 23, 21, 19, 16,  7, 26, 12, 18,  6, 11,  5, 10,  9
+};
+
+static int Fraction_Ctz32(uint32_t x) {
+    return fraction_debruijn[(uint32_t)((x & (0u - x)) * 0x077CB531u) >> 27];
+}
+#endif
+
+static int Fraction_Ctz64(unsigned long long x) {
+    uint32_t low = (uint32_t)x;
+    return (low != 0) ? Fraction_Ctz32(low) : 32 + Fraction_Ctz32((uint32_t)(x >> 32));
+}
+
+// Stein's loop on two odd words, which is where the 64-bit loop ends up as
+// soon as both values fit in 32 bits
+static uint32_t Fraction_Gcd32(uint32_t a, uint32_t b) {
+    for(;;) {
+        if(a > b) {
+            uint32_t swap = a;
+            a = b;
+            b = swap;
+        }
+        b -= a;
+        if(b == 0) {
+            return a;
+        }
+        b >>= Fraction_Ctz32(b);
+    }
+}
+
+unsigned long long Fraction_Gcd(unsigned long long a, unsigned long long b) {
+    if(a == 0) return b;
+    if(b == 0) return a;
+
+    int shift = Fraction_Ctz64(a | b);      // Common factors of two
+    a >>= Fraction_Ctz64(a);
+    b >>= Fraction_Ctz64(b);
+    while((a | b) > 0xFFFFFFFFULL) {
+        if(a > b) {
+            unsigned long long swap = a;
+            a = b;
+            b = swap;
+        }
+        b -= a;
+        if(b == 0) {
+            return a << shift;
+        }
+        b >>= Fraction_Ctz64(b);
+    }
+    return (unsigned long long)Fraction_Gcd32((uint32_t)a, (uint32_t)b) << shift;
+}
+
+static unsigned long long Fraction_Magnitude(long long value) {
+    return (value < 0) ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+}
+
+// a  b into *product; returns 0 if |a  b| > LLONG_MAX
+static int Fraction_MultiplyFits(long long a, long long b, long long* product) {
+    unsigned long long ma = Fraction_Magnitude(a);
+    unsigned long long mb = Fraction_Magnitude(b);
+
+    // Both within 31 bits (the usual case): the product always fits
+    if((ma | mb) > 0x7FFFFFFFULL && ma != 0 && mb > (unsigned long long)LLONG_MAX / ma) {
+        return 0;
+    }
+    unsigned long long magnitude = ma * mb;
+    *product = ((a < 0) != (b < 0)) ? -(long long)magnitude : (long long)magnitude;
+    return 1;
+}
+
+// a + b into *sum; returns 0 on overflow
+static int Fraction_AddFits(long long a, long long b, long long* sum) {
+    if((b > 0 && a > LLONG_MAX - b) || (b < 0 && a < LLONG_MIN - b)) {
+        return 0;
+    }
+    *sum = a + b;
+    return 1;
+}
+
+// Store an already reduced num/den (den > 0). LLONG_MIN is refused so that
+// every stored numerator can be negated.
+static FractionStatus Fraction_Set(Fraction* result, long long num, long long den) {
+    if(num == LLONG_MIN) {
+        return FRACTION_OVERFLOW;
+    }
+    result->num = num;
+    result->den = (num == 0) ? 1 : den;
+    return FRACTION_OK;
+}
+
+void Fraction_FromInteger(Fraction* result, long long value) {
+    result->num = value;
+    result->den = 1;
+}
+
+FractionStatus Fraction_FromInput(Fraction* result, unsigned long long mantissa,
+                                  int decimal_places) {
+    long long den = 1;
+
+    if(mantissa > (unsigned long long)LLONG_MAX || decimal_places < 0 || decimal_places > 18) {
+        return FRACTION_OVERFLOW;
+    }
+    for(int i = 0; i < decimal_places; i++) {
+        den *= 10;
+    }
+    long long g = (long long)Fraction_Gcd(mantissa, (unsigned long long)den);
+    return Fraction_Set(result, (long long)mantissa / g, den / g);
+}
+
+// a/b + c/d with g = gcd(b, d) is (a  d/g + c  b/g) / (b/g  d). The sum
+// t shares no factor with b/g or d/g (a and b, c and d are coprime), so
+// dividing out gcd(t, g) is all the reduction left to do (Knuth, TAOCP
+// 4.5.1), and the products never grow beyond what the result needs.
+FractionStatus Fraction_Add(Fraction* result, const Fraction* a, const Fraction* b) {
+    long long g = (long long)Fraction_Gcd((unsigned long long)a->den, (unsigned long long)b->den);
+    long long a_den = a->den / g;
+    long long b_den = b->den / g;
+    long long left;
+    long long right;
+    long long sum;
+    long long den;
+
+    if(!Fraction_MultiplyFits(a->num, b_den, &left) ||
+       !Fraction_MultiplyFits(b->num, a_den, &right) ||
+       !Fraction_AddFits(left, right, &sum)) {
+        return FRACTION_OVERFLOW;
+    }
+    if(sum == 0) {
+        return Fraction_Set(result, 0, 1);
+    }
+    long long common = (long long)Fraction_Gcd(Fraction_Magnitude(sum), (unsigned long long)g);
+    if(!Fraction_MultiplyFits(a_den, b->den / common, &den)) {
+        return FRACTION_OVERFLOW;
+    }
+    return Fraction_Set(result, sum / common, den);
+}
+
+FractionStatus Fraction_Subtract(Fraction* result, const Fraction* a, const Fraction* b) {
+    Fraction negated = { -b->num, b->den };
+    return Fraction_Add(result, a, &negated);
+}
+
+// Cross-reduction: a/b  c/d = (a/gcd(a, d)  c/gcd(c, b)) / (b/gcd(c, b) 
+// d/gcd(a, d)), already in lowest terms since a, b and c, d are coprime
+FractionStatus Fraction_Multiply(Fraction* result, const Fraction* a, const Fraction* b) {
+    long long num;
+    long long den;
+
+    if(a->num == 0 || b->num == 0) {
+        return Fraction_Set(result, 0, 1);
+    }
+    long long g1 = (long long)Fraction_Gcd(Fraction_Magnitude(a->num), (unsigned long long)b->den);
+    long long g2 = (long long)Fraction_Gcd(Fraction_Magnitude(b->num), (unsigned long long)a->den);
+    if(!Fraction_MultiplyFits(a->num / g1, b->num / g2, &num) ||
+       !Fraction_MultiplyFits(a->den / g2, b->den / g1, &den)) {
+        return FRACTION_OVERFLOW;
+    }
+    return Fraction_Set(result, num, den);
+}
+
+FractionStatus Fraction_Divide(Fraction* result, const Fraction* a, const Fraction* b) {
+    if(b->num == 0) {
+        return FRACTION_DIV_ZERO;
+    }
+    // The reciprocal keeps the sign on the numerator
+    Fraction reciprocal;
+    reciprocal.num = (b->num < 0) ? -b->den : b->den;
+    reciprocal.den = (b->num < 0) ? -b->num : b->num;
+    return Fraction_Multiply(result, a, &reciprocal);
+}
+
+FractionStatus Fraction_Scale10(Fraction* result, const Fraction* a, const Fraction* exponent) {
+    Fraction power = { 1, 1 };
+
+    if(exponent->den != 1) {
+        return FRACTION_RANGE;
+    }
+    if(a->num == 0) {
+        return Fraction_Set(result, 0, 1);
+    }
+    // 10^18 is the largest power of ten in 64 bits
+    if(exponent->num < -18 || exponent->num > 18) {
+        return FRACTION_OVERFLOW;
+    }
+    for(long long i = 0; i < exponent->num || i < -exponent->num; i++) {
+        power.num *= 10;
+    }
+    return (exponent->num < 0) ? Fraction_Divide(result, a, &power)
+                               : Fraction_Multiply(result, a, &power);
+}
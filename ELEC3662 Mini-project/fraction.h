@@ -0,0 +1,53 @@
+/*
+ * Exact Fraction Header
+ *
+ * Rational numbers held as a numerator and denominator of 64 bits each,
+ * always reduced (gcd 1) with the sign on the numerator, so 1/3 + 1/6 is
+ * exactly 1/2 and equal values compare equal field by field. Reduction
+ * uses Stein's binary GCD: shifts and subtractions only, with the runs of
+ * trailing zero bits counted by RBIT + CLZ on Armv7 and later (a de Bruijn
+ * multiply and table lookup elsewhere, e.g. on the host), and a 32-bit
+ * loop once both values fit in a word.
+ *
+ * Sums divide the denominators by their gcd first and products cancel
+ * across (a/b  c/d as (a/gcd(a,d)  c/gcd(c,b)) / ...), so the values
+ * multiplied are already as small as the result allows: an operation only
+ * overflows when the reduced result itself does not fit in 64 bits. Nothing
+ * here uses floating point; the calculator converts to a Number only when
+ * the decimal value is asked for.
+ */
+
+#ifndef FRACTION_H
+#define FRACTION_H
+
+typedef struct {
+    long long num;                  // Carries the sign
+    long long den;                  // Always > 0
+} Fraction;
+
+typedef enum {
+    FRACTION_OK = 0,
+    FRACTION_OVERFLOW,              // Reduced result does not fit in 64 bits
+    FRACTION_DIV_ZERO,
+    FRACTION_RANGE                  // E exponent not a whole number
+} FractionStatus;
+
+// Greatest common divisor (gcd(0, b) = b)
+unsigned long long Fraction_Gcd(unsigned long long a, unsigned long long b);
+
+// Construction: an integer, or a keyed-in mantissa with decimal_places
+// digits after the point (0 to 18), as an exact decimal fraction
+void Fraction_FromInteger(Fraction* result, long long value);    // value > LLONG_MIN
+FractionStatus Fraction_FromInput(Fraction* result, unsigned long long mantissa,
+                                  int decimal_places);
+
+// Arithmetic; result may be one of the operands
+FractionStatus Fraction_Add(Fraction* result, const Fraction* a, const Fraction* b);
+FractionStatus Fraction_Subtract(Fraction* result, const Fraction* a, const Fraction* b);
+FractionStatus Fraction_Multiply(Fraction* result, const Fraction* a, const Fraction* b);
+FractionStatus Fraction_Divide(Fraction* result, const Fraction* a, const Fraction* b);
+
+// a  10^exponent (the E key)
+FractionStatus Fraction_Scale10(Fraction* result, const Fraction* a, const Fraction* exponent);
+
+#endif // FRACTION_H
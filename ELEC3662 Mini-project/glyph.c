@@ -0,0 +1,147 @@
+/*
+ * Custom Character (Glyph) Cache Implementation
+ *
+ * With 8 slots the lookup is a scan of all of them, and LRU is a request
+ * counter stamped on each slot: the smallest stamp is the least recently
+ * requested glyph. A stamp of 0 marks an empty slot (after power-up the
+ * CGRAM holds nothing known), so empty slots are always used first.
+ */
+
+#include "glyph.h"
+
+// Fixed glyphs, in GlyphId order
+static const unsigned char glyph_table[GLYPH_FIXED_COUNT][GLYPH_ROWS] = {
+    {   // GLYPH_SATELLITE
+        0b00100,
+        0b01110,
+        0b11111,
+        0b01110,
+        0b00100,
+        0b10001,
+        0b01010,
+        0b00100
+    },
+    {   // GLYPH_ROCKET
+        0b00100,
+        0b01110,
+        0b01110,
+        0b01110,
+        0b11111,
+        0b11111,
+        0b01010,
+        0b01010
+    },
+    {   // GLYPH_ANTENNA
+        0b00100,
+        0b00100,
+        0b01110,
+        0b10101,
+        0b00100,
+        0b00100,
+        0b11111,
+        0b00000
+    },
+    {   // GLYPH_RADIO_WAVE
+        0b00001,
+        0b00010,
+        0b00100,
+        0b01000,
+        0b10000,
+        0b01000,
+        0b00100,
+        0b00010
+    },
+    {   // GLYPH_FULL_BLOCK
+        0b11111,
+        0b11111,
+        0b11111,
+        0b11111,
+        0b11111,
+        0b11111,
+        0b11111,
+        0b11111
+    },
+    {   // GLYPH_HEART
+        0b00000,
+        0b01010,
+        0b11111,
+        0b11111,
+        0b01110,
+        0b00100,
+        0b00000,
+        0b00000
+    },
+    {   // GLYPH_SMILE
+        0b00000,
+        0b01010,
+        0b01010,
+        0b00000,
+        0b10001,
+        0b01110,
+        0b00000,
+        0b00000
+    }
+};
+
+// Shown for a run-time glyph that has not been defined yet
+static const unsigned char glyph_blank[GLYPH_ROWS] = { 0 };
+
+// Bitmaps of the run-time glyphs (Glyph_Define)
+static const unsigned char* glyph_defined[GLYPH_COUNT - GLYPH_FIXED_COUNT];
+
+// What each CGRAM slot holds, and when it was last requested (0: empty)
+static GlyphId glyph_slot_id[LCD_CUSTOM_CHARS];
+static unsigned long glyph_slot_stamp[LCD_CUSTOM_CHARS];
+static unsigned long glyph_clock;
+static GlyphStats glyph_stats;
+
+static const unsigned char* Glyph_Rows(GlyphId id) {
+    const unsigned char* rows;
+    
+    if(id < GLYPH_FIXED_COUNT) {
+        return glyph_table[id];
+    }
+    rows = glyph_defined[id - GLYPH_FIXED_COUNT];
+    return rows ? rows : glyph_blank;
+}
+
+unsigned char Glyph_Get(GlyphId id) {
+    int victim = 0;
+    
+    if(id >= GLYPH_COUNT) {
+        return ' ';
+    }
+    for(int slot = 0; slot < LCD_CUSTOM_CHARS; slot++) {
+        if(glyph_slot_stamp[slot] != 0 && glyph_slot_id[slot] == id) {
+            glyph_slot_stamp[slot] = ++glyph_clock;
+            glyph_stats.hits++;
+            return (unsigned char)slot;
+        }
+        if(glyph_slot_stamp[slot] < glyph_slot_stamp[victim]) {
+            victim = slot;
+        }
+    }
+    
+    // Miss: replace the least recently requested glyph
+    LCD_CreateChar((unsigned char)victim, Glyph_Rows(id));
+    glyph_slot_id[victim] = id;
+    glyph_slot_stamp[victim] = ++glyph_clock;
+    glyph_stats.uploads++;
+    return (unsigned char)victim;
+}
+
+void Glyph_Define(GlyphId id, const unsigned char* rows) {
+    if(id < GLYPH_FIXED_COUNT || id >= GLYPH_COUNT) {
+        return;
+    }
+    glyph_defined[id - GLYPH_FIXED_COUNT] = rows;
+    for(int slot = 0; slot < LCD_CUSTOM_CHARS; slot++) {
+        if(glyph_slot_stamp[slot] != 0 && glyph_slot_id[slot] == id) {
+            glyph_slot_stamp[slot] = 0;
+        }
+    }
+}
+
+const GlyphStats* Glyph_GetStats(void) {
+    return &glyph_stats;
+}
@@ -0,0 +1,53 @@
+/*
+ * Custom Character (Glyph) Cache Header
+ *
+ * The LCD has 8 custom character codes (CGRAM slots). Modules ask for a
+ * glyph by ID and draw it with the code they get back; the glyph is only
+ * uploaded (9 LCD writes) if no slot holds it already. Once all 8 slots
+ * are taken, the least recently requested glyph gives up its slot.
+ *
+ * A cell on the LCD shows whatever its slot holds now, so one screen can
+ * show at most 8 different glyphs: asking for a ninth changes the cells
+ * already drawn with the slot it takes.
+ *
+ * Fixed glyphs come from a table in flash (glyph.c). GLYPH_PLOT_0 onwards
+ * are drawn at run time; Glyph_Define gives them their bitmap.
+ */
+
+#ifndef GLYPH_H
+#define GLYPH_H
+
+#include "lcd.h"
+
+#define GLYPH_ROWS              8       // Rows of 5 pixels (bit 4 leftmost)
+
+typedef enum {
+    GLYPH_SATELLITE = 0,
+    GLYPH_ROCKET,
+    GLYPH_ANTENNA,
+    GLYPH_RADIO_WAVE,
+    GLYPH_FULL_BLOCK,
+    GLYPH_HEART,
+    GLYPH_SMILE,
+    GLYPH_FIXED_COUNT,
+    GLYPH_PLOT_0 = GLYPH_FIXED_COUNT,   // Table plot cells 0-7 (Glyph_Define)
+    GLYPH_COUNT = GLYPH_PLOT_0 + LCD_CUSTOM_CHARS
+} GlyphId;
+
+// Character code (0-7) that shows the glyph, uploading it on a miss
+unsigned char Glyph_Get(GlyphId id);
+
+// Give a run-time glyph its bitmap (GLYPH_ROWS rows, kept by pointer,
+// not copied). A slot holding the old bitmap is freed, so the next
+// Glyph_Get uploads the new one.
+void Glyph_Define(GlyphId id, const unsigned char* rows);
+
+// Cache counters
+typedef struct {
+    unsigned long hits;             // Requests answered from a slot
+    unsigned long uploads;          // Requests that sent the glyph to CGRAM
+} GlyphStats;
+
+const GlyphStats* Glyph_GetStats(void);
+
+#endif // GLYPH_H
@@ -0,0 +1,125 @@
+/*
+ * Host Benchmark Build
+ * 
+ * Runs benchmarks from bench.c on a PC, on the same engine code as the
+ * firmware, so a change can be timed without the board. The hardware
+ * bench.c uses is replaced here: the LCD is a 216 text buffer printed
+ * at each result, a key press is not waited for, and the cycle counter
+ * counts nanoseconds of the host's monotonic clock. Figures are
+ * therefore host nanoseconds per call, not Cortex-M4 cycles; compare
+ * them with each other, not with the on-target screens.
+ * 
+ * Build from the project directory (no FPU, so matrix.c and fraction.c
+ * use their plain C versions):
+ *   gcc -std=c99 -O2 -I. -DBENCH_ITERATIONS=100000 host/bench_host.c bench.c
+ *       calculator.c number.c decimal.c numformat.c bignum.c fraction.c
+ *       mathfn.c stats.c solve.c integrate.c table.c matrix.c rf.c
+ *       program.c glyph.c -lm -o bench_host
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include "bench.h"
+#include "lcd.h"
+#include "keypad.h"
+#include "system.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// The LCD: what is on each line, and the cursor
+static char host_screen[LCD_ROWS][LCD_COLUMNS + 1];
+static int host_row;
+static int host_col;
+static LcdStats host_lcd_stats;
+
+void LCD_Init(void) {
+    LCD_Clear();
+}
+
+void LCD_Cmd(unsigned char cmd) {
+    if(cmd == LCD_CLEAR) {
+        memset(host_screen, ' ', sizeof(host_screen));
+        host_screen[0][LCD_COLUMNS] = '\0';
+        host_screen[1][LCD_COLUMNS] = '\0';
+        host_row = 0;
+        host_col = 0;
+    } else if(cmd == LCD_HOME) {
+        host_row = 0;
+        host_col = 0;
+    } else if(cmd & 0x80) {
+        host_row = (cmd & 0x40) ? 1 : 0;
+        host_col = cmd & 0x3F;
+    }
+}
+
+void LCD_Char(unsigned char data) {
+    if(host_col < LCD_COLUMNS) {
+        host_screen[host_row][host_col] = (char)data;
+    }
+    host_col++;
+}
+
+void LCD_String(char* str) {
+    while(*str) {
+        LCD_Char(*str++);
+    }
+}
+
+void LCD_Clear(void) {
+    LCD_Cmd(LCD_CLEAR);
+}
+
+void LCD_SetCursor(unsigned char row, unsigned char col) {
+    LCD_Cmd((row == 0 ? LCD_LINE1 : LCD_LINE2) + col);
+}
+
+void LCD_BeginFrame(void) {
+}
+
+void LCD_EndFrame(void) {
+}
+
+void LCD_Flush(void) {
+}
+
+int LCD_Busy(void) {
+    return 0;
+}
+
+void LCD_Wait(void) {
+}
+
+const LcdStats* LCD_GetStats(void) {
+    return &host_lcd_stats;
+}
+
+void LCD_CreateChar(unsigned char code, const unsigned char* rows) {
+    (void)code;
+    (void)rows;
+}
+
+// Each benchmark screen ends by waiting for a key: print the screen instead
+char WaitForKey(void) {
+    printf("%-16s  %s\n", host_screen[0], host_screen[1]);
+    return KEY_STAR;
+}
+
+void CycleCounter_Init(void) {
+}
+
+unsigned long CycleCounter_Read(void) {
+    struct timespec now;
+    
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long)now.tv_sec * 1000000000UL + (unsigned long)now.tv_nsec;
+}
+
+int main(void) {
+    LCD_Init();
+    
+    Bench_NumberEntry();
+    Bench_Matrix();
+    Bench_Fraction();
+    return 0;
+}
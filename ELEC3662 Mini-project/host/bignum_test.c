@@ -0,0 +1,113 @@
+/*
+ * Host Test of the Arbitrary-Precision Numbers
+ *
+ * Runs bignum.c on a PC with several values live in one arena, the way
+ * bignum mode keeps its sum, pending term and last result. The test
+ * checks that:
+ *   - a division whose divisor has more limbs than the shifted dividend
+ *     gives 0 and leaves the values below it in the arena untouched;
+ *   - quotients keep BIGNUM_DIV_PLACES places, rounded half up, down to
+ *     the smallest (5 / 10^25) and to 0 below it;
+ *   - products, sums and quotients read back as the expected text.
+ *
+ * Build and run from the project directory:
+ *   gcc -std=c99 -I. host/bignum_test.c bignum.c -o bignum_test && ./bignum_test
+ */
+
+#include "bignum.h"
+#include <stdio.h>
+#include <string.h>
+
+static int test_failures;
+static BigArena arena;
+
+static void Test_Check(int condition, const char* what, int index) {
+    if(!condition) {
+        printf("FAIL: %s (case %d)\n", what, index);
+        test_failures++;
+    }
+}
+
+// Display text of value, as the LCD would scroll it
+static const char* Test_Text(const BigNum* value) {
+    static char text[BIGNUM_ARENA_LIMBS * 9 + 4];
+    int length = BigNum_TextLength(&arena, value);
+
+    for(int i = 0; i < length; i++) {
+        text[i] = BigNum_CharAt(&arena, value, i);
+    }
+    text[length] = '\0';
+    return text;
+}
+
+// Copy of a value's text, to compare after later operations
+static void Test_Save(char* saved, const BigNum* value) {
+    strcpy(saved, Test_Text(value));
+}
+
+int main(void) {
+    static char saved[BIGNUM_ARENA_LIMBS * 9 + 4];
+    BigNum x, square, fourth, eighth, small, quotient, three, sum;
+    int status;
+
+    BigArena_Init(&arena);
+
+    // 999999999999999^8: 120 digits, 14 limbs, left live in the arena
+    BigNum_FromInput(&arena, &x, 999999999999999ULL, 0);
+    BigNum_Multiply(&arena, &square, &x, &x);
+    BigNum_Multiply(&arena, &fourth, &square, &square);
+    status = BigNum_Multiply(&arena, &eighth, &fourth, &fourth);
+    Test_Check(status == BIGNUM_OK && eighth.length == 14, "live product", 0);
+    Test_Save(saved, &eighth);
+    int used = arena.used;
+
+    // 2 limbs over 14: the quotient needs fewer than no limbs of room
+    BigNum_FromInput(&arena, &small, 123456789012345ULL, 0);
+    status = BigNum_Divide(&arena, &quotient, &small, &eighth);
+    Test_Check(status == BIGNUM_OK, "small / large status", 1);
+    Test_Check(BigNum_IsZero(&quotient), "small / large is 0", 1);
+    Test_Check(strcmp(Test_Text(&eighth), saved) == 0, "live product intact", 1);
+    Test_Check(arena.used >= used, "arena not moved back over live values", 1);
+
+    // Still usable afterwards: the product plus the small value
+    status = BigNum_Add(&arena, &sum, &eighth, &small);
+    Test_Check(status == BIGNUM_OK && BigNum_TextLength(&arena, &sum) == 120, "sum after divide", 2);
+    Test_Check(strcmp(Test_Text(&eighth), saved) == 0, "live product intact after sum", 2);
+
+    // 1 / 3 to BIGNUM_DIV_PLACES places
+    BigNum one;
+    BigNum_FromInput(&arena, &one, 1, 0);
+    BigNum_FromInput(&arena, &three, 3, 0);
+    status = BigNum_Divide(&arena, &quotient, &one, &three);
+    Test_Check(status == BIGNUM_OK &&
+               strcmp(Test_Text(&quotient), "0.333333333333333333333333") == 0, "1 / 3", 3);
+
+    // 2 / 3 rounds the last place up
+    BigNum two;
+    BigNum_FromInput(&arena, &two, 2, 0);
+    status = BigNum_Divide(&arena, &quotient, &two, &three);
+    Test_Check(status == BIGNUM_OK &&
+               strcmp(Test_Text(&quotient), "0.666666666666666666666667") == 0, "2 / 3", 4);
+
+    // Half a unit in the last place rounds up, less rounds to 0 (through
+    // the division), and a quotient below the extra place is 0 at once
+    BigNum ten13, ten12, ten25, ten26, digit;
+    BigNum_FromInput(&arena, &ten13, 10000000000000ULL, 0);
+    BigNum_FromInput(&arena, &ten12, 1000000000000ULL, 0);
+    BigNum_Multiply(&arena, &ten25, &ten13, &ten12);
+    BigNum_Multiply(&arena, &ten26, &ten13, &ten13);
+    BigNum_FromInput(&arena, &digit, 5, 0);
+    status = BigNum_Divide(&arena, &sum, &digit, &ten25);
+    Test_Check(status == BIGNUM_OK &&
+               strcmp(Test_Text(&sum), "0.000000000000000000000001") == 0, "5 / 10^25 rounds up", 5);
+    BigNum_FromInput(&arena, &digit, 4, 0);
+    status = BigNum_Divide(&arena, &sum, &digit, &ten25);
+    Test_Check(status == BIGNUM_OK && BigNum_IsZero(&sum), "4 / 10^25 is 0", 5);
+    status = BigNum_Divide(&arena, &sum, &one, &ten26);
+    Test_Check(status == BIGNUM_OK && BigNum_IsZero(&sum), "1 / 10^26 is 0", 5);
+
+    Test_Check(strcmp(Test_Text(&eighth), saved) == 0, "live product intact at the end", 6);
+
+    printf("bignum_test: %d limbs used, %d failures\n", arena.used, test_failures);
+    return test_failures != 0;
+}
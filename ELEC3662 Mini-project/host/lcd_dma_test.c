@@ -0,0 +1,139 @@
+/*
+ * Host Test of the LCD Refresh Encoding
+ *
+ * Builds lcd.c's uDMA refresh frame (LCD_DMA_REFRESH) on a PC and plays
+ * it through a model of the HD44780's 4-bit interface, tick by tick, as
+ * the two channels would write it: each tick the nibble (channel 18)
+ * first, then EN and RS (channel 19). The model latches DB4-7 and RS on
+ * each falling edge of EN and pairs the nibbles into bytes. The test
+ * checks that:
+ *   - the frame decodes to both DDRAM addresses and the 32 cells drawn,
+ *     with RS = 0 for the addresses and 1 for the cells;
+ *   - every byte takes LCD_DMA_TICKS_PER_BYTE ticks with two EN pulses;
+ *   - DB4-7 do not change in the tick EN falls (hold time);
+ *   - an EN pulse is at least the 450 ns PW_EH;
+ *   - LCD_DMA_TICK_CYCLES is LCD_EXEC_CYCLES / 4 rounded up, so the gap
+ *     from one byte's last EN fall to the next byte's first EN rise
+ *     covers the execution time.
+ * Only lcd.c's pure encoding functions are called; nothing touches the
+ * hardware registers.
+ *
+ * Build and run from the project directory:
+ *   gcc -std=c99 -I. host/lcd_dma_test.c -o lcd_dma_test && ./lcd_dma_test
+ */
+
+#define LCD_DMA_REFRESH
+
+#include "lcd.c"
+#include <stdio.h>
+
+static int test_failures;
+
+// Delays lcd.c links against; the test never waits on hardware
+void Delay_ms(unsigned long ms) { (void)ms; }
+void Delay_us(unsigned long us) { (void)us; }
+void Delay_cycles(unsigned long cycles) { (void)cycles; }
+
+static void Test_Check(int condition, const char* what, int index) {
+    if(!condition) {
+        printf("FAIL: %s (byte/tick %d)\n", what, index);
+        test_failures++;
+    }
+}
+
+// Expected frame byte: the two DDRAM addresses, then each line's cells
+static unsigned char Test_Expected(int index, const char* lines[LCD_ROWS], int* rs) {
+    int row = index / (LCD_COLUMNS + 1);
+    int col = index % (LCD_COLUMNS + 1) - 1;
+
+    *rs = (col >= 0);
+    if(col < 0) {
+        return row ? LCD_LINE2 : LCD_LINE1;
+    }
+    return (unsigned char)lines[row][col];
+}
+
+int main(void) {
+    const char* lines[LCD_ROWS] = { "0123456789ABCDEF", "Hello, LCD DMA!~" };
+    unsigned char data = 0;         // DB4-7 as the LCD sees them
+    unsigned char ctrl = 0;         // EN and RS
+    unsigned char nibbles[2];
+    int nibble_count = 0;
+    int byte_count = 0;
+    int last_fall = -1;
+
+    // Tick rounding: the 4 ticks from a byte's last EN fall to the next
+    // byte's first EN rise must cover the execution time, and no more
+    // than one cycle per tick is wasted doing so
+    Test_Check(4 * LCD_DMA_TICK_CYCLES >= LCD_EXEC_CYCLES, "4 ticks cover the execution time", 0);
+    Test_Check(4 * (LCD_DMA_TICK_CYCLES - 1) < LCD_EXEC_CYCLES, "tick rounded up, not further", 0);
+    Test_Check(LCD_DMA_TICK_CYCLES >= LCD_EN_PULSE_CYCLES, "EN pulse (one tick) covers PW_EH", 0);
+    Test_Check(LCD_DMA_TICK_CYCLES - 1 <= 0xFFFF, "tick fits a 16-bit timer half", 0);
+
+    // The 8-tick pattern: two EN pulses, the high nibble first
+    int pulses = 0;
+    for(int tick = 0; tick < LCD_DMA_TICKS_PER_BYTE; tick++) {
+        int rising = lcd_dma_en[tick] && (tick == 0 || !lcd_dma_en[tick - 1]);
+        if(rising) {
+            Test_Check(lcd_dma_low[tick] == pulses, "high nibble latched first", tick);
+            pulses++;
+        }
+    }
+    Test_Check(pulses == 2, "two EN pulses per byte", 0);
+    Test_Check(lcd_dma_en[0] == 0 && lcd_dma_en[LCD_DMA_TICKS_PER_BYTE - 1] == 0,
+               "EN low at the ends of a byte", 0);
+
+    // Build the frame and draw the test screen the way LCD_Flush does
+    LCD_DmaBuildFrame();
+    for(int row = 0; row < LCD_ROWS; row++) {
+        for(int col = 0; col < LCD_COLUMNS; col++) {
+            LCD_DmaEncode(LCD_DMA_CELL(row, col), (unsigned char)lines[row][col]);
+        }
+    }
+
+    // Play the frame through the interface model
+    for(int tick = 0; tick < LCD_DMA_TICKS; tick++) {
+        unsigned char next_data = lcd_dma_data[tick] & 0xF0;
+        unsigned char next_ctrl = lcd_dma_ctrl[tick];
+
+        // Channel 18 first: DB4-7 change while EN still has its old level
+        if(ctrl & LCD_EN_PIN) {
+            Test_Check(next_data == data, "data held in the tick EN falls", tick);
+        }
+        data = next_data;
+        
+        // A byte's first EN rise waits for the previous byte to execute
+        if(!(ctrl & LCD_EN_PIN) && (next_ctrl & LCD_EN_PIN) && nibble_count == 0 && last_fall >= 0) {
+            Test_Check((unsigned long)(tick - last_fall) * LCD_DMA_TICK_CYCLES >= LCD_EXEC_CYCLES,
+                       "execution time between bytes", tick);
+        }
+
+        // Then channel 19: a falling EN latches the nibble and RS
+        if((ctrl & LCD_EN_PIN) && !(next_ctrl & LCD_EN_PIN)) {
+            int rs;
+            nibbles[nibble_count++] = data;
+            if(nibble_count == 2) {
+                unsigned char value = (unsigned char)(nibbles[0] | (nibbles[1] >> 4));
+                unsigned char expected = Test_Expected(byte_count, lines, &rs);
+                Test_Check(value == expected, "decoded byte", byte_count);
+                Test_Check(((ctrl & LCD_RS_PIN) != 0) == rs, "RS of the byte", byte_count);
+                Test_Check(tick == byte_count * LCD_DMA_TICKS_PER_BYTE + 5,
+                           "byte ends at its tick 5", byte_count);
+                byte_count++;
+                nibble_count = 0;
+                last_fall = tick;
+            }
+        }
+        if((ctrl ^ next_ctrl) & LCD_RS_PIN) {
+            Test_Check(!(ctrl & LCD_EN_PIN) && !(next_ctrl & LCD_EN_PIN),
+                       "RS changes only while EN is low", tick);
+        }
+        ctrl = next_ctrl;
+    }
+    Test_Check(byte_count == LCD_DMA_BYTES, "bytes in a frame", byte_count);
+    Test_Check(nibble_count == 0, "no stray nibble at the end", nibble_count);
+
+    printf("lcd_dma_test: %d bytes, %d ticks of %d cycles, %d failures\n",
+           byte_count, LCD_DMA_TICKS, (int)LCD_DMA_TICK_CYCLES, test_failures);
+    return test_failures != 0;
+}
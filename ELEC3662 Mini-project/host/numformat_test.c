@@ -0,0 +1,79 @@
+/*
+ * Host Test of the Number Layout
+ *
+ * Runs numformat.c's NumFormat_Layout and NumFormat_Float on a PC and
+ * compares the text with what the 16-column LCD line should show. The
+ * cases cover:
+ *   - fixed notation, with surplus fraction digits rounded off;
+ *   - the switch to d.dddEnn when the integer part does not fit;
+ *   - rounding that carries into the exponent, including 9.99E+99 to
+ *     1E+100 (the decimal backend reaches it at DECIMAL_EMAX), which needs
+ *     a third exponent digit;
+ *   - exponents that already have three digits before rounding.
+ *
+ * Build and run from the project directory:
+ *   gcc -std=c99 -I. host/numformat_test.c -o numformat_test && ./numformat_test
+ */
+
+#include "numformat.c"
+#include <stdio.h>
+
+static int test_failures;
+
+static void Test_Check(int condition, const char* what, int index) {
+    if(!condition) {
+        printf("FAIL: %s (case %d)\n", what, index);
+        test_failures++;
+    }
+}
+
+typedef struct {
+    const char* digits;             // d.ddd, no sign
+    int negative;
+    int exponent;                   // of the first digit
+    const char* expected;
+} LayoutCase;
+
+static const LayoutCase layout_cases[] = {
+    { "12345",            0,    2, "123.45"           },
+    { "5",                1,   -4, "-0.0005"          },
+    { "123456789012345",  0,    6, "1234567.89012345" },
+    { "999999999999999",  0,   14, "999999999999999"  },
+    { "999999999999999",  0,   16, "1E+17"            },
+    { "12345",            0,   20, "1.2345E+20"       },
+    { "123456789012345",  1,  -20, "-1.23456789E-20"  },
+    { "999999999999999",  0,   99, "1E+100"           },
+    { "999999999999999",  1,   99, "-1E+100"          },
+    { "999999999999999",  0,  -100, "1E-99"           },
+    { "12345",            0,  105, "1.2345E+105"      },
+    { "123456789012345",  1, -105, "-1.23456789E-105" },
+};
+
+int main(void) {
+    char buffer[LCD_COLUMNS + 1];
+    char digits[20];
+    int count = (int)(sizeof(layout_cases) / sizeof(layout_cases[0]));
+
+    for(int i = 0; i < count; i++) {
+        const LayoutCase* c = &layout_cases[i];
+        int length = (int)strlen(c->digits);
+        memcpy(digits, c->digits, length);
+        NumFormat_Layout(buffer, sizeof(buffer), c->negative, digits, length, c->exponent);
+        if(strcmp(buffer, c->expected) != 0) {
+            printf("  got \"%s\", expected \"%s\"\n", buffer, c->expected);
+        }
+        Test_Check(strcmp(buffer, c->expected) == 0, "layout", i);
+        Test_Check((int)strlen(buffer) <= LCD_COLUMNS, "fits the line", i);
+    }
+
+    // The float path through the same layout
+    NumFormat_Float(buffer, 0.1f, sizeof(buffer));
+    Test_Check(strcmp(buffer, "0.1") == 0, "float 0.1", 0);
+    NumFormat_Float(buffer, -3.4028235e38f, sizeof(buffer));
+    Test_Check(strcmp(buffer, "-3.4028235E+38") == 0, "float -FLT_MAX", 0);
+    NumFormat_Float(buffer, 1e-45f, sizeof(buffer));
+    Test_Check(strcmp(buffer, "1E-45") == 0, "float smallest subnormal", 0);
+
+    printf("numformat_test: %d layouts, %d failures\n", count, test_failures);
+    return test_failures != 0;
+}
@@ -0,0 +1,135 @@
+/*
+ * Definite Integration Implementation
+ *
+ * Gauss-Kronrod G7/K15 nodes and weights on [-1, 1] (the nodes are
+ * symmetric, so only the positive half is stored). Odd-numbered Kronrod
+ * nodes are the Gauss nodes.
+ */
+
+#include "integrate.h"
+#include <float.h>
+
+#define KRONROD_POINTS      8
+
+static const float kronrod_node[KRONROD_POINTS] = {
+    0.991455371120812639f, 0.949107912342758525f, 0.864864423359769073f,
+    0.741531185599394440f, 0.586087235467691130f, 0.405845151377397167f,
+    0.207784955007898468f, 0.0f
+};
+static const float kronrod_weight[KRONROD_POINTS] = {
+    0.022935322010529225f, 0.063092092629978553f, 0.104790010322250184f,
+    0.140653259715525919f, 0.169004726639267903f, 0.190350578064785410f,
+    0.204432940075298892f, 0.209482141084727828f
+};
+static const float gauss_weight[KRONROD_POINTS / 2] = {
+    0.129484966168869693f, 0.279705391489276668f, 0.381830050505118945f,
+    0.417959183673469388f
+};
+
+// An error estimate below this fraction of the integral of |f| is float
+// rounding in the 15 evaluations, not quadrature error
+#define INTEGRATE_ROUNDING  (16.0f * FLT_EPSILON)
+
+static float Integrate_Abs(float value) {
+    return (value < 0.0f) ? -value : value;
+}
+
+// Apply G7/K15 to [a, b] (15 evaluations). Returns 0 if f is undefined at
+// one of the nodes.
+static int Integrate_Rule(const SolveProgram* program, float a, float b,
+                          IntegrateInterval* interval) {
+    float center = 0.5f * (a + b);
+    float half = 0.5f * (b - a);
+    float f = Solve_Evaluate(program, center, 0);
+    float kronrod = f * kronrod_weight[KRONROD_POINTS - 1];
+    float gauss = f * gauss_weight[KRONROD_POINTS / 2 - 1];
+    float absolute = Integrate_Abs(f) * kronrod_weight[KRONROD_POINTS - 1];
+
+    for(int i = 0; i < KRONROD_POINTS - 1; i++) {
+        float offset = half * kronrod_node[i];
+        float left = Solve_Evaluate(program, center - offset, 0);
+        float right = Solve_Evaluate(program, center + offset, 0);
+        kronrod += kronrod_weight[i] * (left + right);
+        absolute += kronrod_weight[i] * (Integrate_Abs(left) + Integrate_Abs(right));
+        if(i & 1) {
+            gauss += gauss_weight[i / 2] * (left + right);
+        }
+    }
+
+    interval->a = a;
+    interval->b = b;
+    interval->value = kronrod * half;
+    interval->error = Integrate_Abs((kronrod - gauss) * half);
+    interval->absolute = absolute * Integrate_Abs(half);
+    // Inf or NaN anywhere has reached the sums
+    return interval->absolute - interval->absolute == 0.0f;
+}
+
+void Integrate_Run(const SolveProgram* program, float a, float b,
+                   IntegrateStack* stack, IntegrateResult* result) {
+    float range = Integrate_Abs(b - a);
+    float tolerance;
+    int   cut_short = 0;
+
+    result->status = INTEGRATE_OK;
+    result->value = 0.0f;
+    result->error = 0.0f;
+    result->intervals = 0;
+    result->evaluations = 0;
+    if(range == 0.0f) {
+        return;
+    }
+
+    stack->count = 0;
+    result->evaluations = 2 * KRONROD_POINTS - 1;
+    if(!Integrate_Rule(program, a, b, &stack->interval[0])) {
+        result->status = INTEGRATE_UNDEFINED;
+        return;
+    }
+    stack->count = 1;
+    tolerance = INTEGRATE_TOLERANCE * stack->interval[0].absolute;
+
+    while(stack->count > 0) {
+        IntegrateInterval* top = &stack->interval[stack->count - 1];
+        float middle = 0.5f * (top->a + top->b);
+
+        // Accept an interval whose error is within its share of the
+        // tolerance (in proportion to its width), or down to rounding
+        int accept = top->error <= tolerance * (Integrate_Abs(top->b - top->a) / range) ||
+                     top->error <= INTEGRATE_ROUNDING * top->absolute;
+
+        // Otherwise halve it, unless the stack or the evaluations have run
+        // out, or it is too narrow to halve in float
+        if(!accept && (stack->count == INTEGRATE_STACK_SIZE ||
+                       result->evaluations + 2 * (2 * KRONROD_POINTS - 1) > INTEGRATE_MAX_EVALUATIONS ||
+                       middle == top->a || middle == top->b)) {
+            accept = 1;
+            cut_short = 1;
+        }
+
+        if(accept) {
+            result->value += top->value;
+            result->error += top->error;
+            result->intervals++;
+            stack->count--;
+            continue;
+        }
+
+        // Replace it with its halves, the left half on top
+        float left = top->a;
+        float right = top->b;
+        result->evaluations += 2 * (2 * KRONROD_POINTS - 1);
+        if(!Integrate_Rule(program, middle, right, top) ||
+           !Integrate_Rule(program, left, middle, &stack->interval[stack->count])) {
+            result->status = INTEGRATE_UNDEFINED;
+            return;
+        }
+        stack->count++;
+    }
+
+    // Intervals accepted early can still add up to the tolerance (an
+    // integrable singularity such as ln(X) at 0 often does)
+    if(cut_short && result->error > tolerance) {
+        result->status = INTEGRATE_INACCURATE;
+    }
+}
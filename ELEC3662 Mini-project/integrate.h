@@ -0,0 +1,70 @@
+/*
+ * Definite Integration Header
+ *
+ * Integrates an expression in X, compiled to a SolveProgram (solve.h), from
+ * a to b by adaptive Gauss-Kronrod quadrature. Each interval is integrated
+ * with the 15-point Kronrod rule; the 7-point Gauss rule embedded in it
+ * reuses every other node, so |K15 - G7| estimates the error for free. An
+ * interval whose error is above its share of the tolerance is halved and
+ * both halves go on a fixed-size interval stack, so the work goes where f
+ * is hardest to integrate.
+ *
+ * No memory is allocated: the interval stack is passed in (it is kept in
+ * the calculator context, off the small startup stack) and each evaluation
+ * is one pass of the program interpreter.
+ */
+
+#ifndef INTEGRATE_H
+#define INTEGRATE_H
+
+#include "solve.h"
+
+// Intervals waiting on the stack. Halving goes depth first, so this is
+// also the number of times an interval can be halved (2^-23 of the range
+// is about float resolution).
+#define INTEGRATE_STACK_SIZE        24
+
+// Evaluations per integral (15 per interval, so about 130 intervals).
+// Each one is a single pass over the program, a few hundred to a few
+// thousand cycles.
+#ifndef INTEGRATE_MAX_EVALUATIONS
+#define INTEGRATE_MAX_EVALUATIONS   2000
+#endif
+
+// Target error, relative to the integral of |f| over the range
+#ifndef INTEGRATE_TOLERANCE
+#define INTEGRATE_TOLERANCE         1.0e-6f
+#endif
+
+typedef struct {
+    float a;
+    float b;
+    float value;                    // K15 estimate over [a, b]
+    float error;                    // |K15 - G7|
+    float absolute;                 // K15 estimate of the integral of |f|
+} IntegrateInterval;
+
+typedef struct {
+    IntegrateInterval interval[INTEGRATE_STACK_SIZE];
+    int count;
+} IntegrateStack;
+
+typedef enum {
+    INTEGRATE_OK = 0,               // Error estimate within the tolerance
+    INTEGRATE_INACCURATE,           // Stack or evaluations ran out with the error still above it
+    INTEGRATE_UNDEFINED             // f is not defined somewhere in the range
+} IntegrateStatus;
+
+typedef struct {
+    IntegrateStatus status;
+    float value;
+    float error;                    // Sum of the intervals' error estimates
+    int   intervals;                // Intervals the range ended up split into
+    int   evaluations;
+} IntegrateResult;
+
+// Integral of the program's f(X) from a to b (b < a gives the negative)
+void Integrate_Run(const SolveProgram* program, float a, float b,
+                   IntegrateStack* stack, IntegrateResult* result);
+
+#endif // INTEGRATE_H
@@ -36,11 +36,11 @@ void Keypad_Init(void) {
 
 char ReadKey(void) {
     unsigned char pe_val;
-    unsigned char pb_current;
     
+    // The columns are written through their masked address, so the LCD
+    // bits on PB4-7 (driven from the LCD interrupt) are never touched
     // Scan Column 0 (PB0)
-    pb_current = GPIO_PORTB_DATA_R & 0xF0;  // Save LCD bits (PB4-7)
-    GPIO_PORTB_DATA_R = pb_current | 0x01;   // Set PB0 HIGH
+    KEYPAD_COL_R = 0x01;   // Set PB0 HIGH
     Delay_ms(5);
     pe_val = GPIO_PORTE_DATA_R & 0x0F;
     if(pe_val == 0x01) return '1';
@@ -49,8 +49,7 @@ char ReadKey(void) {
     if(pe_val == 0x08) return '*';
     
     // Scan Column 1 (PB1)
-    pb_current = GPIO_PORTB_DATA_R & 0xF0;
-    GPIO_PORTB_DATA_R = pb_current | 0x02;   // Set PB1 HIGH
+    KEYPAD_COL_R = 0x02;   // Set PB1 HIGH
     Delay_ms(5);
     pe_val = GPIO_PORTE_DATA_R & 0x0F;
     if(pe_val == 0x01) return '2';
@@ -59,8 +58,7 @@ char ReadKey(void) {
     if(pe_val == 0x08) return '0';
     
     // Scan Column 2 (PB2)
-    pb_current = GPIO_PORTB_DATA_R & 0xF0;
-    GPIO_PORTB_DATA_R = pb_current | 0x04;   // Set PB2 HIGH
+    KEYPAD_COL_R = 0x04;   // Set PB2 HIGH
     Delay_ms(5);
     pe_val = GPIO_PORTE_DATA_R & 0x0F;
     if(pe_val == 0x01) return '3';
@@ -69,8 +67,7 @@ char ReadKey(void) {
     if(pe_val == 0x08) return '#';
     
     // Scan Column 3 (PB3)
-    pb_current = GPIO_PORTB_DATA_R & 0xF0;
-    GPIO_PORTB_DATA_R = pb_current | 0x08;   // Set PB3 HIGH
+    KEYPAD_COL_R = 0x08;   // Set PB3 HIGH
     Delay_ms(5);
     pe_val = GPIO_PORTE_DATA_R & 0x0F;
     if(pe_val == 0x01) return 'A';
@@ -79,7 +76,7 @@ char ReadKey(void) {
     if(pe_val == 0x08) return 'D';
     
     // Clear all column outputs (PB0-3)
-    GPIO_PORTB_DATA_R = GPIO_PORTB_DATA_R & 0xF0;
+    KEYPAD_COL_R = 0x00;
     
     return 0;  // No key pressed
 }
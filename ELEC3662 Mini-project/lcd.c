@@ -5,46 +5,512 @@
  *   PA2 = EN (Enable)
  *   PA3 = RS (Register Select)
  *   PB4-7 = DB4-7 (LCD Data)
+ * 
+ * R/W is tied low, so the busy flag cannot be read: every write waits the
+ * HD44780 datasheet time for its instruction instead (fosc = 270 kHz). A
+ * character costs about 42 us rather than the 4 ms of fixed millisecond
+ * delays, so a full 32-character repaint takes about 1.4 ms.
+ * 
+ * Nobody waits those times out. Commands and data go into a ring that
+ * Timer 1A drains in the background: its interrupt puts out the high
+ * nibble, then (1 us later) the low nibble, then sleeps for the
+ * instruction's execution time before the next byte. The ring has one
+ * writer (the main program, which only moves lcd_queue_head) and one
+ * reader (the interrupt, which only moves lcd_queue_tail), so neither side
+ * needs to mask interrupts. Only a full ring makes the caller wait.
+ * 
+ * With LCD_DMA_REFRESH defined, the text is not sent through the ring at
+ * all. The uDMA streams the whole screen to the LCD over and over from a
+ * refresh frame: both DDRAM addresses and all 32 cells, each byte already
+ * encoded as the PB4-7 and PA2-3 (EN, RS) levels of its 8 timer ticks.
+ * Timer 0A and 0B tick together, one byte each per tick: channel 18
+ * writes the nibbles, channel 19 then the control lines, both through
+ * masked data addresses. Drawing a cell re-encodes its 8 nibble bytes;
+ * the only CPU time is one interrupt per frame (about 2.8 ms) to restart
+ * the channels. Other commands still go through the ring, which takes
+ * the bus between frames.
+ * 
+ * The shadow holds what the LCD shows (lcd_shown) and what is being drawn
+ * (lcd_frame). A flush walks both, sends one DDRAM address and then the
+ * run of cells for each stretch of changes, and skips the address when
+ * the LCD's address counter is already there. A gap of one unchanged cell
+ * is written rather than skipped: one data byte costs the same as the
+ * address command it saves.
  */
 
 #include "lcd.h"
 #include "pin_definitions.h"
 #include "system.h"
 
-void LCD_Cmd(unsigned char cmd) {
-    GPIO_PORTA_DATA_R &= ~0x08;  // RS = 0 for command
+// Bus timing (datasheet minimums, rounded up to core cycles)
+#define LCD_EN_PULSE_CYCLES     SYSTEM_NS_TO_CYCLES(450UL)     // PW_EH: EN high
+#define LCD_EN_CYCLE_CYCLES     SYSTEM_NS_TO_CYCLES(550UL)     // tcycE - PW_EH: EN low before the next pulse
+
+// Execution times. The address counter is updated 4 us (tADD) after the
+// instruction completes, so data writes and address sets wait for it too.
+#define LCD_EXEC_CYCLES         SYSTEM_US_TO_CYCLES(37UL + 4UL)
+#define LCD_CLEAR_CYCLES        SYSTEM_US_TO_CYCLES(1520UL)
+
+// Execution time of each command, by its highest set bit (the HD44780
+// decodes instructions that way): clear and return home take 1.52 ms,
+// entry mode, display control, shift, function set and the CGRAM and
+// DDRAM address sets 37 us
+static const unsigned long lcd_command_cycles[8] = {
+    LCD_CLEAR_CYCLES,               // 0x01 Clear display
+    LCD_CLEAR_CYCLES,               // 0x02 Return home
+    LCD_EXEC_CYCLES,                // 0x04 Entry mode set
+    LCD_EXEC_CYCLES,                // 0x08 Display on/off control
+    LCD_EXEC_CYCLES,                // 0x10 Cursor or display shift
+    LCD_EXEC_CYCLES,                // 0x20 Function set
+    LCD_EXEC_CYCLES,                // 0x40 Set CGRAM address
+    LCD_EXEC_CYCLES                 // 0x80 Set DDRAM address
+};
+
+// Write queue entries (a power of two): enough for a full repaint and a
+// custom character set (72 bytes) without waiting
+#ifndef LCD_QUEUE_SIZE
+#define LCD_QUEUE_SIZE          128
+#endif
+
+// Timer 1A interrupt priority (0 highest, 7 lowest)
+#define LCD_IRQ_PRIORITY        2UL
+
+// Unchanged cells a run of changes is extended over (see above)
+#define LCD_FLUSH_GAP           1
+
+#define LCD_DDRAM_LINE2         0x40    // DDRAM address of line 2
+#define LCD_ADDRESS_UNKNOWN     -1      // The address counter is in CGRAM
+
+// Shadow DDRAM: what the LCD shows and the frame being drawn, with the
+// frame's cursor (the column counts on past the edge, as DDRAM does)
+static unsigned char lcd_shown[LCD_ROWS][LCD_COLUMNS];
+static unsigned char lcd_frame[LCD_ROWS][LCD_COLUMNS];
+static int lcd_row;
+static int lcd_col;
+static int lcd_dirty;               // 1 if lcd_frame may differ from lcd_shown
+static int lcd_frame_depth;         // Open LCD_BeginFrame calls
+static int lcd_address;             // LCD's DDRAM address counter, or LCD_ADDRESS_UNKNOWN
+static int lcd_cgram;               // 1 after a raw CGRAM address: LCD_Char writes CGRAM
+static int lcd_shifted;             // 1 once the display has been shifted (scrolled)
+static LcdStats lcd_stats;
+
+// Write queue (see above). The indices run freely; an entry is
+// lcd_queue[index & (LCD_QUEUE_SIZE - 1)], and head - tail is the count.
+#define LCD_QUEUE_DATA          0x100   // Entry flag: RS = 1
+static volatile unsigned short lcd_queue[LCD_QUEUE_SIZE];
+static volatile unsigned int lcd_queue_head;    // Written by the caller only
+static volatile unsigned int lcd_queue_tail;    // Written by the interrupt only
+static volatile int lcd_queue_running;          // 1 until the interrupt finds the ring empty
+
+// Interrupt state: the byte being sent, and 1 if its low nibble is next
+static unsigned short lcd_isr_entry;
+static int lcd_isr_low;
+
+#ifdef LCD_DMA_REFRESH
+// Refresh frame: the line 1 address and its cells, then line 2's
+#define LCD_DMA_BYTES           (LCD_ROWS * (LCD_COLUMNS + 1))
+#define LCD_DMA_CELL(row, col)  ((row) * (LCD_COLUMNS + 1) + 1 + (col))
+
+// Each byte takes 8 ticks: the high nibble latched by EN at tick 1-2,
+// the low nibble at tick 4-5. The data never changes in the tick EN
+// falls, and the 4 ticks from the last fall to the next byte's first rise
+// cover the 41 us execution time.
+#define LCD_DMA_TICKS_PER_BYTE  8
+#define LCD_DMA_TICKS           (LCD_DMA_BYTES * LCD_DMA_TICKS_PER_BYTE)
+#define LCD_DMA_TICK_CYCLES     ((LCD_EXEC_CYCLES + 3) / 4)
+
+static const unsigned char lcd_dma_en[LCD_DMA_TICKS_PER_BYTE] = {
+    0, LCD_EN_PIN, 0, 0, LCD_EN_PIN, 0, 0, 0
+};
+static const unsigned char lcd_dma_low[LCD_DMA_TICKS_PER_BYTE] = {
+    0, 0, 0, 1, 1, 1, 1, 1          // 1 where the low nibble is on DB4-7
+};
+
+// uDMA channels 18 and 19 (encoding 0: Timer 0A and 0B); the lower
+// number is served first within a tick
+#define LCD_DMA_DATA_CHANNEL    18
+#define LCD_DMA_CTRL_CHANNEL    19
+#define LCD_DMA_CHANNELS        ((1UL << LCD_DMA_DATA_CHANNEL) | (1UL << LCD_DMA_CTRL_CHANNEL))
+
+// Channel control word: byte source stepping through the frame, byte
+// destination fixed, one transfer per request, basic mode
+#define LCD_DMA_CONTROL         (0xC0000000UL | ((LCD_DMA_TICKS - 1UL) << 4) | 0x01UL)
+
+// The encoded frame (DB4-7 and EN/RS per tick), and the uDMA control
+// table (primary structures only: source end, destination end, control,
+// unused), which must be 1024-byte aligned
+static unsigned char lcd_dma_data[LCD_DMA_TICKS];
+static unsigned char lcd_dma_ctrl[LCD_DMA_TICKS];
+static volatile unsigned long lcd_dma_table[128] __attribute__((aligned(1024)));
+static volatile unsigned long lcd_dma_frames;   // Frames completed
+#endif
+
+// Latch the upper 4 bits of value on DB4-7 with one EN pulse. The masked
+// data addresses leave the keypad columns on PB0-3 alone. The port writes
+// before EN rises give far more than the 40 ns RS and 80 ns data setup
+// times.
+static void LCD_Nibble(unsigned char value) {
+    LCD_DATA_R = value;
+    LCD_EN_R = LCD_EN_PIN;
+    Delay_cycles(LCD_EN_PULSE_CYCLES);
+    LCD_EN_R = 0;
+}
+
+// Execution time of a queue entry
+static unsigned long LCD_ExecCycles(unsigned short entry) {
+    int bit = 7;
     
-    // Send high nibble
-    GPIO_PORTB_DATA_R = (GPIO_PORTB_DATA_R & 0x0F) | (cmd & 0xF0);
-    GPIO_PORTA_DATA_R |= 0x04;   // EN = 1
-    Delay_ms(1);
-    GPIO_PORTA_DATA_R &= ~0x04;  // EN = 0
+    if(entry & LCD_QUEUE_DATA) {
+        return LCD_EXEC_CYCLES;
+    }
+    while(bit > 0 && (entry & (1 << bit)) == 0) {
+        bit--;
+    }
+    return lcd_command_cycles[bit];
+}
+
+// Run Timer 1A once for this many cycles; its interrupt comes at the end
+static void LCD_TimerStart(unsigned long cycles) {
+    TIMER1_TAILR_R = cycles - 1;
+    TIMER1_CTL_R = 0x01;            // TAEN (cleared by the timeout)
+}
+
+#ifdef LCD_DMA_REFRESH
+// Encode one byte of the refresh frame onto its ticks' DB4-7 levels
+static void LCD_DmaEncode(int index, unsigned char value) {
+    unsigned char* data = &lcd_dma_data[index * LCD_DMA_TICKS_PER_BYTE];
     
-    // Send low nibble
-    GPIO_PORTB_DATA_R = (GPIO_PORTB_DATA_R & 0x0F) | ((cmd << 4) & 0xF0);
-    GPIO_PORTA_DATA_R |= 0x04;   // EN = 1
-    Delay_ms(1);
-    GPIO_PORTA_DATA_R &= ~0x04;  // EN = 0
+    for(int tick = 0; tick < LCD_DMA_TICKS_PER_BYTE; tick++) {
+        data[tick] = lcd_dma_low[tick] ? (unsigned char)(value << 4) : (unsigned char)(value & 0xF0);
+    }
+}
+
+// Send the refresh frame once: reload both channels, then start both
+// timer halves with one write so their ticks stay together
+static void LCD_DmaStart(void) {
+    lcd_dma_table[LCD_DMA_DATA_CHANNEL * 4 + 2] = LCD_DMA_CONTROL;
+    lcd_dma_table[LCD_DMA_CTRL_CHANNEL * 4 + 2] = LCD_DMA_CONTROL;
+    UDMA_ENASET_R = LCD_DMA_CHANNELS;
+    TIMER0_CTL_R = 0x0101;          // TAEN | TBEN
+}
+
+// Frame done: hand the bus to the queue if it has commands, else refresh
+// again. A uDMA channel's completion interrupt is raised on the vector of
+// the peripheral that requests it, with no GPTMIMR mask bit, and latched
+// per channel in DMACHIS, which the handler clears (TM4C123GH6PM
+// datasheet, 9.2.10 "Interrupts and Errors"). Channel 19's comes here;
+// channel 18's would come on Timer 0A, which is not enabled in the NVIC.
+void TIMER0B_Handler(void) {
+    unsigned long done = UDMA_CHIS_R & LCD_DMA_CHANNELS;
     
-    Delay_ms(2);
+    UDMA_CHIS_R = done;             // Write 1 to clear
+    TIMER0_ICR_R = 0x0101;          // Timeouts (raw only: IMR is 0)
+    if((done & (1UL << LCD_DMA_CTRL_CHANNEL)) == 0) {
+        return;                     // Not the end of a frame
+    }
+    TIMER0_CTL_R = 0x00;            // Both halves stop on the same count
+    lcd_dma_frames++;
+    if(lcd_queue_tail != lcd_queue_head) {
+        // The last cell's EN fell only 2 ticks ago: let it execute first
+        LCD_TimerStart(LCD_EXEC_CYCLES);
+        return;
+    }
+    LCD_DmaStart();
 }
 
-void LCD_Char(unsigned char data) {
-    GPIO_PORTA_DATA_R |= 0x08;  // RS = 1 for data
+// Build the refresh frame: both DDRAM addresses and a blank screen, with
+// RS and the EN pulses of every tick
+static void LCD_DmaBuildFrame(void) {
+    for(int index = 0; index < LCD_DMA_BYTES; index++) {
+        // RS = 0 for the two address bytes, 1 for the cells
+        unsigned char rs = (index % (LCD_COLUMNS + 1)) ? LCD_RS_PIN : 0;
+        for(int tick = 0; tick < LCD_DMA_TICKS_PER_BYTE; tick++) {
+            lcd_dma_ctrl[index * LCD_DMA_TICKS_PER_BYTE + tick] = rs | lcd_dma_en[tick];
+        }
+        LCD_DmaEncode(index, ' ');
+    }
+    LCD_DmaEncode(LCD_DMA_CELL(0, -1), LCD_LINE1);
+    LCD_DmaEncode(LCD_DMA_CELL(1, -1), LCD_LINE2);
+}
+
+// Build the refresh frame and set up Timer 0 and the uDMA. Nothing moves
+// until LCD_DmaStart.
+static void LCD_DmaInit(void) {
+    volatile unsigned long delay;
     
-    // Send high nibble
-    GPIO_PORTB_DATA_R = (GPIO_PORTB_DATA_R & 0x0F) | (data & 0xF0);
-    GPIO_PORTA_DATA_R |= 0x04;   // EN = 1
-    Delay_ms(1);
-    GPIO_PORTA_DATA_R &= ~0x04;  // EN = 0
+    LCD_DmaBuildFrame();
+    lcd_dma_frames = 0;
+    UDMA_CHIS_R = LCD_DMA_CHANNELS;
     
-    // Send low nibble
-    GPIO_PORTB_DATA_R = (GPIO_PORTB_DATA_R & 0x0F) | ((data << 4) & 0xF0);
-    GPIO_PORTA_DATA_R |= 0x04;   // EN = 1
-    Delay_ms(1);
-    GPIO_PORTA_DATA_R &= ~0x04;  // EN = 0
+    // Timer 0: two 16-bit periodic halves with the same tick, requesting
+    // a uDMA transfer on each timeout (no CPU interrupt)
+    SYSCTL_RCGCTIMER_R |= 0x01;
+    delay = SYSCTL_RCGCTIMER_R;
+    TIMER0_CTL_R = 0x00;
+    TIMER0_CFG_R = 0x04;
+    TIMER0_TAMR_R = 0x02;
+    TIMER0_TBMR_R = 0x02;
+    TIMER0_TAILR_R = LCD_DMA_TICK_CYCLES - 1;
+    TIMER0_TBILR_R = LCD_DMA_TICK_CYCLES - 1;
+    TIMER0_IMR_R = 0x00;
     
-    Delay_ms(2);
+    // uDMA: channel 18 writes DB4-7, channel 19 EN and RS
+    SYSCTL_RCGCDMA_R |= 0x01;
+    delay = SYSCTL_RCGCDMA_R;
+    UDMA_CFG_R = 0x01;              // MASTEN
+    UDMA_CTLBASE_R = (unsigned long)lcd_dma_table;
+    UDMA_CHMAP2_R &= ~0x0000FF00UL;
+    UDMA_ALTCLR_R = LCD_DMA_CHANNELS;
+    UDMA_USEBURSTCLR_R = LCD_DMA_CHANNELS;
+    UDMA_REQMASKCLR_R = LCD_DMA_CHANNELS;
+    UDMA_PRIOCLR_R = LCD_DMA_CHANNELS;
+    lcd_dma_table[LCD_DMA_DATA_CHANNEL * 4 + 0] = (unsigned long)&lcd_dma_data[LCD_DMA_TICKS - 1];
+    lcd_dma_table[LCD_DMA_DATA_CHANNEL * 4 + 1] = (unsigned long)&LCD_DATA_R;
+    lcd_dma_table[LCD_DMA_CTRL_CHANNEL * 4 + 0] = (unsigned long)&lcd_dma_ctrl[LCD_DMA_TICKS - 1];
+    lcd_dma_table[LCD_DMA_CTRL_CHANNEL * 4 + 1] = (unsigned long)&LCD_CTRL_R;
+    
+    NVIC_PRI5_R = (NVIC_PRI5_R & 0xFFFFFF1F) | (LCD_IRQ_PRIORITY << 5);
+    NVIC_EN0_R = NVIC_TIMER0B_BIT;
+}
+#endif
+
+// Drain the queue: one nibble per interrupt, then the execution wait
+void TIMER1A_Handler(void) {
+    TIMER1_ICR_R = 0x01;            // Acknowledge the timeout
+    
+    if(lcd_isr_low) {
+        // Second half of the byte, then let the LCD execute it
+        LCD_Nibble((unsigned char)(lcd_isr_entry << 4));
+        lcd_isr_low = 0;
+        LCD_TimerStart(LCD_ExecCycles(lcd_isr_entry));
+        return;
+    }
+    if(lcd_queue_tail == lcd_queue_head) {
+        // The last byte has executed
+        lcd_queue_running = 0;
+#ifdef LCD_DMA_REFRESH
+        LCD_DmaStart();             // Back to refreshing
+#endif
+        return;
+    }
+    lcd_isr_entry = lcd_queue[lcd_queue_tail & (LCD_QUEUE_SIZE - 1)];
+    lcd_queue_tail++;
+    LCD_RS_R = (lcd_isr_entry & LCD_QUEUE_DATA) ? LCD_RS_PIN : 0;
+    LCD_Nibble((unsigned char)lcd_isr_entry);
+    lcd_isr_low = 1;
+    LCD_TimerStart(LCD_EN_CYCLE_CYCLES);
+}
+
+// Queue a byte for the LCD (LCD_QUEUE_DATA set for data, clear for a
+// command). Waits only while the ring is full.
+static void LCD_Queue(unsigned short entry) {
+    unsigned int used = lcd_queue_head - lcd_queue_tail;
+    
+    if(used == LCD_QUEUE_SIZE) {
+        lcd_stats.queue_stalls++;
+        while(lcd_queue_head - lcd_queue_tail == LCD_QUEUE_SIZE) {
+        }
+    }
+    lcd_queue[lcd_queue_head & (LCD_QUEUE_SIZE - 1)] = entry;
+    lcd_queue_head++;               // Publishes the entry to the interrupt
+    
+    used = lcd_queue_head - lcd_queue_tail;
+    if(used > lcd_stats.queue_peak) {
+        lcd_stats.queue_peak = used;
+    }
+    // An idle interrupt is not coming back by itself: set it pending. It
+    // only goes idle when it finds the ring empty, which cannot happen
+    // between the push above and this test while it is still running.
+    // (Refreshing, the end of the frame starts it instead.)
+    if(!lcd_queue_running) {
+        lcd_queue_running = 1;
+#ifndef LCD_DMA_REFRESH
+        NVIC_PEND0_R = NVIC_TIMER1A_BIT;
+#endif
+    }
+}
+
+// Send a command to the LCD itself
+static void LCD_SendCmd(unsigned char cmd) {
+    LCD_Queue(cmd);
+}
+
+// Send a data byte to the LCD itself
+static void LCD_SendData(unsigned char data) {
+    LCD_Queue(LCD_QUEUE_DATA | data);
+}
+
+int LCD_Busy(void) {
+    return lcd_queue_running;
+}
+
+void LCD_Wait(void) {
+    while(lcd_queue_running) {
+    }
+#ifdef LCD_DMA_REFRESH
+    // Then a whole frame sent after this call
+    unsigned long frames = lcd_dma_frames;
+    while(lcd_dma_frames - frames < 2) {
+    }
+#endif
+}
+
+// Outside a frame, show what has just been drawn
+static void LCD_Show(void) {
+    if(lcd_frame_depth == 0) {
+        LCD_Flush();
+    }
+}
+
+void LCD_Flush(void) {
+    unsigned long bytes = 0;
+    
+    if(!lcd_dirty) {
+        lcd_stats.skipped++;
+        return;
+    }
+#ifdef LCD_DMA_REFRESH
+    // The refresh sends every cell anyway: only re-encode the changed ones
+    for(int row = 0; row < LCD_ROWS; row++) {
+        for(int col = 0; col < LCD_COLUMNS; col++) {
+            if(lcd_frame[row][col] != lcd_shown[row][col]) {
+                LCD_DmaEncode(LCD_DMA_CELL(row, col), lcd_frame[row][col]);
+                lcd_shown[row][col] = lcd_frame[row][col];
+                bytes++;
+            }
+        }
+    }
+#else
+    for(int row = 0; row < LCD_ROWS; row++) {
+        int col = 0;
+        while(col < LCD_COLUMNS) {
+            if(lcd_frame[row][col] == lcd_shown[row][col]) {
+                col++;
+                continue;
+            }
+            // The run ends at the last change before a longer unchanged gap
+            int last = col;
+            for(int scan = col + 1; scan < LCD_COLUMNS && scan - last - 1 <= LCD_FLUSH_GAP; scan++) {
+                if(lcd_frame[row][scan] != lcd_shown[row][scan]) {
+                    last = scan;
+                }
+            }
+            int address = row * LCD_DDRAM_LINE2 + col;
+            if(address != lcd_address) {
+                LCD_SendCmd((unsigned char)(LCD_LINE1 | address));
+                bytes++;
+            }
+            for(; col <= last; col++) {
+                LCD_SendData(lcd_frame[row][col]);
+                lcd_shown[row][col] = lcd_frame[row][col];
+                bytes++;
+            }
+            lcd_address = row * LCD_DDRAM_LINE2 + col;
+        }
+    }
+#endif
+    lcd_dirty = 0;
+    if(bytes == 0) {
+        lcd_stats.skipped++;
+        return;
+    }
+    lcd_stats.flushes++;
+    lcd_stats.last_bytes = bytes;
+    lcd_stats.total_bytes += bytes;
+    if(bytes > lcd_stats.peak_bytes) {
+        lcd_stats.peak_bytes = bytes;
+    }
+}
+
+void LCD_BeginFrame(void) {
+    lcd_frame_depth++;
+}
+
+void LCD_EndFrame(void) {
+    if(lcd_frame_depth > 0) {
+        lcd_frame_depth--;
+    }
+    LCD_Show();
+}
+
+const LcdStats* LCD_GetStats(void) {
+    return &lcd_stats;
+}
+
+// Clear and home act on the shadow only, unless the display has been
+// shifted: only the LCD's own clear or home shifts it back
+static void LCD_Home(unsigned char cmd) {
+    if(lcd_shifted) {
+        LCD_SendCmd(cmd);
+        lcd_shifted = 0;
+        lcd_address = 0;
+#ifndef LCD_DMA_REFRESH
+        // (Refreshing, the next frame rewrites every cell anyway)
+        if(cmd == LCD_CLEAR) {
+            for(int row = 0; row < LCD_ROWS; row++) {
+                for(int col = 0; col < LCD_COLUMNS; col++) {
+                    lcd_shown[row][col] = ' ';
+                }
+            }
+            lcd_dirty = 1;
+        }
+#endif
+    }
+    if(cmd == LCD_CLEAR) {
+        for(int row = 0; row < LCD_ROWS; row++) {
+            for(int col = 0; col < LCD_COLUMNS; col++) {
+                if(lcd_frame[row][col] != ' ') {
+                    lcd_frame[row][col] = ' ';
+                    lcd_dirty = 1;
+                }
+            }
+        }
+    }
+    lcd_row = 0;
+    lcd_col = 0;
+    lcd_cgram = 0;
+}
+
+void LCD_Cmd(unsigned char cmd) {
+    if(cmd & 0x80) {
+        // DDRAM address: moves the frame's cursor
+        lcd_row = (cmd & LCD_DDRAM_LINE2) ? 1 : 0;
+        lcd_col = cmd & 0x3F;
+        lcd_cgram = 0;
+    } else if(cmd == LCD_CLEAR || (cmd & 0xFE) == LCD_HOME) {
+        LCD_Home(cmd == LCD_CLEAR ? LCD_CLEAR : LCD_HOME);
+        LCD_Show();
+    } else {
+        // Display control, shift, entry mode, function set and CGRAM
+        // addresses go to the LCD, after anything drawn before them
+        LCD_Flush();
+        LCD_SendCmd(cmd);
+        if(cmd & 0x40) {
+            lcd_cgram = 1;
+            lcd_address = LCD_ADDRESS_UNKNOWN;
+        } else if((cmd & 0xF0) == 0x10) {
+            // A display shift scrolls, a cursor shift moves the address
+            if(cmd & 0x08) {
+                lcd_shifted = 1;
+            } else {
+                lcd_address = LCD_ADDRESS_UNKNOWN;
+            }
+        }
+    }
+}
+
+void LCD_Char(unsigned char data) {
+    if(lcd_cgram) {
+        LCD_SendData(data);
+        return;
+    }
+    // Cells past the edge are off screen (unless shifted), so they are dropped
+    if(lcd_col < LCD_COLUMNS && lcd_frame[lcd_row][lcd_col] != data) {
+        lcd_frame[lcd_row][lcd_col] = data;
+        lcd_dirty = 1;
+    }
+    lcd_col++;
+    LCD_Show();
 }
 
 void LCD_Init(void) {
@@ -74,53 +540,81 @@ void LCD_Init(void) {
     GPIO_PORTB_DEN_R = 0xFF;      // Enable all pins
     GPIO_PORTB_DATA_R = 0x00;
     
-    // LCD Initialization sequence
+    // Timer 1A: 32-bit one-shot, interrupt on timeout, paces the queue
+    SYSCTL_RCGCTIMER_R |= 0x02;
+    delay = SYSCTL_RCGCTIMER_R;
+    TIMER1_CTL_R = 0x00;
+    TIMER1_CFG_R = 0x00;
+    TIMER1_TAMR_R = 0x01;
+    TIMER1_ICR_R = 0x01;
+    TIMER1_IMR_R = 0x01;
+    NVIC_PRI5_R = (NVIC_PRI5_R & 0xFFFF1FFF) | (LCD_IRQ_PRIORITY << 13);
+    lcd_queue_head = 0;
+    lcd_queue_tail = 0;
+    lcd_queue_running = 0;
+    lcd_isr_low = 0;
+    NVIC_EN0_R = NVIC_TIMER1A_BIT;
+    
+    // LCD Initialization sequence: more than 40 ms after power-up
     Delay_ms(50);
     GPIO_PORTA_DATA_R &= ~0x0C;  // EN=0, RS=0
     
-    // 8-bit mode initialization
-    GPIO_PORTB_DATA_R = (GPIO_PORTB_DATA_R & 0x0F) | 0x30;
-    GPIO_PORTA_DATA_R |= 0x04;
-    Delay_ms(1);
-    GPIO_PORTA_DATA_R &= ~0x04;
+    // 8-bit mode initialization (by instruction, with the datasheet's
+    // waits of more than 4.1 ms and 100 us), sent directly
+    LCD_Nibble(0x30);
     Delay_ms(5);
+    LCD_Nibble(0x30);
+    Delay_us(100);
+    LCD_Nibble(0x30);
+    Delay_cycles(LCD_EXEC_CYCLES);
     
-    GPIO_PORTB_DATA_R = (GPIO_PORTB_DATA_R & 0x0F) | 0x30;
-    GPIO_PORTA_DATA_R |= 0x04;
-    Delay_ms(1);
-    GPIO_PORTA_DATA_R &= ~0x04;
-    Delay_ms(1);
+    // Switch to 4-bit mode
+    LCD_Nibble(0x20);
+    Delay_cycles(LCD_EXEC_CYCLES);
     
-    GPIO_PORTB_DATA_R = (GPIO_PORTB_DATA_R & 0x0F) | 0x30;
-    GPIO_PORTA_DATA_R |= 0x04;
-    Delay_ms(1);
-    GPIO_PORTA_DATA_R &= ~0x04;
-    Delay_ms(1);
+#ifdef LCD_DMA_REFRESH
+    LCD_DmaInit();
+#endif
     
-    // Switch to 4-bit mode
-    GPIO_PORTB_DATA_R = (GPIO_PORTB_DATA_R & 0x0F) | 0x20;
-    GPIO_PORTA_DATA_R |= 0x04;
-    Delay_ms(1);
-    GPIO_PORTA_DATA_R &= ~0x04;
-    Delay_ms(1);
+    // Configure LCD (through the queue from here on)
+    LCD_SendCmd(0x28);  // 4-bit mode, 2 lines, 5x8 font
+    LCD_SendCmd(0x0C);  // Display ON, cursor OFF
+    LCD_SendCmd(0x01);  // Clear display
+    LCD_SendCmd(0x06);  // Entry mode: increment cursor
+#ifdef LCD_DMA_REFRESH
+    // No frame is running to start the queue: start it here, and it
+    // starts the refresh when it has sent these
+    NVIC_PEND0_R = NVIC_TIMER1A_BIT;
+#endif
     
-    // Configure LCD
-    LCD_Cmd(0x28);  // 4-bit mode, 2 lines, 5x8 font
-    LCD_Cmd(0x0C);  // Display ON, cursor OFF
-    LCD_Cmd(0x01);  // Clear display
-    Delay_ms(2);
-    LCD_Cmd(0x06);  // Entry mode: increment cursor
+    // The shadow starts out as blank as the LCD
+    for(int row = 0; row < LCD_ROWS; row++) {
+        for(int col = 0; col < LCD_COLUMNS; col++) {
+            lcd_shown[row][col] = ' ';
+            lcd_frame[row][col] = ' ';
+        }
+    }
+    lcd_row = 0;
+    lcd_col = 0;
+    lcd_dirty = 0;
+    lcd_frame_depth = 0;
+    lcd_address = 0;
+    lcd_cgram = 0;
+    lcd_shifted = 0;
 }
 
 void LCD_String(char* str) {
+    // One flush for the whole string
+    lcd_frame_depth++;
     while(*str) {
         LCD_Char(*str++);
     }
+    lcd_frame_depth--;
+    LCD_Show();
 }
 
 void LCD_Clear(void) {
-    LCD_Cmd(0x01);
-    Delay_ms(2);
+    LCD_Cmd(LCD_CLEAR);
 }
 
 void LCD_SetCursor(unsigned char row, unsigned char col) {
@@ -131,4 +625,12 @@ void LCD_SetCursor(unsigned char row, unsigned char col) {
         address = 0xC0 + col;
     }
     LCD_Cmd(address);
+}
+
+void LCD_CreateChar(unsigned char code, const unsigned char* rows) {
+    LCD_SendCmd(0x40 | ((code & 0x07) << 3));  // Set CGRAM address of the character
+    for(int i = 0; i < 8; i++) {
+        LCD_SendData(rows[i]);
+    }
+    lcd_address = LCD_ADDRESS_UNKNOWN;
 }
\ No newline at end of file
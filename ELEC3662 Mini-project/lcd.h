@@ -5,6 +5,22 @@
  *   PA2 = EN (Enable)
  *   PA3 = RS (Register Select)
  *   PB4-7 = DB4-7 (LCD Data)
+ * 
+ * Text is drawn into a 216 shadow of the display's DDRAM, and a flush
+ * sends only the cells that differ from what the LCD already shows. Clear,
+ * home and cursor addresses act on the shadow, so a screen redrawn from
+ * scratch costs only its changes and never blanks the LCD. Outside
+ * LCD_BeginFrame / LCD_EndFrame every call flushes at once, so code that
+ * draws and then waits (splash, games) sees its output immediately.
+ * 
+ * What a flush sends is queued and written out by the Timer 1A interrupt,
+ * at the LCD's own pace, while the caller carries on. Output still
+ * appears in the order it was drawn; LCD_Wait waits until all of it is
+ * on the display.
+ * 
+ * Built with LCD_DMA_REFRESH, the uDMA keeps sending the whole screen
+ * from an encoded copy instead, so drawn text costs only the re-encoding
+ * of the cells that changed. Other commands still use the queue.
  */
 
 #ifndef LCD_H
@@ -18,6 +34,52 @@ void LCD_String(char* str);
 void LCD_Clear(void);
 void LCD_SetCursor(unsigned char row, unsigned char col);
 
+// Draw a whole screen into the shadow and send the changes once, at
+// LCD_EndFrame (frames may nest; the outermost end flushes)
+void LCD_BeginFrame(void);
+void LCD_EndFrame(void);
+
+// Send the changed cells now (nothing at all if none changed)
+void LCD_Flush(void);
+
+// 1 while queued writes have not all reached the LCD
+int  LCD_Busy(void);
+
+// Wait until every queued write has been executed by the LCD (interrupts
+// must be enabled)
+void LCD_Wait(void);
+
+// Timer 1A interrupt handler that drains the write queue
+void TIMER1A_Handler(void);
+
+#ifdef LCD_DMA_REFRESH
+// Timer 0B interrupt handler: the uDMA has sent a refresh frame
+void TIMER0B_Handler(void);
+#endif
+
+// Flush and queue counters: bytes are commands plus data sent to the LCD
+typedef struct {
+    unsigned long flushes;          // Flushes that sent something
+    unsigned long skipped;          // Flushes with nothing changed
+    unsigned long last_bytes;       // Sent by the last flush that sent anything
+    unsigned long peak_bytes;       // Most sent by one flush
+    unsigned long total_bytes;
+    unsigned long queue_peak;       // Most bytes waiting in the write queue at once
+    unsigned long queue_stalls;     // Writes that found the queue full and waited
+} LcdStats;
+
+const LcdStats* LCD_GetStats(void);
+
+// Define custom character code (0-7) from 8 rows of 5 pixels (bit 4 is the
+// leftmost pixel). Queued at once, even inside a frame; the text cursor
+// is left where it was.
+void LCD_CreateChar(unsigned char code, const unsigned char* rows);
+
+// Display geometry (16x2 HD44780)
+#define LCD_COLUMNS         16
+#define LCD_ROWS            2
+#define LCD_CUSTOM_CHARS    8           // CGRAM character codes 0-7
+
 // Common LCD Commands
 #define LCD_CLEAR           0x01
 #define LCD_HOME            0x02
@@ -4,12 +4,15 @@
  * Hardware platform: TM4C123GH6PM LaunchPad
  *
  * Peripherals:
- *   LCD    - PA2 (EN), PA3 (RS), PB4PB7 (data bus)
+ *   LCD    - PA2 (EN), PA3 (RS), PB4PB7 (data bus), Timer 1A (write queue),
+ *            Timer 0 and uDMA channels 18-19 (LCD_DMA_REFRESH builds)
  *   Keypad - PB0PB3 (columns), PE0PE3 (rows)
  *
  * Key Mappings:
  *   Normal:  A = +    B = -    C = .    D = Shift   * = Equals   # = Backspace
  *   Shifted: A =     B =     C = E    D = Cancel  # = Clear entry
+ *            6 = (    7 = )    * = Replay last expression
+ *            0 = ^ (x^y)       8 = Function menu (sqrt sin cos tan ln log e^x)
  *
  * Memory functions (implemented in calculator.c):
  *   Shift+1 = MS  (memory store)
@@ -18,6 +21,25 @@
  *   Shift+4 = M+  (add to memory)
  *   Shift+5 = M-  (subtract from memory)
  *
+ * Modes (implemented in calculator.c):
+ *   Shift+9 = Mode menu, then 1 = normal, 2 = bignum (exact, any length),
+ *             3 = statistics, 4 = solve, 5 = integrate, 6 = table, 7 = matrix,
+ *             8 = RF, 9 = fraction (exact, lowest terms), 0 = RPN
+ *   In bignum mode, # pages through a long result
+ *   In statistics mode, A adds a sample and equals steps through the results
+ *   In solve mode, Shift+1 types X; equals asks for a guess, then solves
+ *   In integrate mode, Shift+1 types X; equals asks for a, then b, then
+ *   integrates
+ *   In table mode, Shift+1 types X; equals asks for the start and the step,
+ *   then A/B page through the table and C shows the plot
+ *   In matrix mode (A on the mode menu, then 7), 1/2 enter A/B cell by cell,
+ *   then A/B/Shift+A add, subtract and multiply them, 3 = det, 4 = inverse
+ *   In RF mode, Shift+8 opens the dB, wavelength and path loss conversions
+ *   In fraction mode, # switches a result between num/den and its decimal
+ *   In RPN mode, equals is ENTER, Shift+6 rolls the stack down and Shift+7
+ *   swaps X and Y; Shift+5 opens the program menu (STO, RCL, record, and
+ *   labels, GTO, DSZ and tests while recording) and Shift+1..4 run programs
+ *
  * Easter eggs and games:
  *   Enter the numbers below and press equals:
  *     42     -> "Answer to Life" message
@@ -46,12 +68,19 @@
 #include "calculator.h"
 #include "splash.h"
 #include "games.h"
+#ifdef CALC_BENCHMARK
+#include "bench.h"
+#endif
 
 int main(void) {
     // Configure system clock and enable GPIO peripherals
     System_Init();
 
-    // Initialise LCD in 4-bit mode and clear display
+    // Start the cycle counter (the LCD driver's delays run on it, and
+    // integrate mode times each integral with it)
+    CycleCounter_Init();
+
+    // Initialise LCD in 4-bit mode, start its write queue and clear display
     LCD_Init();
 
     // Configure keypad GPIO directions and internal pull-ups
@@ -62,8 +91,14 @@ int main(void) {
     //          SPLASH_LOADING_BAR, SPLASH_MATRIX, SPLASH_WAVE
     Splash_Show(SPLASH_SATELLITE);
 
+#ifdef CALC_BENCHMARK
+    // Cycle-count benchmarks of the calculator engine (build with -DCALC_BENCHMARK)
+    Bench_Run();
+#endif
+
     // Create and initialise calculator context
-    Calculator calc;
+    // (static: the context is larger than the 2 KB startup stack allows)
+    static Calculator calc;
     Calculator_Init(&calc);
 
     // Create and initialise global game state
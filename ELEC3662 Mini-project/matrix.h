@@ -0,0 +1,45 @@
+/*
+ * Small Matrix Header
+ *
+ * Matrices of 1 to MATRIX_MAX_SIZE rows and columns, stored row by row in
+ * fixed-size arrays (no malloc). Sum, difference, product, transpose and
+ * inverse go through the CMSIS-DSP arm_mat_*_f32 kernels on the target;
+ * host builds use the same algorithms in plain C, so the calculator code
+ * above runs unchanged on both. The determinant has no CMSIS-DSP kernel and
+ * is worked out by elimination on both.
+ */
+
+#ifndef MATRIX_H
+#define MATRIX_H
+
+#define MATRIX_MAX_SIZE         4
+#define MATRIX_MAX_CELLS        (MATRIX_MAX_SIZE * MATRIX_MAX_SIZE)
+
+typedef struct {
+    int   rows;
+    int   cols;
+    float data[MATRIX_MAX_CELLS];   // Row by row: cell (r, c) is data[r * cols + c]
+} Matrix;
+
+typedef enum {
+    MATRIX_OK = 0,
+    MATRIX_SIZE_MISMATCH,           // Operands do not fit the operation
+    MATRIX_SINGULAR                 // No inverse
+} MatrixStatus;
+
+// rows  cols of zeros (1 to MATRIX_MAX_SIZE each)
+void Matrix_Init(Matrix* matrix, int rows, int cols);
+
+// result may not be one of the operands
+MatrixStatus Matrix_Add(const Matrix* a, const Matrix* b, Matrix* result);
+MatrixStatus Matrix_Subtract(const Matrix* a, const Matrix* b, Matrix* result);
+MatrixStatus Matrix_Multiply(const Matrix* a, const Matrix* b, Matrix* result);
+MatrixStatus Matrix_Transpose(const Matrix* a, Matrix* result);
+
+// Square matrices only. scratch is overwritten (the kernels eliminate in
+// place, and a is left as it was). A singular a leaves result all zeros,
+// never a partly eliminated matrix.
+MatrixStatus Matrix_Inverse(const Matrix* a, Matrix* result, Matrix* scratch);
+MatrixStatus Matrix_Determinant(const Matrix* a, float* determinant, Matrix* scratch);
+
+#endif // MATRIX_H
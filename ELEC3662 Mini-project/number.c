@@ -0,0 +1,330 @@
+/*
+ * Number Backend Implementation
+ *
+ * Float backend: FPU arithmetic, a flash table of powers of ten for E
+ * scaling and the FPSCR sticky flags for error reporting.
+ * Decimal backend: thin wrappers around decimal.c. The scientific
+ * functions and RF conversions go through float (mathfn.c, rf.c), except
+ * whole powers, which are multiplied out in decimal.
+ */
+
+#include "number.h"
+#include "numformat.h"
+#include "mathfn.h"
+#include "rf.h"
+#if !defined(CALC_BACKEND_DECIMAL) && !defined(__ARM_FP)
+#include <fenv.h>
+#endif
+
+#ifdef CALC_BACKEND_DECIMAL
+
+// ---------------------------------------------------------------------------
+// Decimal backend
+// ---------------------------------------------------------------------------
+
+CalcNumber Number_Zero(void) {
+    return Decimal_Zero();
+}
+
+CalcNumber Number_FromInput(unsigned long long mantissa, int decimal_places) {
+    // Typed digits are exact: no rounding at all
+    return Decimal_FromDigits(mantissa, -decimal_places);
+}
+
+CalcNumber Number_FromInt64(long long value) {
+    // Magnitude as unsigned so LLONG_MIN does not overflow
+    unsigned long long magnitude = (value < 0) ? 0ULL - (unsigned long long)value
+                                               : (unsigned long long)value;
+    Decimal result = Decimal_FromDigits(magnitude, 0);
+    result.negative = (value < 0);
+    return result;
+}
+
+CalcNumber Number_FromFloat(float value) {
+    return Decimal_FromFloat(value);
+}
+
+float Number_ToFloat(CalcNumber value) {
+    return Decimal_ToFloat(value);
+}
+
+CalcNumber Number_Add(CalcNumber a, CalcNumber b) {
+    return Decimal_Add(a, b);
+}
+
+CalcNumber Number_Subtract(CalcNumber a, CalcNumber b) {
+    return Decimal_Subtract(a, b);
+}
+
+CalcNumber Number_Multiply(CalcNumber a, CalcNumber b) {
+    return Decimal_Multiply(a, b);
+}
+
+CalcNumber Number_Divide(CalcNumber a, CalcNumber b) {
+    return Decimal_Divide(a, b);
+}
+
+CalcNumber Number_Scale10(CalcNumber a, int exponent) {
+    return Decimal_Scale10(a, exponent);
+}
+
+// a^b: whole exponents by square-and-multiply in decimal (exact while the
+// digits fit), anything else in float
+CalcNumber Number_Power(CalcNumber a, CalcNumber b) {
+    float exponent = Decimal_ToFloat(b);
+    
+    if(exponent >= -65536.0f && exponent <= 65536.0f && exponent == (float)(long)exponent) {
+        long n = (long)exponent;
+        unsigned long bits = (unsigned long)((n < 0) ? -n : n);
+        Decimal base = a;
+        Decimal result = Decimal_FromDigits(1, 0);
+        while(bits != 0) {
+            if(bits & 1) {
+                result = Decimal_Multiply(result, base);
+            }
+            bits >>= 1;
+            if(bits != 0) {
+                base = Decimal_Multiply(base, base);
+            }
+        }
+        if(n < 0) {
+            result = Decimal_Divide(Decimal_FromDigits(1, 0), result);
+        }
+        return result;
+    }
+    return Decimal_FromFloat(MathFn_Pow(Decimal_ToFloat(a), exponent));
+}
+
+CalcNumber Number_Sqrt(CalcNumber a) {
+    return Decimal_FromFloat(MathFn_Sqrt(Decimal_ToFloat(a)));
+}
+
+CalcNumber Number_Sin(CalcNumber a) {
+    return Decimal_FromFloat(MathFn_Sin(Decimal_ToFloat(a)));
+}
+
+CalcNumber Number_Cos(CalcNumber a) {
+    return Decimal_FromFloat(MathFn_Cos(Decimal_ToFloat(a)));
+}
+
+CalcNumber Number_Tan(CalcNumber a) {
+    return Decimal_FromFloat(MathFn_Tan(Decimal_ToFloat(a)));
+}
+
+CalcNumber Number_Ln(CalcNumber a) {
+    return Decimal_FromFloat(MathFn_Log(Decimal_ToFloat(a)));
+}
+
+CalcNumber Number_Log10(CalcNumber a) {
+    return Decimal_FromFloat(MathFn_Log10(Decimal_ToFloat(a)));
+}
+
+CalcNumber Number_Exp(CalcNumber a) {
+    return Decimal_FromFloat(MathFn_Exp(Decimal_ToFloat(a)));
+}
+
+CalcNumber Number_FromDb(CalcNumber a) {
+    return Decimal_FromFloat(Rf_FromDb(Decimal_ToFloat(a)));
+}
+
+CalcNumber Number_ToDb(CalcNumber a) {
+    return Decimal_FromFloat(Rf_ToDb(Decimal_ToFloat(a)));
+}
+
+CalcNumber Number_Wavelength(CalcNumber a) {
+    return Decimal_FromFloat(Rf_Wavelength(Decimal_ToFloat(a)));
+}
+
+CalcNumber Number_PathLoss(CalcNumber km, CalcNumber mhz) {
+    return Decimal_FromFloat(Rf_PathLoss(Decimal_ToFloat(km), Decimal_ToFloat(mhz)));
+}
+
+int Number_IsZero(CalcNumber value) {
+    return Decimal_IsZero(value);
+}
+
+void Number_ClearExceptions(void) {
+    Decimal_ClearStatus();
+}
+
+int Number_TestExceptions(void) {
+    int status = Decimal_TestStatus();
+    int flags = 0;
+    if(status & (DECIMAL_INVALID | DECIMAL_DIV_ZERO)) flags |= NUMBER_INVALID;
+    if(status & DECIMAL_OVERFLOW)  flags |= NUMBER_OVERFLOW;
+    if(status & DECIMAL_UNDERFLOW) flags |= NUMBER_UNDERFLOW;
+    return flags;
+}
+
+void Number_Format(char* buffer, CalcNumber number, int buffer_size) {
+    Decimal_Format(buffer, number, buffer_size);
+}
+
+#else
+
+// ---------------------------------------------------------------------------
+// Float backend
+// ---------------------------------------------------------------------------
+
+// Powers of ten for the E operator: 10^0 .. 10^38 (the float range), in flash.
+// 10^0 .. 10^10 are exact; larger entries are correctly rounded constants.
+#define POW10_TABLE_MAX     38
+static const float pow10_table[POW10_TABLE_MAX + 1] = {
+    1e0f,  1e1f,  1e2f,  1e3f,  1e4f,  1e5f,  1e6f,  1e7f,  1e8f,  1e9f,
+    1e10f, 1e11f, 1e12f, 1e13f, 1e14f, 1e15f, 1e16f, 1e17f, 1e18f, 1e19f,
+    1e20f, 1e21f, 1e22f, 1e23f, 1e24f, 1e25f, 1e26f, 1e27f, 1e28f, 1e29f,
+    1e30f, 1e31f, 1e32f, 1e33f, 1e34f, 1e35f, 1e36f, 1e37f, 1e38f
+};
+
+CalcNumber Number_Zero(void) {
+    return 0.0f;
+}
+
+CalcNumber Number_FromInput(unsigned long long mantissa, int decimal_places) {
+    // One single-precision divide (no software double on the M4F). Up to
+    // 7 digits and 10 decimal places both parts are exact floats, so the
+    // result rounds once; longer entries also round the mantissa (and past
+    // 10^10 the divisor) first: 1.6 ulp at worst over random 15-digit input.
+    float digits = (mantissa <= 0xFFFFFFFFULL) ? (float)(unsigned long)mantissa
+                                                : (float)mantissa;
+    return digits / pow10_table[decimal_places];
+}
+
+CalcNumber Number_FromInt64(long long value) {
+    return (float)value;
+}
+
+CalcNumber Number_FromFloat(float value) {
+    return value;
+}
+
+float Number_ToFloat(CalcNumber value) {
+    return value;
+}
+
+CalcNumber Number_Add(CalcNumber a, CalcNumber b) {
+    return a + b;
+}
+
+CalcNumber Number_Subtract(CalcNumber a, CalcNumber b) {
+    return a - b;
+}
+
+CalcNumber Number_Multiply(CalcNumber a, CalcNumber b) {
+    return a * b;
+}
+
+CalcNumber Number_Divide(CalcNumber a, CalcNumber b) {
+    return a / b;
+}
+
+// a  10^exponent with at most two table multiplies/divides.
+// Exponents past the table still overflow/underflow correctly,
+// and the FPU flags report it.
+CalcNumber Number_Scale10(CalcNumber a, int exponent) {
+    if(exponent >= 0) {
+        if(exponent > POW10_TABLE_MAX) {
+            a *= pow10_table[POW10_TABLE_MAX];
+            exponent -= POW10_TABLE_MAX;
+            if(exponent > POW10_TABLE_MAX) exponent = POW10_TABLE_MAX;
+        }
+        return a * pow10_table[exponent];
+    } else {
+        exponent = -exponent;
+        if(exponent > POW10_TABLE_MAX) {
+            a /= pow10_table[POW10_TABLE_MAX];
+            exponent -= POW10_TABLE_MAX;
+            if(exponent > POW10_TABLE_MAX) exponent = POW10_TABLE_MAX;
+        }
+        return a / pow10_table[exponent];
+    }
+}
+
+CalcNumber Number_Power(CalcNumber a, CalcNumber b) {
+    return MathFn_Pow(a, b);
+}
+
+CalcNumber Number_Sqrt(CalcNumber a) {
+    return MathFn_Sqrt(a);
+}
+
+CalcNumber Number_Sin(CalcNumber a) {
+    return MathFn_Sin(a);
+}
+
+CalcNumber Number_Cos(CalcNumber a) {
+    return MathFn_Cos(a);
+}
+
+CalcNumber Number_Tan(CalcNumber a) {
+    return MathFn_Tan(a);
+}
+
+CalcNumber Number_Ln(CalcNumber a) {
+    return MathFn_Log(a);
+}
+
+CalcNumber Number_Log10(CalcNumber a) {
+    return MathFn_Log10(a);
+}
+
+CalcNumber Number_Exp(CalcNumber a) {
+    return MathFn_Exp(a);
+}
+
+CalcNumber Number_FromDb(CalcNumber a) {
+    return Rf_FromDb(a);
+}
+
+CalcNumber Number_ToDb(CalcNumber a) {
+    return Rf_ToDb(a);
+}
+
+CalcNumber Number_Wavelength(CalcNumber a) {
+    return Rf_Wavelength(a);
+}
+
+CalcNumber Number_PathLoss(CalcNumber km, CalcNumber mhz) {
+    return Rf_PathLoss(km, mhz);
+}
+
+int Number_IsZero(CalcNumber value) {
+    return value == 0.0f;
+}
+
+// Clear the sticky FPU exception flags before a reduction.
+// On the Cortex-M4F these are the FPSCR cumulative bits (IOC, DZC, OFC, UFC,
+// IXC, IDC); a host build uses the C99 fenv equivalent.
+void Number_ClearExceptions(void) {
+#if defined(__ARM_FP)
+    unsigned long fpscr;
+    __asm volatile ("vmrs %0, fpscr" : "=r" (fpscr) : : "memory");
+    fpscr &= ~0x0000009FUL;
+    __asm volatile ("vmsr fpscr, %0" : : "r" (fpscr) : "memory");
+#else
+    feclearexcept(FE_ALL_EXCEPT);
+#endif
+}
+
+// Read the sticky flags raised since the last clear (NUMBER_* bits)
+int Number_TestExceptions(void) {
+    int flags = 0;
+#if defined(__ARM_FP)
+    unsigned long fpscr;
+    __asm volatile ("vmrs %0, fpscr" : "=r" (fpscr) : : "memory");
+    if(fpscr & 0x01) flags |= NUMBER_INVALID;     // IOC
+    if(fpscr & 0x04) flags |= NUMBER_OVERFLOW;    // OFC
+    if(fpscr & 0x08) flags |= NUMBER_UNDERFLOW;   // UFC
+#else
+    if(fetestexcept(FE_INVALID))   flags |= NUMBER_INVALID;
+    if(fetestexcept(FE_OVERFLOW))  flags |= NUMBER_OVERFLOW;
+    if(fetestexcept(FE_UNDERFLOW)) flags |= NUMBER_UNDERFLOW;
+#endif
+    return flags;
+}
+
+void Number_Format(char* buffer, CalcNumber number, int buffer_size) {
+    NumFormat_Float(buffer, number, buffer_size);
+}
+
+#endif // CALC_BACKEND_DECIMAL
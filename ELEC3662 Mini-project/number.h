@@ -0,0 +1,66 @@
+/*
+ * Number Backend Header
+ *
+ * The calculator engine works on CalcNumber values through these
+ * functions only, so the arithmetic backend is chosen per build:
+ *   default                 - single-precision float on the FPU
+ *   -DCALC_BACKEND_DECIMAL  - 16-digit decimal (decimal.c), exact for
+ *                             decimal input, no 0.1 + 0.2 display errors
+ */
+
+#ifndef NUMBER_H
+#define NUMBER_H
+
+#ifdef CALC_BACKEND_DECIMAL
+#include "decimal.h"
+typedef Decimal CalcNumber;
+#else
+typedef float CalcNumber;
+#endif
+
+// Exception flags reported by Number_TestExceptions
+#define NUMBER_INVALID      0x01
+#define NUMBER_OVERFLOW     0x02
+#define NUMBER_UNDERFLOW    0x04
+
+// Construction and conversion
+CalcNumber Number_Zero(void);
+CalcNumber Number_FromInput(unsigned long long mantissa, int decimal_places); // mantissa  10^-decimal_places
+CalcNumber Number_FromInt64(long long value);
+CalcNumber Number_FromFloat(float value);
+float      Number_ToFloat(CalcNumber value);
+
+// Arithmetic
+CalcNumber Number_Add(CalcNumber a, CalcNumber b);
+CalcNumber Number_Subtract(CalcNumber a, CalcNumber b);
+CalcNumber Number_Multiply(CalcNumber a, CalcNumber b);
+CalcNumber Number_Divide(CalcNumber a, CalcNumber b);
+CalcNumber Number_Scale10(CalcNumber a, int exponent);      // a  10^exponent
+CalcNumber Number_Power(CalcNumber a, CalcNumber b);        // a^b
+
+// Scientific functions (mathfn.c; the decimal backend evaluates them in float)
+CalcNumber Number_Sqrt(CalcNumber a);
+CalcNumber Number_Sin(CalcNumber a);
+CalcNumber Number_Cos(CalcNumber a);
+CalcNumber Number_Tan(CalcNumber a);
+CalcNumber Number_Ln(CalcNumber a);
+CalcNumber Number_Log10(CalcNumber a);
+CalcNumber Number_Exp(CalcNumber a);
+
+// RF conversions (rf.c, in float on both backends)
+CalcNumber Number_FromDb(CalcNumber a);                     // 10^(a/10)
+CalcNumber Number_ToDb(CalcNumber a);                       // 10log10(a)
+CalcNumber Number_Wavelength(CalcNumber a);                 // c / a (MHz <-> m)
+CalcNumber Number_PathLoss(CalcNumber km, CalcNumber mhz);  // Free-space loss in dB
+
+// Queries
+int Number_IsZero(CalcNumber value);
+
+// Sticky exception flags (FPSCR for float, status flags for decimal)
+void Number_ClearExceptions(void);
+int  Number_TestExceptions(void);
+
+// Display formatting
+void Number_Format(char* buffer, CalcNumber number, int buffer_size);
+
+#endif // NUMBER_H
@@ -0,0 +1,418 @@
+/*
+ * Number Formatting Implementation
+ * 
+ * Shortest round-trip decimal digits for single-precision floats, using the
+ * Ryu algorithm (Ulf Adams, PLDI 2018) specialised for 32-bit floats: the
+ * rounding interval of the float is scaled by a power of five held as a
+ * 64-bit fixed-point constant, then digits are removed until the interval
+ * no longer contains a shorter decimal. Integer-only, no division by
+ * anything but 10, and no float operations, so it is exact for every input.
+ * 
+ * NumFormat_Layout then fits the digits onto the 16-column LCD line.
+ */
+
+#include "numformat.h"
+#include "lcd.h"
+#include <string.h>
+#include <stdint.h>
+#include <float.h>
+
+#define FLOAT_MANTISSA_BITS     23
+#define FLOAT_BIAS              127
+#define POW5_INV_BITCOUNT       59
+#define POW5_BITCOUNT           61
+
+// Two ASCII digits per entry ("00" .. "99"), so digits are emitted in pairs
+static const char digit_pairs[200] = {
+    '0','0','0','1','0','2','0','3','0','4','0','5','0','6','0','7','0','8','0','9',
+    '1','0','1','1','1','2','1','3','1','4','1','5','1','6','1','7','1','8','1','9',
+    '2','0','2','1','2','2','2','3','2','4','2','5','2','6','2','7','2','8','2','9',
+    '3','0','3','1','3','2','3','3','3','4','3','5','3','6','3','7','3','8','3','9',
+    '4','0','4','1','4','2','4','3','4','4','4','5','4','6','4','7','4','8','4','9',
+    '5','0','5','1','5','2','5','3','5','4','5','5','5','6','5','7','5','8','5','9',
+    '6','0','6','1','6','2','6','3','6','4','6','5','6','6','6','7','6','8','6','9',
+    '7','0','7','1','7','2','7','3','7','4','7','5','7','6','7','7','7','8','7','9',
+    '8','0','8','1','8','2','8','3','8','4','8','5','8','6','8','7','8','8','8','9',
+    '9','0','9','1','9','2','9','3','9','4','9','5','9','6','9','7','9','8','9','9'
+};
+
+// 2^(bits(5^q) - 1 + 59) / 5^q + 1, for q = 0 .. 30
+static const uint64_t pow5_inv_split[31] = {
+    576460752303423489u, 461168601842738791u, 368934881474191033u,
+    295147905179352826u, 472236648286964522u, 377789318629571618u,
+    302231454903657294u, 483570327845851670u, 386856262276681336u,
+    309485009821345069u, 495176015714152110u, 396140812571321688u,
+    316912650057057351u, 507060240091291761u, 405648192073033409u,
+    324518553658426727u, 519229685853482763u, 415383748682786211u,
+    332306998946228969u, 531691198313966350u, 425352958651173080u,
+    340282366920938464u, 544451787073501542u, 435561429658801234u,
+    348449143727040987u, 557518629963265579u, 446014903970612463u,
+    356811923176489971u, 570899077082383953u, 456719261665907162u,
+    365375409332725730u
+};
+
+// 5^i normalised to 61 significant bits, for i = 0 .. 46
+static const uint64_t pow5_split[47] = {
+    1152921504606846976u, 1441151880758558720u, 1801439850948198400u,
+    2251799813685248000u, 1407374883553280000u, 1759218604441600000u,
+    2199023255552000000u, 1374389534720000000u, 1717986918400000000u,
+    2147483648000000000u, 1342177280000000000u, 1677721600000000000u,
+    2097152000000000000u, 1310720000000000000u, 1638400000000000000u,
+    2048000000000000000u, 1280000000000000000u, 1600000000000000000u,
+    2000000000000000000u, 1250000000000000000u, 1562500000000000000u,
+    1953125000000000000u, 1220703125000000000u, 1525878906250000000u,
+    1907348632812500000u, 1192092895507812500u, 1490116119384765625u,
+    1862645149230957031u, 1164153218269348144u, 1455191522836685180u,
+    1818989403545856475u, 2273736754432320594u, 1421085471520200371u,
+    1776356839400250464u, 2220446049250313080u, 1387778780781445675u,
+    1734723475976807094u, 2168404344971008868u, 1355252715606880542u,
+    1694065894508600678u, 2117582368135750847u, 1323488980084844279u,
+    1654361225106055349u, 2067951531382569187u, 1292469707114105741u,
+    1615587133892632177u, 2019483917365790221u
+};
+
+// ceil(log2(5^e)) for e > 0 (1 for e == 0)
+static int NumFormat_Pow5Bits(int e) {
+    return (int)(((uint32_t)e * 1217359) >> 19) + 1;
+}
+
+// floor(log10(2^e)) and floor(log10(5^e)) for e >= 0
+static uint32_t NumFormat_Log10Pow2(int e) {
+    return ((uint32_t)e * 78913) >> 18;
+}
+
+static uint32_t NumFormat_Log10Pow5(int e) {
+    return ((uint32_t)e * 732923) >> 20;
+}
+
+static int NumFormat_MultipleOfPow5(uint32_t value, uint32_t p) {
+    uint32_t count = 0;
+    while(value % 5 == 0) {
+        value /= 5;
+        count++;
+    }
+    return count >= p;
+}
+
+static int NumFormat_MultipleOfPow2(uint32_t value, uint32_t p) {
+    return (value & ((1u << p) - 1)) == 0;
+}
+
+// (m  factor) >> shift, with shift > 32: two 3232 multiplies on the M4
+static uint32_t NumFormat_MulShift(uint32_t m, uint64_t factor, int shift) {
+    uint64_t low = (uint64_t)m * (uint32_t)factor;
+    uint64_t high = (uint64_t)m * (uint32_t)(factor >> 32);
+    uint64_t sum = (low >> 32) + high;
+    return (uint32_t)(sum >> (shift - 32));
+}
+
+int NumFormat_Shortest(float value, char* digits, int* exponent) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    
+    uint32_t ieee_mantissa = bits & ((1u << FLOAT_MANTISSA_BITS) - 1);
+    uint32_t ieee_exponent = (bits >> FLOAT_MANTISSA_BITS) & 0xFF;
+    
+    // Step 1: value = m2  2^e2 (with two extra bits for the interval bounds)
+    int e2;
+    uint32_t m2;
+    if(ieee_exponent == 0) {
+        e2 = 1 - FLOAT_BIAS - FLOAT_MANTISSA_BITS - 2;
+        m2 = ieee_mantissa;
+    } else {
+        e2 = (int)ieee_exponent - FLOAT_BIAS - FLOAT_MANTISSA_BITS - 2;
+        m2 = (1u << FLOAT_MANTISSA_BITS) | ieee_mantissa;
+    }
+    int accept_bounds = (m2 & 1) == 0;  // round-half-even includes the bounds
+    
+    // Step 2: interval of values that round to this float: [mm, mp] around mv
+    uint32_t mv = 4 * m2;
+    uint32_t mp = 4 * m2 + 2;
+    uint32_t mm_shift = (ieee_mantissa != 0 || ieee_exponent <= 1);
+    uint32_t mm = 4 * m2 - 1 - mm_shift;
+    
+    // Step 3: scale all three to a decimal exponent e10
+    uint32_t vr, vp, vm;
+    int e10;
+    int vm_trailing_zeros = 0;
+    int vr_trailing_zeros = 0;
+    uint32_t last_removed = 0;
+    
+    if(e2 >= 0) {
+        uint32_t q = NumFormat_Log10Pow2(e2);
+        e10 = (int)q;
+        int k = POW5_INV_BITCOUNT + NumFormat_Pow5Bits((int)q) - 1;
+        int i = -e2 + (int)q + k;
+        vr = NumFormat_MulShift(mv, pow5_inv_split[q], i);
+        vp = NumFormat_MulShift(mp, pow5_inv_split[q], i);
+        vm = NumFormat_MulShift(mm, pow5_inv_split[q], i);
+        if(q != 0 && (vp - 1) / 10 <= vm / 10) {
+            // One removed digit is needed for rounding even if no loop runs
+            int l = POW5_INV_BITCOUNT + NumFormat_Pow5Bits((int)q - 1) - 1;
+            last_removed = NumFormat_MulShift(mv, pow5_inv_split[q - 1], -e2 + (int)q - 1 + l) % 10;
+        }
+        if(q <= 9) {
+            // At most one of mp, mv and mm can be a multiple of 5
+            if(mv % 5 == 0) {
+                vr_trailing_zeros = NumFormat_MultipleOfPow5(mv, q);
+            } else if(accept_bounds) {
+                vm_trailing_zeros = NumFormat_MultipleOfPow5(mm, q);
+            } else {
+                vp -= NumFormat_MultipleOfPow5(mp, q);
+            }
+        }
+    } else {
+        uint32_t q = NumFormat_Log10Pow5(-e2);
+        e10 = (int)q + e2;
+        int i = -e2 - (int)q;
+        int k = NumFormat_Pow5Bits(i) - POW5_BITCOUNT;
+        int j = (int)q - k;
+        vr = NumFormat_MulShift(mv, pow5_split[i], j);
+        vp = NumFormat_MulShift(mp, pow5_split[i], j);
+        vm = NumFormat_MulShift(mm, pow5_split[i], j);
+        if(q != 0 && (vp - 1) / 10 <= vm / 10) {
+            j = (int)q - 1 - (NumFormat_Pow5Bits(i + 1) - POW5_BITCOUNT);
+            last_removed = NumFormat_MulShift(mv, pow5_split[i + 1], j) % 10;
+        }
+        if(q <= 1) {
+            // mv = 4  m2 always has at least two trailing zero bits
+            vr_trailing_zeros = 1;
+            if(accept_bounds) {
+                vm_trailing_zeros = (mm_shift == 1);
+            } else {
+                vp--;
+            }
+        } else if(q < 31) {
+            vr_trailing_zeros = NumFormat_MultipleOfPow2(mv, q - 1);
+        }
+    }
+    
+    // Step 4: drop digits while the interval still holds a shorter decimal
+    int removed = 0;
+    uint32_t output;
+    if(vm_trailing_zeros || vr_trailing_zeros) {
+        // Rare general case: exact ties need round-half-even
+        while(vp / 10 > vm / 10) {
+            vm_trailing_zeros &= (vm % 10 == 0);
+            vr_trailing_zeros &= (last_removed == 0);
+            last_removed = vr % 10;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        if(vm_trailing_zeros) {
+            while(vm % 10 == 0) {
+                vr_trailing_zeros &= (last_removed == 0);
+                last_removed = vr % 10;
+                vr /= 10;
+                vp /= 10;
+                vm /= 10;
+                removed++;
+            }
+        }
+        if(vr_trailing_zeros && last_removed == 5 && vr % 2 == 0) {
+            last_removed = 4;
+        }
+        output = vr + ((vr == vm && (!accept_bounds || !vm_trailing_zeros)) || last_removed >= 5);
+    } else {
+        // Common case
+        while(vp / 10 > vm / 10) {
+            last_removed = vr % 10;
+            vr /= 10;
+            vp /= 10;
+            vm /= 10;
+            removed++;
+        }
+        output = vr + (vr == vm || last_removed >= 5);
+    }
+    
+    // Step 5: emit the digits, two at a time from the right
+    int length = NumFormat_DigitCount(output);
+    *exponent = e10 + removed + length - 1;
+    NumFormat_WriteDigits(digits, output, length);
+    return length;
+}
+
+int NumFormat_DigitCount(uint32_t value) {
+    int length = 1;
+    while(value >= 10) {
+        value /= 10;
+        length++;
+    }
+    return length;
+}
+
+void NumFormat_WriteDigits(char* digits, uint32_t value, int length) {
+    int pos = length;
+    while(value >= 100) {
+        uint32_t pair = (value % 100) * 2;
+        value /= 100;
+        digits[--pos] = digit_pairs[pair + 1];
+        digits[--pos] = digit_pairs[pair];
+    }
+    if(value >= 10) {
+        digits[--pos] = digit_pairs[value * 2 + 1];
+        digits[--pos] = digit_pairs[value * 2];
+    } else {
+        digits[--pos] = (char)('0' + value);
+    }
+    // Leading zeros up to the requested length
+    while(pos > 0) {
+        digits[--pos] = '0';
+    }
+}
+
+// Round a digit string to keep digits (half up), strip trailing zeros.
+// A carry out of the first digit (9.99 -> 10.0) bumps the exponent.
+static int NumFormat_RoundDigits(char* digits, int count, int keep, int* exponent) {
+    if(keep >= count) {
+        return count;
+    }
+    
+    if(digits[keep] >= '5') {
+        int i = keep - 1;
+        while(i >= 0 && digits[i] == '9') {
+            digits[i--] = '0';
+        }
+        if(i >= 0) {
+            digits[i]++;
+        } else {
+            digits[0] = '1';
+            (*exponent)++;
+        }
+    }
+    
+    while(keep > 1 && digits[keep - 1] == '0') {
+        keep--;
+    }
+    return keep;
+}
+
+// Columns needed to show digits d.ddd  10^exponent in fixed notation
+static int NumFormat_FixedLength(int count, int exponent) {
+    if(exponent < 0) {
+        return 2 + (-exponent - 1) + count;        // 0.000ddd
+    }
+    if(count > exponent + 1) {
+        return count + 1;                          // ddd.ddd
+    }
+    return exponent + 1;                           // ddd000
+}
+
+void NumFormat_Layout(char* buffer, int buffer_size, int negative,
+                      char* digits, int count, int exponent) {
+    int pos = 0;
+    
+    if(negative) {
+        buffer[pos++] = '-';
+    }
+    
+    // Columns available after the sign
+    int width = buffer_size - 1;
+    if(width > LCD_COLUMNS) {
+        width = LCD_COLUMNS;
+    }
+    width -= pos;
+    
+    // Fixed notation: integer part must fit, small values down to 0.0001
+    if(exponent >= -4 && exponent < width) {
+        int keep;
+        if(exponent >= 0) {
+            keep = (exponent + 1 > width - 1) ? exponent + 1 : width - 1;
+        } else {
+            keep = width - 1 + exponent;
+        }
+        if(keep >= 1) {
+            count = NumFormat_RoundDigits(digits, count, keep, &exponent);
+        }
+        
+        if(keep >= 1 && NumFormat_FixedLength(count, exponent) <= width) {
+            if(exponent < 0) {
+                buffer[pos++] = '0';
+                buffer[pos++] = '.';
+                for(int i = exponent + 1; i < 0; i++) {
+                    buffer[pos++] = '0';
+                }
+                memcpy(buffer + pos, digits, count);
+                pos += count;
+            } else {
+                for(int i = 0; i <= exponent || i < count; i++) {
+                    if(i == exponent + 1) {
+                        buffer[pos++] = '.';
+                    }
+                    buffer[pos++] = (i < count) ? digits[i] : '0';
+                }
+            }
+            buffer[pos] = '\0';
+            return;
+        }
+    }
+    
+    // Scientific notation: d.dddEnn (mantissa rounded to the columns left),
+    // Ennn for the decimal backend's exponents of 100 and beyond
+    int exponent_digits = (exponent >= 100 || exponent <= -100) ? 3 : 2;
+    int keep = width - 3 - exponent_digits;        // "." + "E" + "nn"
+    if(keep < 1) {
+        keep = 1;
+    }
+    count = NumFormat_RoundDigits(digits, count, keep, &exponent);
+    
+    buffer[pos++] = digits[0];
+    if(count > 1) {
+        buffer[pos++] = '.';
+        memcpy(buffer + pos, digits + 1, count - 1);
+        pos += count - 1;
+    }
+    buffer[pos++] = 'E';
+    if(exponent < 0) {
+        buffer[pos++] = '-';
+        exponent = -exponent;
+    } else {
+        buffer[pos++] = '+';
+    }
+    
+    // Rounding can carry 9.99E+99 to 1E+100; the mantissa is then a single
+    // digit, so the third exponent digit still fits
+    if(exponent >= 100) {
+        buffer[pos++] = '0' + exponent / 100;
+        exponent %= 100;
+    }
+    buffer[pos++] = '0' + exponent / 10;
+    buffer[pos++] = '0' + exponent % 10;
+    buffer[pos] = '\0';
+}
+
+void NumFormat_Float(char* buffer, float number, int buffer_size) {
+    char digits[NUMFORMAT_MAX_DIGITS];
+    int exponent;
+    int count;
+    int negative = 0;
+    
+    // Handle special cases
+    if(number == 0.0f) {
+        buffer[0] = '0';
+        buffer[1] = '\0';
+        return;
+    }
+    if(number != number) {
+        strncpy(buffer, "NaN", buffer_size - 1);
+        buffer[buffer_size - 1] = '\0';
+        return;
+    }
+    
+    // Handle negative numbers
+    if(number < 0) {
+        negative = 1;
+        number = -number;
+    }
+    
+    if(number > FLT_MAX) {
+        strncpy(buffer, negative ? "-Inf" : "Inf", buffer_size - 1);
+        buffer[buffer_size - 1] = '\0';
+        return;
+    }
+    
+    count = NumFormat_Shortest(number, digits, &exponent);
+    NumFormat_Layout(buffer, buffer_size, negative, digits, count, exponent);
+}
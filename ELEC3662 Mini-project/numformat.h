@@ -0,0 +1,39 @@
+/*
+ * Number Formatting Header
+ * 
+ * Shortest round-trip decimal conversion for single-precision floats,
+ * fast integer-to-digits helpers, and the LCD number layout shared by
+ * every number backend.
+ */
+
+#ifndef NUMFORMAT_H
+#define NUMFORMAT_H
+
+#include <stdint.h>
+
+// Most significant digits a float ever needs to round-trip
+#define NUMFORMAT_MAX_DIGITS    9
+
+// Shortest digit string that reads back as exactly the same float.
+// value must be finite and non-zero (its sign is ignored). Writes the ASCII
+// digits (no terminator) and the decimal exponent of the first digit, so
+// value = d.ddd  10^exponent. Returns the number of digits (1 to 9).
+int NumFormat_Shortest(float value, char* digits, int* exponent);
+
+// Number of decimal digits in value (1 for 0)
+int NumFormat_DigitCount(uint32_t value);
+
+// Write exactly length digits of value, two digits per step (no terminator)
+void NumFormat_WriteDigits(char* digits, uint32_t value, int length);
+
+// Lay out d.ddd  10^exponent in at most 16 columns (and buffer_size - 1):
+// fixed notation when the integer part fits, rounding off surplus fraction
+// digits, otherwise d.dddEnn (Ennn from 100 on). digits[] (ASCII, no
+// terminator) is modified.
+void NumFormat_Layout(char* buffer, int buffer_size, int negative,
+                      char* digits, int count, int exponent);
+
+// Format a float for display (shortest digits, NaN/Inf spelled out)
+void NumFormat_Float(char* buffer, float number, int buffer_size);
+
+#endif // NUMFORMAT_H
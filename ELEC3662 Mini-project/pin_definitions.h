@@ -8,12 +8,55 @@
 
 // System Control Registers
 #define SYSCTL_RCGC2_R      (*((volatile unsigned long *)0x400FE108))
+#define SYSCTL_RCGCTIMER_R  (*((volatile unsigned long *)0x400FE604))
+#define SYSCTL_RCGCDMA_R    (*((volatile unsigned long *)0x400FE60C))
 
 // SysTick Timer Registers
 #define NVIC_ST_CTRL_R      (*((volatile unsigned long *)0xE000E010))
 #define NVIC_ST_RELOAD_R    (*((volatile unsigned long *)0xE000E014))
 #define NVIC_ST_CURRENT_R   (*((volatile unsigned long *)0xE000E018))
 
+// NVIC Registers (Timer 0B is interrupt 20, Timer 1A 21)
+#define NVIC_EN0_R          (*((volatile unsigned long *)0xE000E100))
+#define NVIC_PEND0_R        (*((volatile unsigned long *)0xE000E200))
+#define NVIC_PRI5_R         (*((volatile unsigned long *)0xE000E414))
+#define NVIC_TIMER0B_BIT    (1UL << 20)
+#define NVIC_TIMER1A_BIT    (1UL << 21)
+
+// Timer 0 Registers (LCD_DMA_REFRESH: paces the uDMA refresh)
+#define TIMER0_CFG_R        (*((volatile unsigned long *)0x40030000))
+#define TIMER0_TAMR_R       (*((volatile unsigned long *)0x40030004))
+#define TIMER0_TBMR_R       (*((volatile unsigned long *)0x40030008))
+#define TIMER0_CTL_R        (*((volatile unsigned long *)0x4003000C))
+#define TIMER0_IMR_R        (*((volatile unsigned long *)0x40030018))
+#define TIMER0_ICR_R        (*((volatile unsigned long *)0x40030024))
+#define TIMER0_TAILR_R      (*((volatile unsigned long *)0x40030028))
+#define TIMER0_TBILR_R      (*((volatile unsigned long *)0x4003002C))
+
+// Timer 1 Registers (the LCD write queue)
+#define TIMER1_CFG_R        (*((volatile unsigned long *)0x40031000))
+#define TIMER1_TAMR_R       (*((volatile unsigned long *)0x40031004))
+#define TIMER1_CTL_R        (*((volatile unsigned long *)0x4003100C))
+#define TIMER1_IMR_R        (*((volatile unsigned long *)0x40031018))
+#define TIMER1_ICR_R        (*((volatile unsigned long *)0x40031024))
+#define TIMER1_TAILR_R      (*((volatile unsigned long *)0x40031028))
+
+// uDMA Registers
+#define UDMA_CFG_R          (*((volatile unsigned long *)0x400FF004))
+#define UDMA_CTLBASE_R      (*((volatile unsigned long *)0x400FF008))
+#define UDMA_USEBURSTCLR_R  (*((volatile unsigned long *)0x400FF01C))
+#define UDMA_REQMASKCLR_R   (*((volatile unsigned long *)0x400FF024))
+#define UDMA_ENASET_R       (*((volatile unsigned long *)0x400FF028))
+#define UDMA_ALTCLR_R       (*((volatile unsigned long *)0x400FF034))
+#define UDMA_PRIOCLR_R      (*((volatile unsigned long *)0x400FF03C))
+#define UDMA_CHIS_R         (*((volatile unsigned long *)0x400FF504))
+#define UDMA_CHMAP2_R       (*((volatile unsigned long *)0x400FF518))
+
+// Debug / Trace Registers (DWT cycle counter)
+#define NVIC_DBG_DEMCR_R    (*((volatile unsigned long *)0xE000EDFC))
+#define DWT_CTRL_R          (*((volatile unsigned long *)0xE0001000))
+#define DWT_CYCCNT_R        (*((volatile unsigned long *)0xE0001004))
+
 // GPIO Port A Registers
 #define GPIO_PORTA_LOCK_R   (*((volatile unsigned long *)0x40004520))
 #define GPIO_PORTA_CR_R     (*((volatile unsigned long *)0x40004524))
@@ -34,6 +77,15 @@
 #define GPIO_PORTB_PCTL_R   (*((volatile unsigned long *)0x4000552C))
 #define GPIO_PORTB_DATA_R   (*((volatile unsigned long *)0x400053FC))
 
+// Masked GPIO data: address bits 9:2 select the pins a write changes, so
+// the LCD (from its interrupt) and the keypad share Port B without a
+// read-modify-write undoing the other's bits
+#define LCD_EN_R            (*((volatile unsigned long *)0x40004010))  // PA2
+#define LCD_RS_R            (*((volatile unsigned long *)0x40004020))  // PA3
+#define LCD_CTRL_R          (*((volatile unsigned long *)0x40004030))  // PA2-3
+#define LCD_DATA_R          (*((volatile unsigned long *)0x400053C0))  // PB4-7
+#define KEYPAD_COL_R        (*((volatile unsigned long *)0x4000503C))  // PB0-3
+
 // GPIO Port E Registers
 #define GPIO_PORTE_LOCK_R   (*((volatile unsigned long *)0x40024520))
 #define GPIO_PORTE_CR_R     (*((volatile unsigned long *)0x40024524))
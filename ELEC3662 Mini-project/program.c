@@ -0,0 +1,365 @@
+/*
+ * Keystroke Program Implementation
+ *
+ * The interpreter works on X, Y, Z and T in place in the caller's stack
+ * (the Calculator context), so a run keeps no copies of them on the main
+ * stack; only the lift flag is held in a local and written back at the
+ * end. Handlers are written once, between PROGRAM_HANDLER() and
+ * PROGRAM_NEXT(); the two macro sets below turn them into computed-goto
+ * threaded code or into switch cases.
+ */
+
+#include "program.h"
+
+#if defined(__GNUC__)
+#define PROGRAM_THREADED    1
+#else
+#define PROGRAM_THREADED    0
+#endif
+
+// Code bytes of each instruction with fixed operands (numbers vary)
+static const unsigned char program_op_size[PROGRAM_OPCODES] = {
+    [PROGRAM_OP_STORE]       = 2,
+    [PROGRAM_OP_RECALL]      = 2,
+    [PROGRAM_OP_LABEL]       = 2,
+    [PROGRAM_OP_GOTO]        = 2,
+    [PROGRAM_OP_IF_ZERO]     = 2,
+    [PROGRAM_OP_IF_NEGATIVE] = 2,
+    [PROGRAM_OP_DSZ]         = 3
+};
+
+// Code bytes of the instruction at pc
+static int Program_Size(const unsigned char* code, int pc) {
+    if(code[pc] == PROGRAM_OP_NUMBER) {
+        int size = 3;                           // Opcode, places, last mantissa byte
+        while(code[pc + size - 1] & 0x80) {
+            size++;
+        }
+        return size;
+    }
+    return program_op_size[code[pc]] ? program_op_size[code[pc]] : 1;
+}
+
+void Program_Clear(Program* program) {
+    program->code[0] = PROGRAM_OP_END;
+    program->length = 0;
+    program->count = 0;
+    program->linked = 0;
+}
+
+ProgramStatus Program_EmitOperand(Program* program, ProgramOpcode op, int operand) {
+    int size = program_op_size[op] ? program_op_size[op] : 1;
+    unsigned char* code = program->code + program->length;
+
+    // One byte is always kept for the PROGRAM_OP_END after the last instruction
+    if(program->length + size >= PROGRAM_MAX_BYTES) {
+        return PROGRAM_FULL;
+    }
+    code[0] = (unsigned char)op;
+    if(size > 1) code[1] = (unsigned char)operand;
+    if(size > 2) code[2] = 0;                   // Jump address, filled in by Program_Link
+    code[size] = PROGRAM_OP_END;
+    program->length += size;
+    program->count++;
+    program->linked = 0;
+    return PROGRAM_OK;
+}
+
+ProgramStatus Program_Emit(Program* program, ProgramOpcode op) {
+    return Program_EmitOperand(program, op, 0);
+}
+
+ProgramStatus Program_EmitNumber(Program* program, unsigned long long mantissa, int decimal_places) {
+    unsigned char bytes[12];
+    int count = 0;
+
+    // Least significant 7 bits first; the top bit marks "more to come"
+    do {
+        bytes[count] = (unsigned char)(mantissa & 0x7F);
+        mantissa >>= 7;
+        if(mantissa != 0) {
+            bytes[count] |= 0x80;
+        }
+        count++;
+    } while(mantissa != 0);
+
+    if(program->length + 2 + count >= PROGRAM_MAX_BYTES) {
+        return PROGRAM_FULL;
+    }
+    unsigned char* code = program->code + program->length;
+    code[0] = PROGRAM_OP_NUMBER;
+    code[1] = (unsigned char)decimal_places;
+    for(int i = 0; i < count; i++) {
+        code[2 + i] = bytes[i];
+    }
+    code[2 + count] = PROGRAM_OP_END;
+    program->length += 2 + count;
+    program->count++;
+    program->linked = 0;
+    return PROGRAM_OK;
+}
+
+// Address just past the instruction after the one at pc (the end if there
+// is none): where a test or DSZ goes when it does not hold
+static unsigned char Program_Skip(const Program* program, int pc) {
+    int next = pc + Program_Size(program->code, pc);
+    if(next < program->length) {
+        next += Program_Size(program->code, next);
+    }
+    return (unsigned char)next;
+}
+
+ProgramStatus Program_Link(Program* program) {
+    unsigned char* code = program->code;
+    int label[PROGRAM_LABELS];
+    int pc;
+
+    if(program->linked) {
+        return PROGRAM_OK;
+    }
+    for(int i = 0; i < PROGRAM_LABELS; i++) {
+        label[i] = -1;
+    }
+    // A jump goes past its label, so the label is never executed
+    for(pc = 0; pc < program->length; pc += Program_Size(code, pc)) {
+        if(code[pc] == PROGRAM_OP_LABEL && label[code[pc + 1]] < 0) {
+            label[code[pc + 1]] = pc + 2;
+        }
+    }
+    for(pc = 0; pc < program->length; pc += Program_Size(code, pc)) {
+        switch(code[pc]) {
+            case PROGRAM_OP_GOTO:
+                if(label[code[pc + 1]] < 0) {
+                    return PROGRAM_NO_LABEL;
+                }
+                code[pc + 1] = (unsigned char)label[code[pc + 1]];
+                break;
+            case PROGRAM_OP_IF_ZERO:
+            case PROGRAM_OP_IF_NEGATIVE:
+                code[pc + 1] = Program_Skip(program, pc);
+                break;
+            case PROGRAM_OP_DSZ:
+                code[pc + 2] = Program_Skip(program, pc);
+                break;
+            default:
+                break;
+        }
+    }
+    program->linked = 1;
+    return PROGRAM_OK;
+}
+
+// Push a value as a typed number does: X moves up first unless the lift
+// is off (after ENTER or clear X)
+#define PROGRAM_PUSH(value)     do { if(lift) { *t = *z; *z = *y; *y = *x; } *x = (value); lift = 1; } while(0)
+
+// Y (op) X into X; the stack drops and T is kept
+#define PROGRAM_BINARY(result)  do { *x = (result); *y = *z; *z = *t; lift = 1; } while(0)
+
+#if PROGRAM_THREADED
+#define PROGRAM_HANDLER(op)     handle_##op
+#define PROGRAM_DISPATCH()      do { if(++count > PROGRAM_MAX_STEPS) goto too_long; \
+                                     goto *handlers[code[pc]]; } while(0)
+#define PROGRAM_NEXT(size)      do { pc += (size); PROGRAM_DISPATCH(); } while(0)
+#define PROGRAM_JUMP(address)   do { pc = (address); PROGRAM_DISPATCH(); } while(0)
+#else
+#define PROGRAM_HANDLER(op)     case op
+#define PROGRAM_NEXT(size)      pc += (size); continue
+#define PROGRAM_JUMP(address)   pc = (address); continue
+#endif
+
+ProgramStatus Program_Run(const Program* program, const ProgramMachine* machine, long* steps) {
+    const unsigned char* code = program->code;
+    CalcNumber* registers = machine->registers;
+    CalcNumber* x = &machine->stack[0];
+    CalcNumber* y = &machine->stack[1];
+    CalcNumber* z = &machine->stack[2];
+    CalcNumber* t = &machine->stack[3];
+    int lift = *machine->lift;
+    ProgramStatus status = PROGRAM_OK;
+    long count = 0;
+    int pc = 0;
+
+    Number_ClearExceptions();
+
+#if PROGRAM_THREADED
+    static const void* const handlers[PROGRAM_OPCODES] = {
+        [PROGRAM_OP_END]         = &&handle_PROGRAM_OP_END,
+        [PROGRAM_OP_NUMBER]      = &&handle_PROGRAM_OP_NUMBER,
+        [PROGRAM_OP_ENTER]       = &&handle_PROGRAM_OP_ENTER,
+        [PROGRAM_OP_ADD]         = &&handle_PROGRAM_OP_ADD,
+        [PROGRAM_OP_SUBTRACT]    = &&handle_PROGRAM_OP_SUBTRACT,
+        [PROGRAM_OP_MULTIPLY]    = &&handle_PROGRAM_OP_MULTIPLY,
+        [PROGRAM_OP_DIVIDE]      = &&handle_PROGRAM_OP_DIVIDE,
+        [PROGRAM_OP_POWER]       = &&handle_PROGRAM_OP_POWER,
+        [PROGRAM_OP_SCALE10]     = &&handle_PROGRAM_OP_SCALE10,
+        [PROGRAM_OP_SQRT]        = &&handle_PROGRAM_OP_SQRT,
+        [PROGRAM_OP_SIN]         = &&handle_PROGRAM_OP_SIN,
+        [PROGRAM_OP_COS]         = &&handle_PROGRAM_OP_COS,
+        [PROGRAM_OP_TAN]         = &&handle_PROGRAM_OP_TAN,
+        [PROGRAM_OP_LN]          = &&handle_PROGRAM_OP_LN,
+        [PROGRAM_OP_LOG10]       = &&handle_PROGRAM_OP_LOG10,
+        [PROGRAM_OP_EXP]         = &&handle_PROGRAM_OP_EXP,
+        [PROGRAM_OP_ROLL]        = &&handle_PROGRAM_OP_ROLL,
+        [PROGRAM_OP_SWAP]        = &&handle_PROGRAM_OP_SWAP,
+        [PROGRAM_OP_CLEAR_X]     = &&handle_PROGRAM_OP_CLEAR_X,
+        [PROGRAM_OP_CLEAR_STACK] = &&handle_PROGRAM_OP_CLEAR_STACK,
+        [PROGRAM_OP_STORE]       = &&handle_PROGRAM_OP_STORE,
+        [PROGRAM_OP_RECALL]      = &&handle_PROGRAM_OP_RECALL,
+        [PROGRAM_OP_LABEL]       = &&handle_PROGRAM_OP_LABEL,
+        [PROGRAM_OP_GOTO]        = &&handle_PROGRAM_OP_GOTO,
+        [PROGRAM_OP_IF_ZERO]     = &&handle_PROGRAM_OP_IF_ZERO,
+        [PROGRAM_OP_IF_NEGATIVE] = &&handle_PROGRAM_OP_IF_NEGATIVE,
+        [PROGRAM_OP_DSZ]         = &&handle_PROGRAM_OP_DSZ
+    };
+    PROGRAM_DISPATCH();
+    {
+#else
+    for(;;) {
+        if(++count > PROGRAM_MAX_STEPS) {
+            goto too_long;
+        }
+        switch(code[pc]) {
+#endif
+    PROGRAM_HANDLER(PROGRAM_OP_NUMBER): {
+        unsigned long long mantissa = 0;
+        int size = 2;
+        int shift = 0;
+        do {
+            mantissa |= (unsigned long long)(code[pc + size] & 0x7F) << shift;
+            shift += 7;
+        } while(code[pc + size++] & 0x80);
+        PROGRAM_PUSH(Number_FromInput(mantissa, code[pc + 1]));
+        PROGRAM_NEXT(size);
+    }
+    PROGRAM_HANDLER(PROGRAM_OP_ENTER):
+        *t = *z;
+        *z = *y;
+        *y = *x;
+        lift = 0;
+        PROGRAM_NEXT(1);
+    PROGRAM_HANDLER(PROGRAM_OP_ADD):
+        PROGRAM_BINARY(Number_Add(*y, *x));
+        PROGRAM_NEXT(1);
+    PROGRAM_HANDLER(PROGRAM_OP_SUBTRACT):
+        PROGRAM_BINARY(Number_Subtract(*y, *x));
+        PROGRAM_NEXT(1);
+    PROGRAM_HANDLER(PROGRAM_OP_MULTIPLY):
+        PROGRAM_BINARY(Number_Multiply(*y, *x));
+        PROGRAM_NEXT(1);
+    PROGRAM_HANDLER(PROGRAM_OP_DIVIDE):
+        if(Number_IsZero(*x)) {
+            status = PROGRAM_DIV_ZERO;
+            goto stop;
+        }
+        PROGRAM_BINARY(Number_Divide(*y, *x));
+        PROGRAM_NEXT(1);
+    PROGRAM_HANDLER(PROGRAM_OP_POWER):
+        PROGRAM_BINARY(Number_Power(*y, *x));
+        PROGRAM_NEXT(1);
+    PROGRAM_HANDLER(PROGRAM_OP_SCALE10): {
+        // Exponent clamped to the display range, as for the E key
+        float exponent = Number_ToFloat(*x);
+        if(exponent > 99.0f) exponent = 99.0f;
+        if(exponent < -99.0f) exponent = -99.0f;
+        PROGRAM_BINARY(Number_Scale10(*y, (int)exponent));
+        PROGRAM_NEXT(1);
+    }
+    PROGRAM_HANDLER(PROGRAM_OP_SQRT):
+        *x = Number_Sqrt(*x);
+        lift = 1;
+        PROGRAM_NEXT(1);
+    PROGRAM_HANDLER(PROGRAM_OP_SIN):
+        *x = Number_Sin(*x);
+        lift = 1;
+        PROGRAM_NEXT(1);
+    PROGRAM_HANDLER(PROGRAM_OP_COS):
+        *x = Number_Cos(*x);
+        lift = 1;
+        PROGRAM_NEXT(1);
+    PROGRAM_HANDLER(PROGRAM_OP_TAN):
+        *x = Number_Tan(*x);
+        lift = 1;
+        PROGRAM_NEXT(1);
+    PROGRAM_HANDLER(PROGRAM_OP_LN):
+        *x = Number_Ln(*x);
+        lift = 1;
+        PROGRAM_NEXT(1);
+    PROGRAM_HANDLER(PROGRAM_OP_LOG10):
+        *x = Number_Log10(*x);
+        lift = 1;
+        PROGRAM_NEXT(1);
+    PROGRAM_HANDLER(PROGRAM_OP_EXP):
+        *x = Number_Exp(*x);
+        lift = 1;
+        PROGRAM_NEXT(1);
+    PROGRAM_HANDLER(PROGRAM_OP_ROLL): {
+        CalcNumber swap = *x;
+        *x = *y;
+        *y = *z;
+        *z = *t;
+        *t = swap;
+        lift = 1;
+        PROGRAM_NEXT(1);
+    }
+    PROGRAM_HANDLER(PROGRAM_OP_SWAP): {
+        CalcNumber swap = *x;
+        *x = *y;
+        *y = swap;
+        lift = 1;
+        PROGRAM_NEXT(1);
+    }
+    PROGRAM_HANDLER(PROGRAM_OP_CLEAR_X):
+        *x = Number_Zero();
+        lift = 0;
+        PROGRAM_NEXT(1);
+    PROGRAM_HANDLER(PROGRAM_OP_CLEAR_STACK):
+        *x = *y = *z = *t = Number_Zero();
+        lift = 0;
+        PROGRAM_NEXT(1);
+    PROGRAM_HANDLER(PROGRAM_OP_STORE):
+        registers[code[pc + 1]] = *x;
+        lift = 1;
+        PROGRAM_NEXT(2);
+    PROGRAM_HANDLER(PROGRAM_OP_RECALL):
+        PROGRAM_PUSH(registers[code[pc + 1]]);
+        PROGRAM_NEXT(2);
+    PROGRAM_HANDLER(PROGRAM_OP_LABEL):
+        PROGRAM_NEXT(2);
+    PROGRAM_HANDLER(PROGRAM_OP_GOTO):
+        PROGRAM_JUMP(code[pc + 1]);
+    PROGRAM_HANDLER(PROGRAM_OP_IF_ZERO):
+        if(Number_IsZero(*x)) {
+            PROGRAM_NEXT(2);
+        }
+        PROGRAM_JUMP(code[pc + 1]);
+    PROGRAM_HANDLER(PROGRAM_OP_IF_NEGATIVE):
+        if(Number_ToFloat(*x) < 0.0f) {
+            PROGRAM_NEXT(2);
+        }
+        PROGRAM_JUMP(code[pc + 1]);
+    PROGRAM_HANDLER(PROGRAM_OP_DSZ): {
+        CalcNumber* counter = &registers[code[pc + 1]];
+        *counter = Number_Subtract(*counter, Number_FromInt64(1));
+        if(Number_IsZero(*counter)) {
+            PROGRAM_JUMP(code[pc + 2]);
+        }
+        PROGRAM_NEXT(3);
+    }
+    PROGRAM_HANDLER(PROGRAM_OP_END):
+        count--;                    // Not counted as a step
+        goto stop;
+#if !PROGRAM_THREADED
+    default:
+        goto stop;
+        }
+#endif
+    }
+
+too_long:
+    status = PROGRAM_TOO_LONG;
+stop:
+    *machine->lift = lift;
+    *steps = count;
+    return status;
+}
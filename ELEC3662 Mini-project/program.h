@@ -0,0 +1,105 @@
+/*
+ * Keystroke Program Header
+ *
+ * Programs recorded from RPN mode keys, stored as a compact bytecode: one
+ * opcode byte, then any operands. A number typed in the program is one
+ * PROGRAM_OP_NUMBER with its decimal places and digits (7 bits per byte),
+ * not a digit per key, so it costs one dispatch when the program runs.
+ *
+ * Labels, GTO, the x=0? / x<0? tests and DSZ are recorded with label and
+ * register numbers. Program_Link then turns every jump into a byte
+ * address, so GTO costs the same as any other instruction: nothing is
+ * searched while the program runs. A test, and DSZ, run the next
+ * instruction only if they hold (HP style); linked, they are conditional
+ * jumps over it.
+ *
+ * Program_Run is a threaded-code interpreter: each handler ends by
+ * jumping straight to the next opcode's handler through a table of label
+ * addresses (GCC's computed goto, supported by GCC, Clang and Arm
+ * Compiler 6). Other compilers get the same handlers in a switch.
+ */
+
+#ifndef PROGRAM_H
+#define PROGRAM_H
+
+#include "number.h"
+
+// Bytes per program (jump addresses are one byte, so at most 256)
+#ifndef PROGRAM_MAX_BYTES
+#define PROGRAM_MAX_BYTES       96
+#endif
+#define PROGRAM_REGISTERS       10      // R0-R9 for STO, RCL and DSZ
+#define PROGRAM_LABELS          10      // LBL 0-9
+#define PROGRAM_STACK           4       // X, Y, Z, T
+
+// Instructions per run, so a program that never stops still returns
+#ifndef PROGRAM_MAX_STEPS
+#define PROGRAM_MAX_STEPS       100000L
+#endif
+
+typedef enum {
+    PROGRAM_OP_END = 0,             // Stop (also the byte after the last instruction)
+    PROGRAM_OP_NUMBER,              // Decimal places, then the mantissa, 7 bits per byte
+    PROGRAM_OP_ENTER,
+    PROGRAM_OP_ADD,                 // Y (op) X
+    PROGRAM_OP_SUBTRACT,
+    PROGRAM_OP_MULTIPLY,
+    PROGRAM_OP_DIVIDE,
+    PROGRAM_OP_POWER,
+    PROGRAM_OP_SCALE10,
+    PROGRAM_OP_SQRT,                // f(X)
+    PROGRAM_OP_SIN,
+    PROGRAM_OP_COS,
+    PROGRAM_OP_TAN,
+    PROGRAM_OP_LN,
+    PROGRAM_OP_LOG10,
+    PROGRAM_OP_EXP,
+    PROGRAM_OP_ROLL,                // Roll down
+    PROGRAM_OP_SWAP,                // X <-> Y
+    PROGRAM_OP_CLEAR_X,
+    PROGRAM_OP_CLEAR_STACK,
+    PROGRAM_OP_STORE,               // Register
+    PROGRAM_OP_RECALL,              // Register
+    PROGRAM_OP_LABEL,               // Label (a no-op when run)
+    PROGRAM_OP_GOTO,                // Label, linked to an address
+    PROGRAM_OP_IF_ZERO,             // x=0?: address past the next instruction once linked
+    PROGRAM_OP_IF_NEGATIVE,         // x<0?: as x=0?
+    PROGRAM_OP_DSZ,                 // Register and address: decrement, skip the next instruction at 0
+    PROGRAM_OPCODES
+} ProgramOpcode;
+
+typedef struct {
+    unsigned char code[PROGRAM_MAX_BYTES];
+    int length;                     // Code bytes used
+    int count;                      // Instructions recorded
+    int linked;                     // 1 once Program_Link has resolved the jumps
+} Program;
+
+typedef enum {
+    PROGRAM_OK = 0,
+    PROGRAM_FULL,                   // No room for the instruction
+    PROGRAM_NO_LABEL,               // GTO to a label the program does not have
+    PROGRAM_DIV_ZERO,
+    PROGRAM_TOO_LONG                // PROGRAM_MAX_STEPS ran out
+} ProgramStatus;
+
+// The registers a program runs on: the RPN stack, its lift flag (1 if a
+// number pushes X up rather than replacing it) and R0-R9
+typedef struct {
+    CalcNumber* stack;
+    int*        lift;
+    CalcNumber* registers;
+} ProgramMachine;
+
+// Recording
+void          Program_Clear(Program* program);
+ProgramStatus Program_Emit(Program* program, ProgramOpcode op);
+ProgramStatus Program_EmitOperand(Program* program, ProgramOpcode op, int operand);
+ProgramStatus Program_EmitNumber(Program* program, unsigned long long mantissa, int decimal_places);
+ProgramStatus Program_Link(Program* program);
+
+// Run a linked program; *steps is the number of instructions executed.
+// Number exceptions are left in the backend's flags for the caller.
+ProgramStatus Program_Run(const Program* program, const ProgramMachine* machine, long* steps);
+
+#endif // PROGRAM_H
@@ -0,0 +1,182 @@
+/*
+ * RF Conversion Implementation
+ *
+ * log10(x): x = 10^k  m with m in [1, 10) (k from the binary exponent,
+ * m by one division by a table power, so a whole decade gives m = 1
+ * exactly). Then m = 2^j  c  (1 + r), with c = 1 + i/32 taken from the
+ * top 5 mantissa bits and r in [0, 1/32):
+ *   log10(x) = k + jlog10(2) + log10(c) + log10(1 + r)
+ * where log10(c) comes from the table and log10(1 + r) from 4 terms of
+ * its series.
+ *
+ * 10^x: x = k + i/32 + s with k whole and s in [0, 1/32):
+ *   10^x = 10^k  10^(i/32)  10^s
+ * with both powers from tables and 10^s from 5 terms of its series.
+ */
+
+#include "rf.h"
+#include <stdint.h>
+#include <string.h>
+
+#define RF_TABLE_SIZE       32
+#define RF_POW10_MAX        38
+
+#define RF_LOG10_2          0.301029996f
+
+// Volatile so it is read at run time and the division raises Invalid
+static volatile float rf_zero = 0.0f;
+
+// log10(1 + i/32) and 1 / (1 + i/32), for the log10 table
+static const float rf_log10_table[RF_TABLE_SIZE] = {
+    0.0f, 0.0133639611f, 0.0263289381f, 0.0389180668f,
+    0.0511525236f, 0.0630517453f, 0.0746336207f, 0.0859146267f,
+    0.0969100147f, 0.107633881f, 0.11809931f, 0.128318474f,
+    0.138302699f, 0.148062542f, 0.157607853f, 0.166947886f,
+    0.176091254f, 0.185046107f, 0.193820029f, 0.202420205f,
+    0.210853368f, 0.219125897f, 0.227243781f, 0.235212713f,
+    0.243038043f, 0.250724882f, 0.258278012f, 0.265702039f,
+    0.273001283f, 0.280179858f, 0.287241697f, 0.294190586f
+};
+
+static const float rf_inverse_table[RF_TABLE_SIZE] = {
+    1.0f, 0.969696999f, 0.941176474f, 0.914285719f,
+    0.888888896f, 0.864864886f, 0.842105269f, 0.820512831f,
+    0.800000012f, 0.780487776f, 0.761904776f, 0.744186044f,
+    0.727272749f, 0.711111128f, 0.695652187f, 0.680851042f,
+    0.666666687f, 0.653061211f, 0.639999986f, 0.627451003f,
+    0.615384638f, 0.603773594f, 0.592592597f, 0.581818163f,
+    0.571428597f, 0.561403513f, 0.551724136f, 0.542372882f,
+    0.533333361f, 0.524590135f, 0.516129017f, 0.507936537f
+};
+
+// 10^(i/32), for the exp10 table
+static const float rf_exp10_table[RF_TABLE_SIZE] = {
+    1.0f, 1.07460785f, 1.15478194f, 1.24093771f,
+    1.33352149f, 1.4330126f, 1.53992653f, 1.6548171f,
+    1.77827942f, 1.91095293f, 2.05352497f, 2.20673418f,
+    2.37137365f, 2.54829669f, 2.73841953f, 2.94272709f,
+    3.1622777f, 3.39820838f, 3.65174127f, 3.92418981f,
+    4.2169652f, 4.53158379f, 4.86967516f, 5.23299122f,
+    5.62341309f, 6.04296398f, 6.49381638f, 6.97830582f,
+    7.4989419f, 8.05842209f, 8.65964317f, 9.30572033f
+};
+
+// 10^-38 .. 10^38, each the float nearest the exact power (index k + 38)
+static const float rf_pow10[2 * RF_POW10_MAX + 1] = {
+    1e-38f, 1e-37f, 1e-36f, 1e-35f, 1e-34f, 1e-33f, 1e-32f, 1e-31f,
+    1e-30f, 1e-29f, 1e-28f, 1e-27f, 1e-26f, 1e-25f, 1e-24f, 1e-23f,
+    1e-22f, 1e-21f, 1e-20f, 1e-19f, 1e-18f, 1e-17f, 1e-16f, 1e-15f,
+    1e-14f, 1e-13f, 1e-12f, 1e-11f, 1e-10f, 1e-9f, 1e-8f, 1e-7f,
+    1e-6f, 1e-5f, 1e-4f, 1e-3f, 1e-2f, 1e-1f, 1e0f, 1e1f,
+    1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f,
+    1e10f, 1e11f, 1e12f, 1e13f, 1e14f, 1e15f, 1e16f, 1e17f,
+    1e18f, 1e19f, 1e20f, 1e21f, 1e22f, 1e23f, 1e24f, 1e25f,
+    1e26f, 1e27f, 1e28f, 1e29f, 1e30f, 1e31f, 1e32f, 1e33f,
+    1e34f, 1e35f, 1e36f, 1e37f, 1e38f
+};
+
+static float Rf_Pow10(int k) {
+    return rf_pow10[k + RF_POW10_MAX];
+}
+
+float Rf_Log10(float x) {
+    float offset = 0.0f;
+    uint32_t bits;
+
+    if(!(x > 0.0f)) {
+        return rf_zero / rf_zero;           // Negative, zero or NaN
+    }
+    if(x - x != 0.0f) {
+        return x;                           // +Inf
+    }
+    if(x < 1e-30f) {
+        // Tiny and subnormal: scale up first (the only inexact decade step)
+        x *= 1e30f;
+        offset = -30.0f;
+    }
+
+    // 2^e <= x < 2^(e+1), so k is floor(elog10 2) or one more
+    memcpy(&bits, &x, sizeof bits);
+    float e = (float)((int)(bits >> 23) - 127);
+    int k = (int)(e * RF_LOG10_2);
+    if((float)k > e * RF_LOG10_2) {
+        k--;                                // Round toward -Inf
+    }
+    float m = x / Rf_Pow10(k);
+    if(m >= 10.0f) {
+        k++;
+        m = x / Rf_Pow10(k);
+    }
+
+    // m = 2^j  (1 + f), then 1 + f = c  (1 + r); m - c is exact
+    memcpy(&bits, &m, sizeof bits);
+    int j = (int)(bits >> 23) - 127;
+    int i = (int)((bits >> 18) & (RF_TABLE_SIZE - 1));
+    uint32_t c_bits = (bits & 0x007C0000u) | 0x3F800000u;
+    uint32_t f_bits = (bits & 0x007FFFFFu) | 0x3F800000u;
+    float c, f;
+    memcpy(&c, &c_bits, sizeof c);
+    memcpy(&f, &f_bits, sizeof f);
+    float r = (f - c) * rf_inverse_table[i];
+    float series = (((-0.108573620f * r + 0.144764827f) * r - 0.217147241f) * r
+                    + 0.434294482f) * r;
+
+    return ((float)k + offset) + ((float)j * RF_LOG10_2 + (rf_log10_table[i] + series));
+}
+
+float Rf_Exp10(float x) {
+    if(x != x) {
+        return x;
+    }
+    // Past the float range the result overflows or underflows below, with
+    // the flag raised by the multiply
+    if(x > 39.0f) x = 39.0f;
+    if(x < -46.0f) x = -46.0f;
+
+    int k = (int)x;
+    if((float)k > x) {
+        k--;                                // Round toward -Inf
+    }
+    float f = x - (float)k;                 // [0, 1]
+    if(f >= 1.0f) {
+        // Only for tiny negative x, where x - k rounds up to 1
+        f = 0.0f;
+        k++;
+    }
+    int i = (int)(f * RF_TABLE_SIZE);
+    float s = f - (float)i * (1.0f / RF_TABLE_SIZE);     // [0, 1/32), exact
+    // 10^s = e^(sln 10), the series with the powers of ln 10 folded in
+    float y = rf_exp10_table[i] * ((((1.17125514f * s + 2.03467859f) * s + 2.65094905f) * s
+                                    + 2.30258509f) * s + 1.0f);
+
+    // 10^k in at most two steps (only needed below 10^-38)
+    if(k < -RF_POW10_MAX) {
+        y *= Rf_Pow10(-RF_POW10_MAX);
+        k += RF_POW10_MAX;
+    } else if(k > RF_POW10_MAX) {
+        y *= Rf_Pow10(RF_POW10_MAX);
+        k -= RF_POW10_MAX;
+    }
+    return y * Rf_Pow10(k);
+}
+
+float Rf_FromDb(float db) {
+    // Divided rather than multiplied by 0.1, so 30 dB is exactly 10^3
+    return Rf_Exp10(db / 10.0f);
+}
+
+float Rf_ToDb(float ratio) {
+    return 10.0f * Rf_Log10(ratio);
+}
+
+float Rf_Wavelength(float x) {
+    if(x == 0.0f) {
+        return rf_zero / rf_zero;
+    }
+    return RF_LIGHT_SPEED / x;
+}
+
+float Rf_PathLoss(float km, float mhz) {
+    // Two logs rather than the log of the product, which could overflow
+    return 20.0f * Rf_Log10(km) + 20.0f * Rf_Log10(mhz) + RF_PATH_LOSS_KM_MHZ;
+}
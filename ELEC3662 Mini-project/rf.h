@@ -0,0 +1,46 @@
+/*
+ * RF Conversion Header
+ *
+ * The conversions radio work keeps coming back to: dB and power ratios
+ * (dBm and mW are the same conversion, referred to 1 mW), frequency and
+ * wavelength, and free-space path loss. They rest on two table-driven
+ * kernels, Rf_Log10 and Rf_Exp10: the argument is split into a power of
+ * ten and a remainder, the remainder is looked up in a 32-entry table and
+ * a short polynomial refines it. That is less work than the full-accuracy
+ * kernels in mathfn.c, and the decade split keeps whole decades exact, so
+ * 1000 mW is 30 dBm and 30 dBm is 1000 mW, not 29.999998.
+ *
+ * Error bounds, measured on the host against double-precision libm (every
+ * 7th float), far inside the 0.01 dB a link budget needs:
+ *   Rf_Log10   1E-7 absolute where |log10(x)| < 1, 1.3 ULPs elsewhere
+ *   Rf_Exp10   3.8 ULPs (1E-6 dB)                    results in the normal range
+ * A whole power of ten is exact both ways (10^-38 to 10^38).
+ *
+ * Invalid arguments (a log of x <= 0, a wavelength of 0) return NaN and
+ * results out of range return Inf or 0, raising the FPU flags the engine
+ * checks, as mathfn.c does.
+ */
+
+#ifndef RF_H
+#define RF_H
+
+// Speed of light in metres  MHz: wavelength (m) = RF_LIGHT_SPEED / f (MHz)
+#define RF_LIGHT_SPEED          299.792458f
+
+// 20log10(4pi / c) for d in km and f in MHz
+#define RF_PATH_LOSS_KM_MHZ     32.4477832f
+
+float Rf_Log10(float x);
+float Rf_Exp10(float x);
+
+// dB to a power ratio (dBm to mW), and back
+float Rf_FromDb(float db);
+float Rf_ToDb(float ratio);
+
+// Frequency (MHz) to wavelength (m); the same formula goes back
+float Rf_Wavelength(float x);
+
+// Free-space path loss in dB over km kilometres at mhz MHz
+float Rf_PathLoss(float km, float mhz);
+
+#endif // RF_H
@@ -0,0 +1,334 @@
+/*
+ * Equation Solver Implementation
+ *
+ * The interpreter keeps a value stack and a derivative stack side by side:
+ *   X            pushes (x, 1), a constant pushes (c, 0)
+ *   a + b        (a + b, a' + b')
+ *   a  b        (ab, a'b + ab')
+ *   f(a)         (f(a), f'(a)a')
+ * and so on, so one pass gives f(X) and f'(X). A derivative term is only
+ * worked out when its a' (or b') is non-zero, which skips the extra sin,
+ * cos or pow call for constant subexpressions and avoids 0  Inf. Without
+ * a derivative to return X pushes (x, 0), so no derivative term is ever
+ * worked out and the pass costs no more than a plain evaluation.
+ */
+
+#include "solve.h"
+#include "mathfn.h"
+#include <float.h>
+
+#define LN10                2.30258509299404568402f
+
+// A step below this fraction of |X| (about one unit in the last place) is
+// float rounding: X has converged
+#define SOLVE_TOLERANCE     FLT_EPSILON
+// Step halvings allowed when |f| grows (Newton overshooting)
+#define SOLVE_DAMPING       4
+
+// Solve_Evaluate's value and derivative stacks. Static rather than local:
+// the evaluator runs under Newton and the integrator, deep in the call
+// chain, and only ever from the main loop, so one copy is enough.
+static float solve_value[SOLVE_MAX_STACK];
+static float solve_slope[SOLVE_MAX_STACK];
+
+static int Solve_IsFinite(float value) {
+    return value - value == 0.0f;
+}
+
+static float Solve_Abs(float value) {
+    return (value < 0.0f) ? -value : value;
+}
+
+void Solve_Init(SolveProgram* program) {
+    program->length = 0;
+    program->constant_count = 0;
+    program->depth = 0;
+    program->uses_x = 0;
+}
+
+int Solve_EmitConstant(SolveProgram* program, float value) {
+    if(program->length + 2 > SOLVE_MAX_CODE || program->constant_count >= SOLVE_MAX_CONSTANTS ||
+       program->depth >= SOLVE_MAX_STACK) {
+        return 0;
+    }
+    program->code[program->length++] = SOLVE_OP_CONST;
+    program->code[program->length++] = (uint8_t)program->constant_count;
+    program->constants[program->constant_count++] = value;
+    program->depth++;
+    return 1;
+}
+
+int Solve_Emit(SolveProgram* program, SolveOpcode op) {
+    int operands = 1;                       // Functions replace the top value
+    int change = 0;
+
+    if(op == SOLVE_OP_CONST) {
+        return 0;                           // Needs its value: Solve_EmitConstant
+    }
+    if(op == SOLVE_OP_X) {
+        operands = 0;
+        change = 1;
+    } else if(op <= SOLVE_OP_POWER) {
+        operands = 2;                       // Binary: pop two, push one
+        change = -1;
+    }
+    if(program->length >= SOLVE_MAX_CODE || program->depth < operands ||
+       program->depth + change > SOLVE_MAX_STACK) {
+        return 0;
+    }
+    program->code[program->length++] = (uint8_t)op;
+    program->depth += change;
+    if(op == SOLVE_OP_X) {
+        program->uses_x = 1;
+    }
+    return 1;
+}
+
+int Solve_IsComplete(const SolveProgram* program) {
+    return program->depth == 1;
+}
+
+float Solve_Evaluate(const SolveProgram* program, float x, float* derivative) {
+    float* value = solve_value;
+    float* slope = solve_slope;
+    int top = -1;
+
+    for(int pc = 0; pc < program->length; pc++) {
+        uint8_t op = program->code[pc];
+        float a, da, b = 0.0f, db = 0.0f;
+        float result;
+        float dresult = 0.0f;
+
+        if(op == SOLVE_OP_CONST) {
+            top++;
+            value[top] = program->constants[program->code[++pc]];
+            slope[top] = 0.0f;
+            continue;
+        }
+        if(op == SOLVE_OP_X) {
+            top++;
+            value[top] = x;
+            slope[top] = (derivative != 0) ? 1.0f : 0.0f;
+            continue;
+        }
+        if(op <= SOLVE_OP_POWER) {
+            top--;
+            b = value[top + 1];
+            db = slope[top + 1];
+        }
+        a = value[top];
+        da = slope[top];
+
+        switch(op) {
+            case SOLVE_OP_ADD:
+                result = a + b;
+                dresult = da + db;
+                break;
+            case SOLVE_OP_SUBTRACT:
+                result = a - b;
+                dresult = da - db;
+                break;
+            case SOLVE_OP_MULTIPLY:
+                result = a * b;
+                if(da != 0.0f) dresult = da * b;
+                if(db != 0.0f) dresult += a * db;
+                break;
+            case SOLVE_OP_DIVIDE:
+                result = a / b;
+                if(da != 0.0f) dresult = da / b;
+                if(db != 0.0f) dresult -= result * db / b;
+                break;
+            case SOLVE_OP_SCALE10: {
+                // As the calculator's E: the exponent is clamped and truncated,
+                // so it is constant between whole numbers and has no slope
+                if(b > 99.0f) b = 99.0f;
+                if(b < -99.0f) b = -99.0f;
+                float scale = (b == b) ? MathFn_Pow(10.0f, (float)(int)b) : b;
+                result = a * scale;
+                if(da != 0.0f) dresult = da * scale;
+                break;
+            }
+            case SOLVE_OP_POWER:
+                result = MathFn_Pow(a, b);
+                if(da != 0.0f) dresult = b * MathFn_Pow(a, b - 1.0f) * da;
+                if(db != 0.0f) dresult += result * MathFn_Log(a) * db;
+                break;
+            case SOLVE_OP_SQRT:
+                result = MathFn_Sqrt(a);
+                if(da != 0.0f) dresult = 0.5f * da / result;
+                break;
+            case SOLVE_OP_SIN:
+                result = MathFn_Sin(a);
+                if(da != 0.0f) dresult = MathFn_Cos(a) * da;
+                break;
+            case SOLVE_OP_COS:
+                result = MathFn_Cos(a);
+                if(da != 0.0f) dresult = -MathFn_Sin(a) * da;
+                break;
+            case SOLVE_OP_TAN:
+                result = MathFn_Tan(a);
+                if(da != 0.0f) dresult = (1.0f + result * result) * da;
+                break;
+            case SOLVE_OP_LN:
+                result = MathFn_Log(a);
+                if(da != 0.0f) dresult = da / a;
+                break;
+            case SOLVE_OP_LOG10:
+                result = MathFn_Log10(a);
+                if(da != 0.0f) dresult = da / (a * LN10);
+                break;
+            default:                        // SOLVE_OP_EXP
+                result = MathFn_Exp(a);
+                if(da != 0.0f) dresult = result * da;
+                break;
+        }
+        value[top] = result;
+        slope[top] = dresult;
+    }
+
+    if(derivative != 0) {
+        *derivative = slope[0];
+    }
+    return value[0];
+}
+
+void Solve_Root(const SolveProgram* program, float x0, SolveResult* result) {
+    float x = x0;
+    float dfx;
+    float fx = Solve_Evaluate(program, x, &dfx);
+    float f0 = Solve_Abs(fx);
+    float last_x = x;                       // Previous point, for the secant step
+    float last_f = fx;
+    int   have_last = 0;
+    float left = 0.0f;                      // Bracket [left, right] once f changes sign
+    float right = 0.0f;
+    float f_left = 0.0f;
+    int   bracketed = 0;
+    float last_step = 0.0f;                 // Last two step sizes inside the bracket
+    float older_step = 0.0f;
+    int   converged = 0;
+    int   small;
+    int   damping;
+
+    result->iterations = 0;
+    result->evaluations = 1;
+    result->x = x;
+    result->fx = fx;
+    if(!Solve_IsFinite(fx)) {
+        result->status = SOLVE_UNDEFINED;
+        return;
+    }
+
+    while(result->evaluations < SOLVE_MAX_EVALUATIONS) {
+        float step;
+        float next;
+        float f_next;
+        float df_next;
+
+        if(fx == 0.0f) {
+            converged = 1;
+            break;
+        }
+
+        // Newton step; secant step when the derivative is no use; with
+        // neither, probe a short way off (f is flat here)
+        if(dfx != 0.0f && Solve_IsFinite(dfx)) {
+            step = -fx / dfx;
+        } else if(have_last && fx != last_f) {
+            step = -fx * (x - last_x) / (fx - last_f);
+        } else {
+            step = 0.125f * (Solve_Abs(x) + 1.0f);
+        }
+
+        // Converged when the step no longer changes x
+        next = x + step;
+        if(next == x) {
+            converged = 1;
+            break;
+        }
+
+        if(bracketed) {
+            // Bisect instead if the step leaves the bracket, or if steps
+            // have not halved since the one before last
+            float low = (left < right) ? left : right;
+            float high = (left < right) ? right : left;
+            if(!(next > low && next < high) || 2.0f * Solve_Abs(step) > older_step) {
+                step = (left + 0.5f * (right - left)) - x;
+            }
+            older_step = last_step;
+            last_step = Solve_Abs(step);
+        } else if(!Solve_IsFinite(step)) {
+            step = 0.125f * (Solve_Abs(x) + 1.0f);
+        }
+
+        next = x + step;
+        if(next == x) {
+            converged = 1;
+            break;
+        }
+        // A step this small is the last one; it is still taken, so the
+        // root is polished to the final rounding
+        small = (Solve_Abs(step) <= SOLVE_TOLERANCE * Solve_Abs(x));
+
+        // Step back towards x while f is undefined at the new point, and
+        // (a few times, before a root is bracketed) while |f| grows
+        f_next = Solve_Evaluate(program, next, &df_next);
+        result->evaluations++;
+        damping = 0;
+        while(result->evaluations < SOLVE_MAX_EVALUATIONS &&
+              (!Solve_IsFinite(f_next) ||
+               (!bracketed && (f_next < 0.0f) == (fx < 0.0f) &&
+                Solve_Abs(f_next) > Solve_Abs(fx) && damping++ < SOLVE_DAMPING))) {
+            step *= 0.5f;
+            next = x + step;
+            f_next = Solve_Evaluate(program, next, &df_next);
+            result->evaluations++;
+        }
+        if(!Solve_IsFinite(f_next)) {
+            break;
+        }
+
+        // A sign change brackets a root; after that each new point
+        // replaces the end of the bracket with the same sign
+        if(!bracketed) {
+            if((f_next < 0.0f) != (fx < 0.0f)) {
+                left = x;
+                f_left = fx;
+                right = next;
+                bracketed = 1;
+                last_step = Solve_Abs(right - left);
+                older_step = last_step;
+            }
+        } else if((f_next < 0.0f) == (f_left < 0.0f)) {
+            left = next;
+            f_left = f_next;
+        } else {
+            right = next;
+        }
+
+        last_x = x;
+        last_f = fx;
+        have_last = 1;
+        x = next;
+        fx = f_next;
+        dfx = df_next;
+        result->iterations++;
+        if(Solve_Abs(fx) < Solve_Abs(result->fx)) {
+            result->x = x;
+            result->fx = fx;
+        }
+        if(small) {
+            converged = 1;
+            break;
+        }
+    }
+
+    // Either way the point with the smallest |f| is reported. A sign change
+    // across a pole (e.g. 1/X at 0) closes in like a root, but |f| grows
+    // by orders of magnitude instead of shrinking.
+    if(converged && !(bracketed && Solve_Abs(fx) > 1024.0f * f0)) {
+        result->status = SOLVE_CONVERGED;
+    } else {
+        result->status = SOLVE_NO_CONVERGENCE;
+    }
+}
@@ -0,0 +1,97 @@
+/*
+ * Equation Solver Header
+ *
+ * Finds a root of f(X) = 0, where f is an expression compiled to a short
+ * bytecode program: one byte per operation, with the constants in a side
+ * table. The program is interpreted on (value, derivative) pairs, so each
+ * evaluation also gives f'(X) exactly (forward-mode differentiation) and
+ * Newton's method needs no extra evaluation for a difference quotient.
+ *
+ * Each Newton step is safeguarded:
+ *   - no usable derivative (zero, or undefined): secant step through the
+ *     last two points instead
+ *   - once f has changed sign the root is bracketed; a step that would
+ *     leave the bracket, or that is not converging fast enough, is
+ *     replaced by bisection, so the bracket at least halves every two steps
+ *   - f undefined at the new point (e.g. log of a negative): the step is
+ *     halved until it is defined
+ * The number of evaluations is capped at SOLVE_MAX_EVALUATIONS, which
+ * bounds the time a solve can take.
+ */
+
+#ifndef SOLVE_H
+#define SOLVE_H
+
+#include <stdint.h>
+
+// Program size; an expression of MAX_OPERATORS (16) operators and
+// MAX_FUNCTIONS (8) functions needs at most 58 code bytes and 17
+// constants (-DSOLVE_MAX_CODE=n)
+#ifndef SOLVE_MAX_CODE
+#define SOLVE_MAX_CODE          64
+#endif
+#ifndef SOLVE_MAX_CONSTANTS
+#define SOLVE_MAX_CONSTANTS     24
+#endif
+#define SOLVE_MAX_STACK         24
+
+// Evaluations per solve (each one is a single pass over the program)
+#ifndef SOLVE_MAX_EVALUATIONS
+#define SOLVE_MAX_EVALUATIONS   100
+#endif
+
+typedef enum {
+    SOLVE_OP_CONST = 0,             // Push constants[next code byte]
+    SOLVE_OP_X,                     // Push X
+    SOLVE_OP_ADD,
+    SOLVE_OP_SUBTRACT,
+    SOLVE_OP_MULTIPLY,
+    SOLVE_OP_DIVIDE,
+    SOLVE_OP_SCALE10,               // a  10^b, b truncated to a whole number (E)
+    SOLVE_OP_POWER,
+    SOLVE_OP_SQRT,
+    SOLVE_OP_SIN,
+    SOLVE_OP_COS,
+    SOLVE_OP_TAN,
+    SOLVE_OP_LN,
+    SOLVE_OP_LOG10,
+    SOLVE_OP_EXP
+} SolveOpcode;
+
+typedef struct {
+    uint8_t code[SOLVE_MAX_CODE];
+    float   constants[SOLVE_MAX_CONSTANTS];
+    int     length;                 // Code bytes used
+    int     constant_count;
+    int     depth;                  // Stack depth after the code so far
+    int     uses_x;                 // 1 once X has been emitted
+} SolveProgram;
+
+typedef enum {
+    SOLVE_CONVERGED = 0,            // x is a root to float precision
+    SOLVE_NO_CONVERGENCE,           // Evaluations ran out; x has the smallest |f| found
+    SOLVE_UNDEFINED                 // f is not defined at the starting guess
+} SolveStatus;
+
+typedef struct {
+    SolveStatus status;
+    float x;
+    float fx;                       // f(x)
+    int   iterations;               // Steps taken
+    int   evaluations;
+} SolveResult;
+
+// Building a program, one postfix token at a time. Each returns 0 if the
+// program is full or the token has too few operands.
+void  Solve_Init(SolveProgram* program);
+int   Solve_EmitConstant(SolveProgram* program, float value);
+int   Solve_Emit(SolveProgram* program, SolveOpcode op);
+int   Solve_IsComplete(const SolveProgram* program);   // 1 if it leaves one value
+
+// f(x), with f'(x) in *derivative (pass 0 for f(x) alone, e.g. to integrate)
+float Solve_Evaluate(const SolveProgram* program, float x, float* derivative);
+
+// Look for a root starting from x0
+void  Solve_Root(const SolveProgram* program, float x0, SolveResult* result);
+
+#endif // SOLVE_H
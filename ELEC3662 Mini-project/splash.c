@@ -6,140 +6,13 @@
 
 #include "splash.h"
 #include "lcd.h"
+#include "glyph.h"
 #include "system.h"
 #include <string.h>
 #include <stdint.h>
 
-// Custom character definitions
-static const unsigned char char_satellite[8] = {
-    0b00100,
-    0b01110,
-    0b11111,
-    0b01110,
-    0b00100,
-    0b10001,
-    0b01010,
-    0b00100
-};
-
-static const unsigned char char_rocket[8] = {
-    0b00100,
-    0b01110,
-    0b01110,
-    0b01110,
-    0b11111,
-    0b11111,
-    0b01010,
-    0b01010
-};
-
-static const unsigned char char_antenna[8] = {
-    0b00100,
-    0b00100,
-    0b01110,
-    0b10101,
-    0b00100,
-    0b00100,
-    0b11111,
-    0b00000
-};
-
-static const unsigned char char_radio_wave[8] = {
-    0b00001,
-    0b00010,
-    0b00100,
-    0b01000,
-    0b10000,
-    0b01000,
-    0b00100,
-    0b00010
-};
-
-static const unsigned char char_full_block[8] = {
-    0b11111,
-    0b11111,
-    0b11111,
-    0b11111,
-    0b11111,
-    0b11111,
-    0b11111,
-    0b11111
-};
-
-static const unsigned char char_heart[8] = {
-    0b00000,
-    0b01010,
-    0b11111,
-    0b11111,
-    0b01110,
-    0b00100,
-    0b00000,
-    0b00000
-};
-
-static const unsigned char char_smile[8] = {
-    0b00000,
-    0b01010,
-    0b01010,
-    0b00000,
-    0b10001,
-    0b01110,
-    0b00000,
-    0b00000
-};
-
-// Create custom characters in LCD CGRAM
-void Splash_CreateCustomChars(void) {
-    // Custom character 0: Satellite
-    LCD_Cmd(0x40);  // Set CGRAM address 0
-    for(int i = 0; i < 8; i++) {
-        LCD_Char(char_satellite[i]);
-    }
-    
-    // Custom character 1: Rocket
-    LCD_Cmd(0x48);  // Set CGRAM address 1
-    for(int i = 0; i < 8; i++) {
-        LCD_Char(char_rocket[i]);
-    }
-    
-    // Custom character 2: Antenna
-    LCD_Cmd(0x50);  // Set CGRAM address 2
-    for(int i = 0; i < 8; i++) {
-        LCD_Char(char_antenna[i]);
-    }
-    
-    // Custom character 3: Radio wave
-    LCD_Cmd(0x58);  // Set CGRAM address 3
-    for(int i = 0; i < 8; i++) {
-        LCD_Char(char_radio_wave[i]);
-    }
-    
-    // Custom character 4: Full block
-    LCD_Cmd(0x60);  // Set CGRAM address 4
-    for(int i = 0; i < 8; i++) {
-        LCD_Char(char_full_block[i]);
-    }
-    
-    // Custom character 5: Heart
-    LCD_Cmd(0x68);  // Set CGRAM address 5
-    for(int i = 0; i < 8; i++) {
-        LCD_Char(char_heart[i]);
-    }
-    
-    // Custom character 6: Smile
-    LCD_Cmd(0x70);  // Set CGRAM address 6
-    for(int i = 0; i < 8; i++) {
-        LCD_Char(char_smile[i]);
-    }
-    
-    // Return to DDRAM
-    LCD_Cmd(LCD_HOME);
-}
-
 // Main splash screen dispatcher
 void Splash_Show(SplashType type) {
-    Splash_CreateCustomChars();
-    
     switch(type) {
         case SPLASH_CLASSIC:
             Splash_Classic();
@@ -223,13 +96,15 @@ void Splash_Matrix(void) {
 
 // Wave animation
 void Splash_Wave(void) {
+    unsigned char block = Glyph_Get(GLYPH_FULL_BLOCK);
+    
     LCD_Clear();
     
     // Animated wave across screen
     for(int wave = 0; wave < 2; wave++) {
         for(int i = 0; i < 16; i++) {
             LCD_Cmd(0x80 + i);
-            LCD_Char(0x04);  // Custom block character
+            LCD_Char(block);
             Delay_ms(50);
             LCD_Cmd(0x80 + i);
             LCD_Char(' ');
@@ -245,6 +120,8 @@ void Splash_Wave(void) {
 
 // Rocket launch animation
 void Splash_Rocket(void) {
+    unsigned char rocket = Glyph_Get(GLYPH_ROCKET);
+    
     LCD_Clear();
     
     // Countdown
@@ -270,12 +147,12 @@ void Splash_Rocket(void) {
         LCD_Clear();
         if(row == 2) {
             LCD_Cmd(LCD_LINE2 + 7);
-            LCD_Char(0x01);  // Rocket custom char
-            LCD_Char(0x01);
+            LCD_Char(rocket);
+            LCD_Char(rocket);
         } else {
             LCD_Cmd(0x80 + 7);
-            LCD_Char(0x01);
-            LCD_Char(0x01);
+            LCD_Char(rocket);
+            LCD_Char(rocket);
         }
         Delay_ms(300);
     }
@@ -290,17 +167,20 @@ void Splash_Rocket(void) {
 
 // Satellite communication theme
 void Splash_Satellite(void) {
+    unsigned char satellite = Glyph_Get(GLYPH_SATELLITE);
+    unsigned char wave = Glyph_Get(GLYPH_RADIO_WAVE);
+    
     LCD_Clear();
     
     // Ground station to satellite animation
     LCD_String("GS");
     LCD_Cmd(0x80 + 14);
-    LCD_Char(0x00);  // Satellite custom char
+    LCD_Char(satellite);
     
     // Transmit signal
     for(int i = 2; i < 14; i++) {
         LCD_Cmd(0x80 + i);
-        LCD_Char(0x03);  // Wave custom char
+        LCD_Char(wave);
         Delay_ms(100);
         if(i > 3) {
             LCD_Cmd(0x80 + i - 2);
@@ -333,6 +213,8 @@ void Splash_Satellite(void) {
 
 // Loading bar animation
 void Splash_LoadingBar(void) {
+    unsigned char block = Glyph_Get(GLYPH_FULL_BLOCK);
+    
     LCD_Clear();
     LCD_String("  Initializing");
     LCD_Cmd(LCD_LINE2);
@@ -341,7 +223,7 @@ void Splash_LoadingBar(void) {
     // Progress bar
     for(int i = 0; i < 14; i++) {
         LCD_Cmd(LCD_LINE2 + 1 + i);
-        LCD_Char(0x04);  // Full block custom char
+        LCD_Char(block);
         Delay_ms(150);
     }
     
@@ -413,13 +295,15 @@ void Splash_Radar(void) {
 
 // Custom M0LSC themed splash
 void Splash_M0LSC(void) {
+    unsigned char antenna = Glyph_Get(GLYPH_ANTENNA);
+    
     LCD_Clear();
     
     // Amateur radio themed
     LCD_String(" ");
-    LCD_Char(0x02);  // Antenna custom char
+    LCD_Char(antenna);
     LCD_String(" M0LSC/M0XWI ");
-    LCD_Char(0x02);
+    LCD_Char(antenna);
     
     LCD_Cmd(LCD_LINE2);
     LCD_String("  73 de Leeds");
@@ -456,19 +340,21 @@ void Splash_ScrollText(const char* text, int delay_ms) {
 
 // Helper: Fill screen animation
 void Splash_FillAnimation(void) {
+    unsigned char block = Glyph_Get(GLYPH_FULL_BLOCK);
+    
     LCD_Clear();
     
     // Fill line 1
     for(int i = 0; i < 16; i++) {
         LCD_Cmd(0x80 + i);
-        LCD_Char(0x04);  // Full block
+        LCD_Char(block);
         Delay_ms(50);
     }
     
     // Fill line 2
     for(int i = 0; i < 16; i++) {
         LCD_Cmd(LCD_LINE2 + i);
-        LCD_Char(0x04);  // Full block
+        LCD_Char(block);
         Delay_ms(50);
     }
     
@@ -498,23 +384,25 @@ void Splash_RandomDots(int count, int delay_ms) {
 
 // Helper: Draw box
 void Splash_DrawBox(void) {
+    unsigned char block = Glyph_Get(GLYPH_FULL_BLOCK);
+    
     LCD_Clear();
     
     // Top border
     LCD_Cmd(0x80);
-    LCD_Char(0x04);
+    LCD_Char(block);
     for(int i = 1; i < 15; i++) {
-        LCD_Char(0x04);
+        LCD_Char(block);
     }
-    LCD_Char(0x04);
+    LCD_Char(block);
     
     // Bottom border
     LCD_Cmd(LCD_LINE2);
-    LCD_Char(0x04);
+    LCD_Char(block);
     for(int i = 1; i < 15; i++) {
-        LCD_Char(0x04);
+        LCD_Char(block);
     }
-    LCD_Char(0x04);
+    LCD_Char(block);
     
     Delay_ms(1000);
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
  * 
  * Fun animated splash screens for calculator startup
  * Includes multiple themes and animation styles
+ * Custom characters come from the glyph cache (glyph.h)
  */
 
 #ifndef SPLASH_H
@@ -42,7 +43,4 @@ void Splash_FillAnimation(void);
 void Splash_RandomDots(int count, int delay_ms);
 void Splash_DrawBox(void);
 
-// Custom character definitions for splash screens
-void Splash_CreateCustomChars(void);
-
 #endif // SPLASH_H
\ No newline at end of file
@@ -0,0 +1,168 @@
+/*
+ * Streaming Statistics Implementation
+ *
+ * Welford update for a sample (x, y), with n the new count:
+ *   dx = x - mean_x          mean_x += dx / n       m2_x += dx  (x - mean_x)
+ *   dy = y - mean_y          mean_y += dy / n       m2_y += dy  (y - mean_y)
+ *                                                   c_xy += dx  (y - mean_y)
+ * Batch recompute uses arm_mean_f32, arm_var_f32, arm_min_f32 and
+ * arm_max_f32 from CMSIS-DSP on the target; host builds use the same
+ * two-pass formulas in plain C.
+ */
+
+#include "stats.h"
+#include "mathfn.h"
+#if defined(__ARM_FP)
+#include "arm_math.h"
+#endif
+
+void Stats_Init(StatsAccumulator* stats) {
+    stats->count = 0;
+    stats->mean_x = 0.0f;
+    stats->mean_y = 0.0f;
+    stats->m2_x = 0.0f;
+    stats->m2_y = 0.0f;
+    stats->c_xy = 0.0f;
+    stats->min_y = 0.0f;
+    stats->max_y = 0.0f;
+}
+
+void Stats_Add(StatsAccumulator* stats, float x, float y) {
+    if(stats->count < STATS_MAX_SAMPLES) {
+        stats->sample_x[stats->count] = x;
+        stats->sample_y[stats->count] = y;
+    }
+
+    stats->count++;
+    float n = (float)stats->count;
+    float dx = x - stats->mean_x;
+    float dy = y - stats->mean_y;
+    stats->mean_x += dx / n;
+    stats->mean_y += dy / n;
+    stats->m2_x += dx * (x - stats->mean_x);
+    stats->m2_y += dy * (y - stats->mean_y);
+    stats->c_xy += dx * (y - stats->mean_y);
+
+    if(stats->count == 1 || y < stats->min_y) {
+        stats->min_y = y;
+    }
+    if(stats->count == 1 || y > stats->max_y) {
+        stats->max_y = y;
+    }
+}
+
+int Stats_Mean(const StatsAccumulator* stats, float* result) {
+    if(stats->count == 0) {
+        return 0;
+    }
+    *result = stats->mean_y;
+    return 1;
+}
+
+int Stats_StdDev(const StatsAccumulator* stats, float* result) {
+    if(stats->count < 2) {
+        return 0;
+    }
+    *result = MathFn_Sqrt(stats->m2_y / (float)(stats->count - 1));
+    return 1;
+}
+
+int Stats_Min(const StatsAccumulator* stats, float* result) {
+    if(stats->count == 0) {
+        return 0;
+    }
+    *result = stats->min_y;
+    return 1;
+}
+
+int Stats_Max(const StatsAccumulator* stats, float* result) {
+    if(stats->count == 0) {
+        return 0;
+    }
+    *result = stats->max_y;
+    return 1;
+}
+
+int Stats_Slope(const StatsAccumulator* stats, float* result) {
+    if(stats->count < 2 || stats->m2_x == 0.0f) {
+        return 0;
+    }
+    *result = stats->c_xy / stats->m2_x;
+    return 1;
+}
+
+int Stats_Intercept(const StatsAccumulator* stats, float* result) {
+    float slope;
+
+    if(!Stats_Slope(stats, &slope)) {
+        return 0;
+    }
+    *result = stats->mean_y - slope * stats->mean_x;
+    return 1;
+}
+
+int Stats_Correlation(const StatsAccumulator* stats, float* result) {
+    if(stats->count < 2 || stats->m2_x == 0.0f || stats->m2_y == 0.0f) {
+        return 0;
+    }
+    *result = stats->c_xy / MathFn_Sqrt(stats->m2_x * stats->m2_y);
+    return 1;
+}
+
+// Mean and sum of squared deviations of a block (two passes)
+static void Stats_Block(const float* values, unsigned long count, float* mean, float* m2) {
+#if defined(__ARM_FP)
+    float variance = 0.0f;
+    arm_mean_f32(values, count, mean);
+    if(count > 1) {
+        arm_var_f32(values, count, &variance);          // m2 / (count - 1)
+    }
+    *m2 = variance * (float)(count - 1);
+#else
+    float sum = 0.0f;
+    for(unsigned long i = 0; i < count; i++) {
+        sum += values[i];
+    }
+    *mean = sum / (float)count;
+    sum = 0.0f;
+    for(unsigned long i = 0; i < count; i++) {
+        float d = values[i] - *mean;
+        sum += d * d;
+    }
+    *m2 = sum;
+#endif
+}
+
+int Stats_Recompute(StatsAccumulator* stats) {
+    unsigned long count = stats->count;
+    float c_xy = 0.0f;
+
+    if(count > STATS_MAX_SAMPLES) {
+        return 0;
+    }
+    if(count == 0) {
+        return 1;
+    }
+
+    Stats_Block(stats->sample_x, count, &stats->mean_x, &stats->m2_x);
+    Stats_Block(stats->sample_y, count, &stats->mean_y, &stats->m2_y);
+#if defined(__ARM_FP)
+    uint32_t index;
+    arm_min_f32(stats->sample_y, count, &stats->min_y, &index);
+    arm_max_f32(stats->sample_y, count, &stats->max_y, &index);
+#else
+    stats->min_y = stats->sample_y[0];
+    stats->max_y = stats->sample_y[0];
+    for(unsigned long i = 1; i < count; i++) {
+        if(stats->sample_y[i] < stats->min_y) stats->min_y = stats->sample_y[i];
+        if(stats->sample_y[i] > stats->max_y) stats->max_y = stats->sample_y[i];
+    }
+#endif
+
+    // No CMSIS-DSP routine for the co-deviation sum without a scratch buffer
+    for(unsigned long i = 0; i < count; i++) {
+        c_xy += (stats->sample_x[i] - stats->mean_x) * (stats->sample_y[i] - stats->mean_y);
+    }
+    stats->c_xy = c_xy;
+    return 1;
+}
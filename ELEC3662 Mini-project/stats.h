@@ -0,0 +1,53 @@
+/*
+ * Streaming Statistics Header
+ *
+ * One-pass statistics over a stream of (x, y) samples. Each sample updates
+ * the accumulators in O(1) with Welford's method (running means and sums
+ * of squared deviations, which do not cancel the way raw sums of squares
+ * do in float), so any number of readings can be keyed in:
+ *   count, mean, sample standard deviation, min and max of y
+ *   least-squares line y = a + bx and correlation coefficient r
+ * The first STATS_MAX_SAMPLES samples are also kept in a buffer, so the
+ * accumulators can be recomputed in batch with the CMSIS-DSP routines.
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+// Samples kept for batch recompute (2 floats each). More samples can be
+// added; they only update the accumulators (-DSTATS_MAX_SAMPLES=n).
+#ifndef STATS_MAX_SAMPLES
+#define STATS_MAX_SAMPLES       128
+#endif
+
+typedef struct {
+    unsigned long count;
+    float mean_x;
+    float mean_y;
+    float m2_x;                     // Sum of (x - mean_x)
+    float m2_y;                     // Sum of (y - mean_y)
+    float c_xy;                     // Sum of (x - mean_x)(y - mean_y)
+    float min_y;
+    float max_y;
+    float sample_x[STATS_MAX_SAMPLES];
+    float sample_y[STATS_MAX_SAMPLES];
+} StatsAccumulator;
+
+void Stats_Init(StatsAccumulator* stats);
+void Stats_Add(StatsAccumulator* stats, float x, float y);
+
+// Results; each returns 0 if the value is undefined for the samples so far
+// (e.g. a standard deviation of one sample, a line through equal x values)
+int Stats_Mean(const StatsAccumulator* stats, float* result);
+int Stats_StdDev(const StatsAccumulator* stats, float* result);    // n - 1 divisor
+int Stats_Min(const StatsAccumulator* stats, float* result);
+int Stats_Max(const StatsAccumulator* stats, float* result);
+int Stats_Slope(const StatsAccumulator* stats, float* result);     // b
+int Stats_Intercept(const StatsAccumulator* stats, float* result); // a
+int Stats_Correlation(const StatsAccumulator* stats, float* result);
+
+// Recompute every accumulator from the sample buffer in batch (CMSIS-DSP
+// on the target). Returns 0 if samples have been added past the buffer.
+int Stats_Recompute(StatsAccumulator* stats);
+
+#endif // STATS_H
@@ -9,19 +9,16 @@
 void Delay_ms(unsigned long ms) {
     unsigned long i;
     for(i = 0; i < ms; i++) {
-        NVIC_ST_RELOAD_R = 80000 - 1;  // 1ms at 80MHz (assuming 80MHz clock after PLL)
+        NVIC_ST_RELOAD_R = SYSTEM_CLOCK_HZ / 1000 - 1;  // 1ms at 80MHz (assuming 80MHz clock after PLL)
         NVIC_ST_CURRENT_R = 0;
         while((NVIC_ST_CTRL_R & 0x00010000) == 0);
     }
 }
 
 void Delay_us(unsigned long us) {
-    unsigned long i;
-    for(i = 0; i < us; i++) {
-        NVIC_ST_RELOAD_R = 80 - 1;  // 1us at 80MHz
-        NVIC_ST_CURRENT_R = 0;
-        while((NVIC_ST_CTRL_R & 0x00010000) == 0);
-    }
+    // Reloading SysTick for every microsecond cost as much as the
+    // microsecond itself, so this runs on the cycle counter instead
+    Delay_cycles(SYSTEM_US_TO_CYCLES(us));
 }
 
 void System_Init(void) {
@@ -43,4 +40,24 @@ unsigned long millis(void) {
     // Note: This is a simple implementation. For accurate timekeeping,
     // you would need to track timer overflows
     return NVIC_ST_CURRENT_R / 80000;
+}
+
+void CycleCounter_Init(void) {
+    NVIC_DBG_DEMCR_R |= 0x01000000;  // TRCENA: enable DWT/ITM blocks
+    DWT_CYCCNT_R = 0;
+    DWT_CTRL_R |= 0x00000001;        // CYCCNTENA: start the cycle counter
+}
+
+unsigned long CycleCounter_Read(void) {
+    // Counts core clock cycles (12.5ns each at 80MHz), wraps every ~53s
+    return DWT_CYCCNT_R;
+}
+
+void Delay_cycles(unsigned long cycles) {
+    unsigned long start = DWT_CYCCNT_R;
+    
+    // Unsigned difference, so a wrap of the counter does not matter. The
+    // loop reads the counter every few cycles, so it overshoots by at most
+    // one iteration.
+    while((unsigned long)(DWT_CYCCNT_R - start) < cycles);
 }
\ No newline at end of file
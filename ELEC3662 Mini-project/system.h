@@ -6,10 +6,27 @@
 #ifndef SYSTEM_H
 #define SYSTEM_H
 
+// Core clock after the PLL; every delay and cycle-to-time conversion uses it
+#define SYSTEM_CLOCK_HZ         80000000UL
+#define SYSTEM_CYCLES_PER_US    (SYSTEM_CLOCK_HZ / 1000000UL)
+
+// Core cycles for a time in ns or us, rounded up
+#define SYSTEM_NS_TO_CYCLES(ns) (((ns) * SYSTEM_CYCLES_PER_US + 999UL) / 1000UL)
+#define SYSTEM_US_TO_CYCLES(us) ((us) * SYSTEM_CYCLES_PER_US)
+
 // Function declarations
 void System_Init(void);
 void Delay_ms(unsigned long ms);
 void Delay_us(unsigned long us);
 unsigned long millis(void);
 
+// Free-running CPU cycle counter (DWT CYCCNT), used for benchmarking and
+// for the cycle-accurate delays below
+void CycleCounter_Init(void);
+unsigned long CycleCounter_Read(void);
+
+// Busy-wait at least this many core cycles (12.5 ns each at 80 MHz) on
+// the cycle counter, which must be running (CycleCounter_Init)
+void Delay_cycles(unsigned long cycles);
+
 #endif // SYSTEM_H
\ No newline at end of file
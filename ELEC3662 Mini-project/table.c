@@ -0,0 +1,82 @@
+/*
+ * Function Table Implementation
+ *
+ * Sparkline: each row's f(X) is scaled from [min, max] to a pixel row 0-7
+ * (0 at the bottom) and the column is lit from the previous point's pixel
+ * row to its own, so steep parts of the curve stay connected. Rows where
+ * f(X) is undefined leave a gap.
+ */
+
+#include "table.h"
+
+static int Table_IsFinite(float value) {
+    return value - value == 0.0f;
+}
+
+float Table_X(const TableData* table, int row) {
+    // start + row  step, not a running sum, so rows do not drift
+    return table->start + (float)row * table->step;
+}
+
+// Pixel row of a value (0 = bottom); a flat table sits in the middle
+static int Table_Level(const TableData* table, float y) {
+    float span = table->max - table->min;
+    if(!(span > 0.0f)) {
+        return TABLE_GLYPH_HEIGHT / 2;
+    }
+    int level = (int)((y - table->min) / span * (float)(TABLE_GLYPH_HEIGHT - 1) + 0.5f);
+    if(level < 0) level = 0;
+    if(level > TABLE_GLYPH_HEIGHT - 1) level = TABLE_GLYPH_HEIGHT - 1;
+    return level;
+}
+
+static void Table_Plot(TableData* table) {
+    int last = -1;                  // Previous point's pixel row, -1 after a gap
+
+    for(int g = 0; g < TABLE_GLYPHS; g++) {
+        for(int r = 0; r < TABLE_GLYPH_HEIGHT; r++) {
+            table->glyph[g][r] = 0;
+        }
+    }
+
+    for(int row = 0; row < TABLE_POINTS; row++) {
+        if(!Table_IsFinite(table->y[row])) {
+            last = -1;
+            continue;
+        }
+        int level = Table_Level(table, table->y[row]);
+        int low = level;
+        int high = level;
+        if(last >= 0) {
+            if(last < low) low = last;
+            if(last > high) high = last;
+        }
+        unsigned char bit = (unsigned char)(0x10 >> (row % TABLE_GLYPH_WIDTH));
+        unsigned char* glyph = table->glyph[row / TABLE_GLYPH_WIDTH];
+        for(int l = low; l <= high; l++) {
+            glyph[TABLE_GLYPH_HEIGHT - 1 - l] |= bit;
+        }
+        last = level;
+    }
+}
+
+void Table_Fill(TableData* table, const SolveProgram* program, float start, float step) {
+    table->start = start;
+    table->step = step;
+    table->defined = 0;
+    table->min = 0.0f;
+    table->max = 0.0f;
+
+    for(int row = 0; row < TABLE_POINTS; row++) {
+        float y = Solve_Evaluate(program, Table_X(table, row), 0);
+        table->y[row] = y;
+        if(!Table_IsFinite(y)) {
+            continue;
+        }
+        if(table->defined == 0 || y < table->min) table->min = y;
+        if(table->defined == 0 || y > table->max) table->max = y;
+        table->defined++;
+    }
+
+    Table_Plot(table);
+}
@@ -0,0 +1,38 @@
+/*
+ * Function Table Header
+ *
+ * Evaluates an expression in X, compiled to a SolveProgram (solve.h), at
+ * TABLE_POINTS evenly spaced values of X in one batch. The values are kept
+ * in the table, so paging through it, or switching to the plot, only
+ * redraws. The plot is a sparkline one pixel column per point, drawn into
+ * the 8 LCD custom characters (8  5 = 40 columns, 8 pixels high).
+ */
+
+#ifndef TABLE_H
+#define TABLE_H
+
+#include "solve.h"
+#include "lcd.h"
+
+#define TABLE_GLYPHS            LCD_CUSTOM_CHARS
+#define TABLE_GLYPH_WIDTH       5
+#define TABLE_GLYPH_HEIGHT      8
+#define TABLE_POINTS            (TABLE_GLYPHS * TABLE_GLYPH_WIDTH)
+
+typedef struct {
+    float start;                    // X of the first row
+    float step;
+    float y[TABLE_POINTS];          // f(X) of each row (NaN where undefined)
+    float min;                      // Range of the defined values
+    float max;
+    int   defined;                  // Rows where f(X) is defined
+    unsigned char glyph[TABLE_GLYPHS][TABLE_GLYPH_HEIGHT];  // Sparkline
+} TableData;
+
+// Evaluate every row and draw the sparkline
+void  Table_Fill(TableData* table, const SolveProgram* program, float start, float step);
+
+// X of a row
+float Table_X(const TableData* table, int row);
+
+#endif // TABLE_H